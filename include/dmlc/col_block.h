@@ -0,0 +1,268 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file col_block.h
+ * \brief column-major (CSC) view of row blocks, with a parallel
+ *  transpose from RowBlock and column partitioning for feature-parallel workers
+ */
+#ifndef DMLC_COL_BLOCK_H_
+#define DMLC_COL_BLOCK_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "./common.h"
+#include "./data.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief one column of a ColBlock
+ * \tparam IndexType type of the row id
+ * \tparam DType type of the value
+ */
+template <typename IndexType, typename DType = real_t>
+struct Col {
+  /*! \brief number of nonzero entries in the column */
+  size_t length;
+  /*! \brief row ids of the entries, in increasing order */
+  const IndexType *row;
+  /*! \brief values of the entries, can be NULL, indicating all values are 1 */
+  const DType *value;
+  /*!
+   * \param i the entry index
+   * \return the i-th value
+   */
+  inline DType get_value(size_t i) const {
+    return value == NULL ? DType(1.0f) : value[i];
+  }
+};
+
+/*!
+ * \brief a block of data stored column by column (CSC),
+ *  the transpose of a RowBlock
+ * \tparam IndexType type of the row id
+ * \tparam DType type of the value
+ */
+template <typename IndexType, typename DType = real_t>
+struct ColBlock {
+  /*! \brief number of columns */
+  size_t size;
+  /*! \brief array[size+1], pointer to the beginning of each column */
+  const size_t *offset;
+  /*! \brief row id of each entry, relative to the first row of the RowBlock */
+  const IndexType *row;
+  /*! \brief value of each entry, can be NULL, indicating all values are 1 */
+  const DType *value;
+  /*!
+   * \brief get a column of the block
+   * \param colid the column id
+   * \return the column
+   */
+  inline Col<IndexType, DType> operator[](size_t colid) const {
+    CHECK(colid < size);
+    Col<IndexType, DType> col;
+    col.length = offset[colid + 1] - offset[colid];
+    col.row = row + offset[colid];
+    col.value = value == NULL ? NULL : value + offset[colid];
+    return col;
+  }
+  /*!
+   * \brief slice a ColBlock to get the columns in [begin, end)
+   * \param begin the begin column index
+   * \param end the end column index
+   * \return the sliced ColBlock
+   */
+  inline ColBlock Slice(size_t begin, size_t end) const {
+    CHECK(begin <= end && end <= size);
+    ColBlock ret;
+    ret.size = end - begin;
+    ret.offset = offset + begin;
+    ret.row = row;
+    ret.value = value;
+    return ret;
+  }
+};
+
+/*!
+ * \brief dynamic data structure that holds a ColBlock
+ * \tparam IndexType type of the row id
+ * \tparam DType type of the value
+ */
+template <typename IndexType, typename DType = real_t>
+struct ColBlockContainer {
+  /*! \brief array[size+1], pointer to the beginning of each column */
+  std::vector<size_t> offset;
+  /*! \brief row id of each entry */
+  std::vector<IndexType> row;
+  /*! \brief value of each entry */
+  std::vector<DType> value;
+  /*! \brief number of columns */
+  inline size_t Size(void) const {
+    return offset.size() == 0 ? 0 : offset.size() - 1;
+  }
+  /*! \return memory cost of this container in bytes */
+  inline size_t MemCostBytes(void) const {
+    return offset.size() * sizeof(size_t) + row.size() * sizeof(IndexType)
+           + value.size() * sizeof(DType);
+  }
+  /*! \brief convert to a ColBlock */
+  inline ColBlock<IndexType, DType> GetBlock(void) const {
+    ColBlock<IndexType, DType> data;
+    data.size = this->Size();
+    data.offset = BeginPtr(offset);
+    data.row = BeginPtr(row);
+    data.value = BeginPtr(value);
+    return data;
+  }
+};
+
+/*!
+ * \brief transpose a RowBlock into column-major order.
+ *  Rows are split among threads, each thread counts the entries of
+ *  every column in its rows, then scatters them to the positions given
+ *  by the prefix sum of the counts. The row ids of each column are
+ *  therefore sorted without any comparison.
+ * \param batch the row block
+ * \param out the transposed block
+ * \param num_col minimal number of columns, the output has
+ *  max(num_col, maximum feature index + 1) columns
+ * \param nthread number of threads, the number of cores if not positive
+ */
+template <typename IndexType, typename DType>
+inline void Transpose(const RowBlock<IndexType, DType> &batch,
+    ColBlockContainer<IndexType, DType> *out, size_t num_col = 0, int nthread = 0) {
+  CHECK_LE(batch.size, static_cast<size_t>(std::numeric_limits<IndexType>::max()))
+      << "number of rows exceed numeric bound of current type";
+  const size_t nrow = batch.size;
+  const size_t base = batch.offset[0];
+  nthread = ParallelNumThreads(nrow, nthread);
+  // number of columns
+  std::vector<size_t> thread_ncol(nthread, 0);
+  ParallelFor(nrow, nthread, [&](int tid, size_t begin, size_t end) {
+    size_t ncol = 0;
+    for (size_t j = batch.offset[begin]; j < batch.offset[end]; ++j) {
+      ncol = std::max(ncol, static_cast<size_t>(batch.index[j]) + 1);
+    }
+    thread_ncol[tid] = ncol;
+  });
+  num_col = std::max(num_col, *std::max_element(thread_ncol.begin(), thread_ncol.end()));
+  // count the entries of each column in the rows of each thread
+  std::vector<std::vector<size_t>> count(nthread);
+  ParallelFor(nrow, nthread, [&](int tid, size_t begin, size_t end) {
+    std::vector<size_t> &cnt = count[tid];
+    cnt.resize(num_col, 0);
+    for (size_t j = batch.offset[begin]; j < batch.offset[end]; ++j) {
+      ++cnt[batch.index[j]];
+    }
+  });
+  // column pointers, then the first position of each thread in each column
+  out->offset.resize(num_col + 1);
+  out->offset[0] = 0;
+  for (size_t c = 0; c < num_col; ++c) {
+    size_t total = 0;
+    for (int tid = 0; tid < nthread; ++tid) {
+      size_t n = count[tid][c];
+      count[tid][c] = out->offset[c] + total;
+      total += n;
+    }
+    out->offset[c + 1] = out->offset[c] + total;
+  }
+  const size_t ndata = batch.offset[nrow] - base;
+  CHECK_EQ(out->offset[num_col], ndata);
+  out->row.resize(ndata);
+  out->value.resize(batch.value != NULL ? ndata : 0);
+  IndexType *orow = BeginPtr(out->row);
+  DType *ovalue = BeginPtr(out->value);
+  // scatter, each thread writes its own disjoint positions
+  ParallelFor(nrow, nthread, [&](int tid, size_t begin, size_t end) {
+    std::vector<size_t> &pos = count[tid];
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+        const size_t p = pos[batch.index[j]]++;
+        orow[p] = static_cast<IndexType>(i);
+        if (ovalue != NULL) {
+          ovalue[p] = batch.value[j];
+        }
+      }
+    }
+  });
+}
+
+/*!
+ * \brief partition the columns into contiguous ranges with
+ *  about the same number of entries, for feature-parallel workers
+ * \param block the column block
+ * \param num_parts number of partitions
+ * \return array[num_parts+1], partition k covers the columns in [ret[k], ret[k+1]),
+ *  use ColBlock::Slice to get the partition
+ */
+template <typename IndexType, typename DType>
+inline std::vector<size_t> PartitionColumns(
+    const ColBlock<IndexType, DType> &block, size_t num_parts) {
+  CHECK_NE(num_parts, 0U);
+  std::vector<size_t> ret(num_parts + 1, block.size);
+  ret[0] = 0;
+  const size_t begin = block.offset[0];
+  const size_t ndata = block.offset[block.size] - begin;
+  for (size_t k = 1; k < num_parts; ++k) {
+    const size_t target = begin + ndata * k / num_parts;
+    size_t c = std::lower_bound(block.offset, block.offset + block.size + 1, target) - block.offset;
+    ret[k] = std::max(ret[k - 1], std::min(c, block.size));
+  }
+  return ret;
+}
+
+/*!
+ * \brief iterator that transposes the blocks of a RowBlockIter,
+ *  e.g. the pages of a disk cache, into column blocks.
+ *  The RowBlock of the current column block is the Value() of the
+ *  base iterator, and gives the labels and weights of the rows.
+ *  The width of each column block is computed from its own rows, so the
+ *  iterator does not wait for the base iterator to count the columns of
+ *  the whole data.
+ * \tparam IndexType type of the index
+ * \tparam DType type of the value
+ */
+template <typename IndexType, typename DType = real_t>
+class ColBlockIter : public DataIter<ColBlock<IndexType, DType>> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the row block iterator, not owned
+   * \param nthread number of threads of the transpose, the number of cores if not positive
+   * \param num_col minimal number of columns of each block, e.g. the NumCol() of the
+   *  base iterator to give every block the same width, 0 for the maximum feature
+   *  index of the block plus one
+   */
+  explicit ColBlockIter(RowBlockIter<IndexType, DType> *base, int nthread = 0, size_t num_col = 0)
+      : base_(base), nthread_(nthread), num_col_(num_col) {}
+  virtual void BeforeFirst(void) {
+    base_->BeforeFirst();
+  }
+  virtual bool Next(void) {
+    if (!base_->Next()) {
+      return false;
+    }
+    Transpose(base_->Value(), &data_, num_col_, nthread_);
+    block_ = data_.GetBlock();
+    return true;
+  }
+  virtual const ColBlock<IndexType, DType> &Value(void) const {
+    return block_;
+  }
+
+ private:
+  /*! \brief the row block iterator */
+  RowBlockIter<IndexType, DType> *base_;
+  /*! \brief number of threads of the transpose */
+  int nthread_;
+  /*! \brief minimal number of columns of each block */
+  size_t num_col_;
+  /*! \brief storage of the current block */
+  ColBlockContainer<IndexType, DType> data_;
+  /*! \brief the current block */
+  ColBlock<IndexType, DType> block_;
+};
+}  // namespace dmlc
+#endif  // DMLC_COL_BLOCK_H_
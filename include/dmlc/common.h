@@ -6,6 +6,7 @@
 #ifndef DMLC_COMMON_H_
 #define DMLC_COMMON_H_
 
+#include <algorithm>
 #include <exception>
 #include <mutex>
 #include <sstream>
@@ -15,6 +16,10 @@
 
 #include "./logging.h"
 
+#if DMLC_ENABLE_STD_THREAD
+  #include <thread>
+#endif  // DMLC_ENABLE_STD_THREAD
+
 namespace dmlc {
 /*!
  * \brief Split a string by delimiter
@@ -90,6 +95,58 @@ class OMPException {
   }
 };
 
+/*!
+ * \brief number of threads used by ParallelFor
+ * \param size the size of the range
+ * \param nthread requested number of threads, the number of cores if not positive
+ * \return the number of threads, at least 1 and at most size,
+ *  always 1 without std::thread
+ */
+inline int ParallelNumThreads(size_t size, int nthread) {
+#if !DMLC_ENABLE_STD_THREAD
+  return 1;
+#else
+  if (nthread <= 0) {
+    nthread = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+  }
+  return static_cast<int>(std::min(static_cast<size_t>(nthread), std::max(size, size_t(1))));
+#endif  // !DMLC_ENABLE_STD_THREAD
+}
+
+/*!
+ * \brief split [0, size) into ParallelNumThreads(size, nthread) contiguous
+ *  ranges and run fn(tid, begin, end) on each of them in its own thread.
+ *  Exceptions are rethrown in the calling thread. Without std::thread,
+ *  fn runs once on the whole range in the calling thread.
+ * \param size the size of the range
+ * \param nthread number of threads, the number of cores if not positive
+ * \param fn the function to run
+ */
+template <typename Function>
+inline void ParallelFor(size_t size, int nthread, Function fn) {
+  nthread = ParallelNumThreads(size, nthread);
+  const size_t step = (size + nthread - 1) / nthread;
+  if (nthread == 1) {
+    fn(0, size_t(0), size);
+    return;
+  }
+#if DMLC_ENABLE_STD_THREAD
+  OMPException exc;
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < nthread; ++tid) {
+    threads.push_back(std::thread([&exc, &fn, step, size, tid] {
+      exc.Run([&] {
+        fn(tid, std::min(tid * step, size), std::min((tid + 1) * step, size));
+      });
+    }));
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  exc.Rethrow();
+#endif  // DMLC_ENABLE_STD_THREAD
+}
+
 }  // namespace dmlc
 
 #endif  // DMLC_COMMON_H_
@@ -7,10 +7,16 @@
 #ifndef DMLC_DATA_H_
 #define DMLC_DATA_H_
 
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
 
+#if defined(__AVX2__)
+  #include <immintrin.h>
+#endif  // defined(__AVX2__)
+
 #include "./base.h"
 #include "./io.h"
 #include "./logging.h"
@@ -32,6 +38,9 @@ typedef float real_t;
  */
 typedef unsigned index_t;
 
+/*! \brief statistics of the features of a dataset, defined in dmlc/feature_stats.h */
+class FeatureStats;
+
 // This file describes common data structure that can be used
 // for large-scale machine learning, this may not be a complete list
 // But we will keep the most common and useful ones, and keep adding new ones
@@ -66,6 +75,88 @@ class DataIter {
   virtual const DType &Value(void) const = 0;
 };
 
+namespace detail {
+/*!
+ * \brief portable kernel of SparseDot, four independent accumulators
+ *  break the dependency chain of the additions
+ */
+template <typename AccType, typename IndexType, typename DType, typename V>
+inline AccType SparseDotScalar(
+    const IndexType *index, const DType *value, size_t length, const V *weight) {
+  AccType s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  if (value == NULL) {
+    for (; i + 4 <= length; i += 4) {
+      s0 += static_cast<AccType>(weight[index[i]]);
+      s1 += static_cast<AccType>(weight[index[i + 1]]);
+      s2 += static_cast<AccType>(weight[index[i + 2]]);
+      s3 += static_cast<AccType>(weight[index[i + 3]]);
+    }
+    for (; i < length; ++i) {
+      s0 += static_cast<AccType>(weight[index[i]]);
+    }
+  } else {
+    for (; i + 4 <= length; i += 4) {
+      s0 += static_cast<AccType>(weight[index[i]]) * static_cast<AccType>(value[i]);
+      s1 += static_cast<AccType>(weight[index[i + 1]]) * static_cast<AccType>(value[i + 1]);
+      s2 += static_cast<AccType>(weight[index[i + 2]]) * static_cast<AccType>(value[i + 2]);
+      s3 += static_cast<AccType>(weight[index[i + 3]]) * static_cast<AccType>(value[i + 3]);
+    }
+    for (; i < length; ++i) {
+      s0 += static_cast<AccType>(weight[index[i]]) * static_cast<AccType>(value[i]);
+    }
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+/*!
+ * \brief dot product between a sparse vector and a dense vector,
+ *  the indices must be smaller than the size of the dense vector.
+ *  Uses AVX2 gathers for float data with 32-bit indices when compiled with them.
+ * \param index the indices of the sparse vector
+ * \param value the values of the sparse vector, NULL if all values are 1
+ * \param length number of entries of the sparse vector
+ * \param weight the dense vector
+ * \param size size of the dense vector
+ * \tparam AccType type of the accumulator
+ */
+template <typename AccType, typename IndexType, typename DType, typename V>
+inline AccType SparseDot(
+    const IndexType *index, const DType *value, size_t length, const V *weight, size_t /*size*/) {
+  return SparseDotScalar<AccType>(index, value, length, weight);
+}
+
+#if defined(__AVX2__)
+/*! \brief AVX2 gather version for float data and 32-bit indices */
+template <>
+inline float SparseDot<float, uint32_t, float, float>(
+    const uint32_t *index, const float *value, size_t length, const float *weight, size_t size) {
+  if (size > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+    // the gather takes signed 32-bit offsets
+    return SparseDotScalar<float>(index, value, length, weight);
+  }
+  __m256 acc = _mm256_setzero_ps();
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index + i));
+    __m256 w = _mm256_i32gather_ps(weight, idx, 4);
+    if (value != NULL) {
+      w = _mm256_mul_ps(w, _mm256_loadu_ps(value + i));
+    }
+    acc = _mm256_add_ps(acc, w);
+  }
+  __m128 sum4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+  sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+  sum4 = _mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, 1));
+  float sum = _mm_cvtss_f32(sum4);
+  for (; i < length; ++i) {
+    sum += value == NULL ? weight[index[i]] : weight[index[i]] * value[i];
+  }
+  return sum;
+}
+#endif  // defined(__AVX2__)
+}  // namespace detail
+
 /*!
  * \brief one row of training instance
  * \tparam IndexType type of index
@@ -142,23 +233,18 @@ class Row {
    * \param weight the dense array of weight we want to product
    * \param size the size of the weight vector
    * \tparam V type of the weight vector
+   * \tparam AccType type of the accumulator, e.g. double for float weights
    * \return the result of dot product
    */
-  template <typename V>
-  inline V SDot(const V *weight, size_t size) const {
-    V sum = static_cast<V>(0);
-    if (value == NULL) {
-      for (size_t i = 0; i < length; ++i) {
-        CHECK(index[i] < size) << "feature index exceed bound";
-        sum += weight[index[i]];
-      }
-    } else {
-      for (size_t i = 0; i < length; ++i) {
-        CHECK(index[i] < size) << "feature index exceed bound";
-        sum += weight[index[i]] * value[i];
-      }
+  template <typename V, typename AccType = V>
+  inline AccType SDot(const V *weight, size_t size) const {
+    // check the bound once, so the loop itself has no branch
+    IndexType max_index = 0;
+    for (size_t i = 0; i < length; ++i) {
+      max_index = std::max(max_index, index[i]);
     }
-    return sum;
+    CHECK(length == 0 || static_cast<size_t>(max_index) < size) << "feature index exceed bound";
+    return detail::SparseDot<AccType>(index, value, length, weight, size);
   }
 };
 
@@ -259,7 +345,7 @@ struct RowBlock {
  * \tparam IndexType type of index in RowBlock
  * \tparam DType type of label and value in RowBlock
  *  Create function was only implemented for IndexType uint64_t and uint32_t
- *  and DType real_t and int
+ *  and DType real_t, int, half_t and bfloat16_t (see dmlc/half.h)
  */
 template <typename IndexType, typename DType = real_t>
 class RowBlockIter : public DataIter<RowBlock<IndexType, DType>> {
@@ -279,6 +365,13 @@ class RowBlockIter : public DataIter<RowBlock<IndexType, DType>> {
       const char *uri, unsigned part_index, unsigned num_parts, const char *type);
   /*! \return maximum feature dimension in the dataset */
   virtual size_t NumCol() const = 0;
+  /*!
+   * \return statistics of the features of the dataset,
+   *  NULL if they are not collected, see dmlc/feature_stats.h
+   */
+  virtual const FeatureStats *Stats(void) const {
+    return NULL;
+  }
 };
 
 /*!
@@ -295,7 +388,7 @@ class RowBlockIter : public DataIter<RowBlock<IndexType, DType>> {
  * \tparam IndexType type of index in RowBlock
  * \tparam DType type of label and value in RowBlock
  *  Create function was only implemented for IndexType uint64_t and uint32_t
- *  and DType real_t and int
+ *  and DType real_t, int, half_t and bfloat16_t (see dmlc/half.h)
  */
 template <typename IndexType, typename DType = real_t>
 class Parser : public DataIter<RowBlock<IndexType, DType>> {
@@ -316,6 +409,22 @@ class Parser : public DataIter<RowBlock<IndexType, DType>> {
       const char *uri_, unsigned part_index, unsigned num_parts, const char *type);
   /*! \return size of bytes read so far */
   virtual size_t BytesRead(void) const = 0;
+  /*!
+   * \return statistics of the features over the last complete pass,
+   *  NULL if they are not collected or no pass completed yet,
+   *  see dmlc/feature_stats.h
+   */
+  virtual const FeatureStats *Stats(void) const {
+    return NULL;
+  }
+  /*!
+   * \brief get the statistics of the queue of the blocks parsed ahead
+   * \param out the statistics
+   * \return false if the parser does not parse ahead in a thread
+   */
+  virtual bool GetPrefetchStats(PrefetchStats * /*out*/) {
+    return false;
+  }
   /*! \brief Factory type of the parser*/
   typedef Parser<IndexType, DType> *(*Factory)(const std::string &path,
       const std::map<std::string, std::string> &args, unsigned part_index, unsigned num_parts);
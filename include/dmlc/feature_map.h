@@ -0,0 +1,146 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file feature_map.h
+ * \brief dictionary mapping sparse 64-bit feature ids, e.g. hashed features,
+ *  to dense 32-bit ids, shared by concurrent parsing threads
+ */
+#ifndef DMLC_FEATURE_MAP_H_
+#define DMLC_FEATURE_MAP_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "./io.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief concurrent dictionary from raw feature ids to dense ids.
+ *  The map is split in shards, each with its own lock, and new ids are
+ *  numbered in the order they are inserted, so concurrent inserts of new ids
+ *  give a numbering that changes between runs: insert them from one thread
+ *  in a fixed order first, as RemapParser does. Once frozen, the ids that
+ *  are not in the dictionary are mapped to kInvalid, i.e. dropped.
+ */
+class FeatureIdMap {
+ public:
+  /*! \brief the dense id of a dropped feature */
+  static const uint32_t kInvalid = std::numeric_limits<uint32_t>::max();
+  /*!
+   * \brief constructor
+   * \param num_shard number of shards, more shards mean less contention
+   */
+  explicit FeatureIdMap(size_t num_shard = 64)
+      : shards_(std::max<size_t>(num_shard, 1)), size_(0), frozen_(false) {}
+  /*!
+   * \brief get the dense id of a feature, numbering it if it is new
+   *  and the dictionary is not frozen. Thread safe.
+   * \param id the raw feature id
+   * \return the dense id, kInvalid if the feature is dropped
+   */
+  inline uint32_t Insert(uint64_t id) {
+    Shard &shard = shards_[this->ShardOf(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.map.find(id);
+    if (it != shard.map.end()) {
+      return it->second;
+    }
+    if (frozen_.load(std::memory_order_relaxed)) {
+      return kInvalid;
+    }
+    const uint32_t dense = size_.fetch_add(1);
+    CHECK(dense != kInvalid) << "number of features exceed numeric bound of uint32_t";
+    shard.map.emplace(id, dense);
+    return dense;
+  }
+  /*!
+   * \brief get the dense id of a feature. Thread safe.
+   * \param id the raw feature id
+   * \return the dense id, kInvalid if the feature is not in the dictionary
+   */
+  inline uint32_t Find(uint64_t id) const {
+    const Shard &shard = shards_[this->ShardOf(id)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.map.find(id);
+    return it == shard.map.end() ? kInvalid : it->second;
+  }
+  /*! \brief stop numbering new features, they are dropped from now on */
+  inline void Freeze(void) {
+    frozen_ = true;
+  }
+  /*! \return whether new features are dropped */
+  inline bool Frozen(void) const {
+    return frozen_;
+  }
+  /*! \return number of features in the dictionary */
+  inline size_t Size(void) const {
+    return size_;
+  }
+  /*! \return array[Size()], the raw id of each dense id */
+  inline std::vector<uint64_t> RawIds(void) const {
+    std::vector<uint64_t> ret(size_);
+    for (const Shard &shard : shards_) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (const auto &kv : shard.map) {
+        ret[kv.second] = kv.first;
+      }
+    }
+    return ret;
+  }
+  /*!
+   * \brief save the dictionary, as the raw id of each dense id
+   * \param fo the output stream
+   */
+  inline void Save(Stream *fo) const {
+    fo->Write(this->RawIds());
+  }
+  /*!
+   * \brief load a dictionary, replacing the content of this one.
+   *  The loaded dictionary is frozen.
+   * \param fi the input stream
+   * \return false if the stream is at its end
+   */
+  inline bool Load(Stream *fi) {
+    std::vector<uint64_t> ids;
+    if (!fi->Read(&ids)) {
+      return false;
+    }
+    for (Shard &shard : shards_) {
+      shard.map.clear();
+    }
+    size_ = 0;
+    frozen_ = false;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      const uint32_t dense = this->Insert(ids[i]);
+      CHECK_EQ(dense, i) << "duplicated feature id " << ids[i] << " in dictionary";
+    }
+    frozen_ = true;
+    return true;
+  }
+
+ private:
+  /*! \brief a shard of the dictionary */
+  struct Shard {
+    /*! \brief protects map */
+    mutable std::mutex mutex;
+    /*! \brief raw id to dense id */
+    std::unordered_map<uint64_t, uint32_t> map;
+  };
+  /*! \brief the shards */
+  std::vector<Shard> shards_;
+  /*! \brief number of features */
+  std::atomic<uint32_t> size_;
+  /*! \brief whether new features are dropped */
+  std::atomic<bool> frozen_;
+  // shard of a raw id, hashed ids can still be sequential in their low bits
+  inline size_t ShardOf(uint64_t id) const {
+    return static_cast<size_t>((id * 0x9E3779B97F4A7C15ULL) >> 32) % shards_.size();
+  }
+};
+}  // namespace dmlc
+#endif  // DMLC_FEATURE_MAP_H_
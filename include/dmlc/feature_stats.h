@@ -0,0 +1,473 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file feature_stats.h
+ * \brief per-feature statistics and mergeable weighted quantile sketches,
+ *  collected by the parsers while the data is read
+ */
+#ifndef DMLC_FEATURE_STATS_H_
+#define DMLC_FEATURE_STATS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "./data.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief summary of a weighted distribution, giving the rank of a value
+ *  within a bounded error. Each entry keeps the minimum and maximum rank
+ *  of its value, so two summaries can be merged and pruned again.
+ */
+struct WQSummary {
+  /*! \brief an entry of the summary */
+  struct Entry {
+    /*! \brief the value */
+    float value;
+    /*! \brief lower bound of the total weight of the values smaller than value */
+    double rmin;
+    /*! \brief upper bound of the total weight of the values not larger than value */
+    double rmax;
+    /*! \brief lower bound of the weight of value itself */
+    double wmin;
+    /*! \return lower bound of the rank of the next value */
+    inline double RMinNext(void) const {
+      return rmin + wmin;
+    }
+    /*! \return upper bound of the rank of the previous value */
+    inline double RMaxPrev(void) const {
+      return rmax - wmin;
+    }
+  };
+  /*! \brief the entries, in increasing order of value */
+  std::vector<Entry> data;
+  /*! \return total weight of the summarized values */
+  inline double TotalWeight(void) const {
+    return data.size() == 0 ? 0.0 : data.back().rmax;
+  }
+  /*!
+   * \brief build the exact summary of values
+   * \param values pairs of value and weight, sorted by value
+   * \param size number of pairs
+   */
+  inline void Build(const std::pair<float, double> *values, size_t size) {
+    data.clear();
+    double wsum = 0.0;
+    for (size_t i = 0; i < size;) {
+      const float value = values[i].first;
+      double w = 0.0;
+      for (; i < size && values[i].first == value; ++i) {
+        w += values[i].second;
+      }
+      Entry e;
+      e.value = value;
+      e.rmin = wsum;
+      e.wmin = w;
+      e.rmax = wsum + w;
+      data.push_back(e);
+      wsum += w;
+    }
+  }
+  /*!
+   * \brief set the summary to the union of two summaries,
+   *  the errors of the inputs add up
+   * \param a the first summary
+   * \param b the second summary
+   */
+  inline void Combine(const WQSummary &a, const WQSummary &b) {
+    if (a.data.size() == 0 || b.data.size() == 0) {
+      data = a.data.size() == 0 ? b.data : a.data;
+      return;
+    }
+    data.clear();
+    data.reserve(a.data.size() + b.data.size());
+    const Entry *pa = a.data.data(), *ea = pa + a.data.size();
+    const Entry *pb = b.data.data(), *eb = pb + b.data.size();
+    // rank bounds of the last value consumed in each input
+    double aprev_rmin = 0.0, bprev_rmin = 0.0;
+    while (pa != ea && pb != eb) {
+      Entry e;
+      if (pa->value == pb->value) {
+        e.value = pa->value;
+        e.rmin = pa->rmin + pb->rmin;
+        e.rmax = pa->rmax + pb->rmax;
+        e.wmin = pa->wmin + pb->wmin;
+        aprev_rmin = pa->RMinNext();
+        bprev_rmin = pb->RMinNext();
+        ++pa;
+        ++pb;
+      } else if (pa->value < pb->value) {
+        e.value = pa->value;
+        e.rmin = pa->rmin + bprev_rmin;
+        e.rmax = pa->rmax + pb->RMaxPrev();
+        e.wmin = pa->wmin;
+        aprev_rmin = pa->RMinNext();
+        ++pa;
+      } else {
+        e.value = pb->value;
+        e.rmin = pb->rmin + aprev_rmin;
+        e.rmax = pb->rmax + pa->RMaxPrev();
+        e.wmin = pb->wmin;
+        bprev_rmin = pb->RMinNext();
+        ++pb;
+      }
+      data.push_back(e);
+    }
+    for (; pa != ea; ++pa) {
+      Entry e = *pa;
+      e.rmin += bprev_rmin;
+      e.rmax += b.data.back().rmax;
+      data.push_back(e);
+    }
+    for (; pb != eb; ++pb) {
+      Entry e = *pb;
+      e.rmin += aprev_rmin;
+      e.rmax += a.data.back().rmax;
+      data.push_back(e);
+    }
+  }
+  /*!
+   * \brief keep at most max_size entries, evenly spaced in rank.
+   *  The error grows by at most TotalWeight() / (max_size - 1).
+   * \param max_size maximum number of entries, at least 2
+   */
+  inline void Prune(size_t max_size) {
+    if (data.size() <= max_size) {
+      return;
+    }
+    CHECK_GE(max_size, 2U) << "quantile summary needs at least 2 entries";
+    std::vector<Entry> src;
+    src.swap(data);
+    const double begin = src[0].rmax;
+    const double range = src.back().rmin - begin;
+    const size_t n = max_size - 1;
+    data.push_back(src[0]);
+    size_t i = 1, lastidx = 0;
+    for (size_t k = 1; k < n; ++k) {
+      // twice the target rank, compared with rmin + rmax of the entries
+      const double dx2 = 2.0 * (static_cast<double>(k) * range / n + begin);
+      while (i < src.size() - 1 && dx2 >= src[i + 1].rmax + src[i + 1].rmin) {
+        ++i;
+      }
+      if (i == src.size() - 1) {
+        break;
+      }
+      const size_t pick = dx2 < src[i].RMinNext() + src[i + 1].RMaxPrev() ? i : i + 1;
+      if (pick != lastidx) {
+        data.push_back(src[pick]);
+        lastidx = pick;
+      }
+    }
+    if (lastidx != src.size() - 1) {
+      data.push_back(src.back());
+    }
+  }
+  /*!
+   * \brief query the value at a rank
+   * \param rank the rank, in [0, TotalWeight()]
+   * \return the value whose rank range is the closest to rank
+   */
+  inline float Query(double rank) const {
+    CHECK_NE(data.size(), 0U) << "query on an empty summary";
+    // the entries are sorted by rmin + rmax as well as by value
+    size_t lo = 0, hi = data.size() - 1;
+    while (lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      if (data[mid].rmin + data[mid].rmax < 2.0 * rank) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    if (lo != 0
+        && 2.0 * rank - (data[lo - 1].rmin + data[lo - 1].rmax)
+               < (data[lo].rmin + data[lo].rmax) - 2.0 * rank) {
+      return data[lo - 1].value;
+    }
+    return data[lo].value;
+  }
+  /*!
+   * \brief cut points splitting the distribution into bins of about equal weight
+   * \param max_bin maximum number of bins
+   * \return at most max_bin - 1 distinct cut points in increasing order,
+   *  a value v falls in bin std::upper_bound(cuts, v) - cuts.begin()
+   */
+  inline std::vector<float> GetCuts(size_t max_bin) const {
+    std::vector<float> cuts;
+    if (data.size() == 0) {
+      return cuts;
+    }
+    const double total = this->TotalWeight();
+    for (size_t k = 1; k < max_bin; ++k) {
+      const float v = this->Query(total * k / max_bin);
+      // the smallest value would leave bin 0 empty
+      if (v != data[0].value && (cuts.size() == 0 || cuts.back() < v)) {
+        cuts.push_back(v);
+      }
+    }
+    return cuts;
+  }
+};
+
+/*!
+ * \brief mergeable sketch of a stream of weighted values. Summaries pushed
+ *  into the sketch are merged like a binary counter, level l holding the
+ *  union of 2^l pushes, so the error grows with the logarithm of the
+ *  number of pushes instead of linearly.
+ */
+class WQSketch {
+ public:
+  /*!
+   * \brief constructor
+   * \param max_size maximum number of entries of each summary
+   */
+  explicit WQSketch(size_t max_size = 256) : max_size_(std::max<size_t>(max_size, 2)) {}
+  /*!
+   * \brief add a summary to the sketch
+   * \param summary the summary, of at most max_size entries
+   */
+  inline void Push(const WQSummary &summary) {
+    if (summary.data.size() == 0) {
+      return;
+    }
+    WQSummary carry = summary, tmp;
+    for (size_t l = 0;; ++l) {
+      if (l == levels_.size()) {
+        levels_.push_back(WQSummary());
+      }
+      if (levels_[l].data.size() == 0) {
+        levels_[l].data.swap(carry.data);
+        return;
+      }
+      tmp.Combine(levels_[l], carry);
+      tmp.Prune(max_size_);
+      carry.data.swap(tmp.data);
+      levels_[l].data.clear();
+    }
+  }
+  /*!
+   * \brief merge another sketch into this one
+   * \param other the sketch to merge
+   */
+  inline void Merge(const WQSketch &other) {
+    for (const WQSummary &level : other.levels_) {
+      this->Push(level);
+    }
+  }
+  /*! \return the summary of all values pushed, of at most max_size entries */
+  inline WQSummary GetSummary(void) const {
+    WQSummary ret, tmp;
+    for (const WQSummary &level : levels_) {
+      tmp.Combine(ret, level);
+      ret.data.swap(tmp.data);
+    }
+    ret.Prune(max_size_);
+    return ret;
+  }
+  /*! \return maximum number of entries of each summary */
+  inline size_t MaxSize(void) const {
+    return max_size_;
+  }
+
+ private:
+  /*! \brief maximum number of entries of each summary */
+  size_t max_size_;
+  /*! \brief level l summarizes 2^l pushes, or is empty */
+  std::vector<WQSummary> levels_;
+};
+
+/*! \brief statistics of the entries of one feature */
+struct FeatureStat {
+  /*! \brief number of entries */
+  size_t count;
+  /*! \brief total weight of the rows with an entry */
+  double sum_weight;
+  /*! \brief minimum value */
+  float min_value;
+  /*! \brief maximum value */
+  float max_value;
+  FeatureStat(void)
+      : count(0),
+        sum_weight(0.0),
+        min_value(std::numeric_limits<float>::max()),
+        max_value(std::numeric_limits<float>::lowest()) {}
+  /*!
+   * \brief merge the statistics of another part of the data
+   * \param other the statistics to merge
+   */
+  inline void Merge(const FeatureStat &other) {
+    count += other.count;
+    sum_weight += other.sum_weight;
+    min_value = std::min(min_value, other.min_value);
+    max_value = std::max(max_value, other.max_value);
+  }
+};
+
+/*!
+ * \brief statistics of every feature of a dataset: entry count, weight,
+ *  minimum, maximum and optionally a quantile sketch of the values.
+ *  Partial statistics of disjoint parts of the data are merged with Merge.
+ *  The statistics are kept in hash maps keyed by feature id, so the memory
+ *  grows with the number of distinct features, hashed 64-bit ids included.
+ */
+class FeatureStats {
+ public:
+  /*!
+   * \brief constructor
+   * \param sketch_size maximum number of entries of the quantile summary
+   *  of each feature, 0 to only collect the count, weight, minimum and maximum
+   */
+  explicit FeatureStats(size_t sketch_size = 0)
+      : sketch_size_(sketch_size), num_row_(0), sum_weight_(0.0), size_(0) {}
+  /*!
+   * \brief add the entries of a block
+   * \param batch the block
+   */
+  template <typename IndexType, typename DType>
+  inline void Add(const RowBlock<IndexType, DType> &batch);
+  /*!
+   * \brief merge the statistics of another part of the data
+   * \param other the statistics to merge, with the same sketch size
+   */
+  inline void Merge(const FeatureStats &other) {
+    CHECK_EQ(sketch_size_, other.sketch_size_) << "merging stats of different sketch size";
+    num_row_ += other.num_row_;
+    sum_weight_ += other.sum_weight_;
+    size_ = std::max(size_, other.size_);
+    for (const std::pair<const uint64_t, FeatureStat> &kv : other.stats_) {
+      stats_[kv.first].Merge(kv.second);
+    }
+    for (const std::pair<const uint64_t, WQSketch> &kv : other.sketch_) {
+      this->Sketch(kv.first).Merge(kv.second);
+    }
+  }
+  /*! \brief remove all the statistics */
+  inline void Clear(void) {
+    num_row_ = 0;
+    sum_weight_ = 0.0;
+    size_ = 0;
+    stats_.clear();
+    sketch_.clear();
+  }
+  /*! \return the maximum feature id plus one */
+  inline size_t Size(void) const {
+    return size_;
+  }
+  /*! \return the ids of the features with an entry, in increasing order */
+  inline std::vector<uint64_t> FeatureIds(void) const {
+    std::vector<uint64_t> ret;
+    ret.reserve(stats_.size());
+    for (const std::pair<const uint64_t, FeatureStat> &kv : stats_) {
+      ret.push_back(kv.first);
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+  }
+  /*! \return number of rows */
+  inline size_t NumRow(void) const {
+    return num_row_;
+  }
+  /*! \return total weight of the rows */
+  inline double SumWeight(void) const {
+    return sum_weight_;
+  }
+  /*! \return maximum number of entries of the quantile summaries, 0 if not sketched */
+  inline size_t SketchSize(void) const {
+    return sketch_size_;
+  }
+  /*!
+   * \param fid the feature id
+   * \return the statistics of the feature, with a count of 0 if it has no entry
+   */
+  inline const FeatureStat &operator[](size_t fid) const {
+    static const FeatureStat empty;
+    std::unordered_map<uint64_t, FeatureStat>::const_iterator it = stats_.find(fid);
+    return it == stats_.end() ? empty : it->second;
+  }
+  /*!
+   * \param fid the feature id
+   * \return quantile summary of the values of the feature, empty if it has no entry
+   */
+  inline WQSummary Summary(size_t fid) const {
+    CHECK_NE(sketch_size_, 0U) << "feature values are not sketched";
+    std::unordered_map<uint64_t, WQSketch>::const_iterator it = sketch_.find(fid);
+    return it == sketch_.end() ? WQSummary() : it->second.GetSummary();
+  }
+  /*!
+   * \param fid the feature id
+   * \param max_bin maximum number of bins
+   * \return the cut points of the feature, see WQSummary::GetCuts
+   */
+  inline std::vector<float> Cuts(size_t fid, size_t max_bin) const {
+    return this->Summary(fid).GetCuts(max_bin);
+  }
+
+ private:
+  /*! \brief maximum number of entries of the quantile summaries */
+  size_t sketch_size_;
+  /*! \brief number of rows */
+  size_t num_row_;
+  /*! \brief total weight of the rows */
+  double sum_weight_;
+  /*! \brief the maximum feature id plus one */
+  size_t size_;
+  /*! \brief statistics of each feature with an entry */
+  std::unordered_map<uint64_t, FeatureStat> stats_;
+  /*! \brief sketch of the values of each feature, empty if not sketched */
+  std::unordered_map<uint64_t, WQSketch> sketch_;
+  // the sketch of a feature, created empty
+  inline WQSketch &Sketch(uint64_t fid) {
+    std::unordered_map<uint64_t, WQSketch>::iterator it = sketch_.find(fid);
+    if (it == sketch_.end()) {
+      it = sketch_.insert(std::make_pair(fid, WQSketch(sketch_size_))).first;
+    }
+    return it->second;
+  }
+};
+
+template <typename IndexType, typename DType>
+inline void FeatureStats::Add(const RowBlock<IndexType, DType> &batch) {
+  // group the entries by feature, in increasing order of value
+  std::vector<std::tuple<IndexType, float, double>> entry;
+  entry.reserve(batch.offset[batch.size] - batch.offset[0]);
+  for (size_t i = 0; i < batch.size; ++i) {
+    const double w = batch.weight == NULL ? 1.0 : static_cast<double>(batch.weight[i]);
+    sum_weight_ += w;
+    for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+      const float v = batch.value == NULL ? 1.0f : static_cast<float>(batch.value[j]);
+      entry.emplace_back(batch.index[j], v, w);
+    }
+  }
+  num_row_ += batch.size;
+  if (entry.size() == 0) {
+    return;
+  }
+  std::sort(entry.begin(), entry.end());
+  size_ = std::max(size_, static_cast<size_t>(std::get<0>(entry.back())) + 1);
+  std::vector<std::pair<float, double>> values;
+  WQSummary summary;
+  for (size_t i = 0; i < entry.size();) {
+    const IndexType fid = std::get<0>(entry[i]);
+    FeatureStat &stat = stats_[static_cast<uint64_t>(fid)];
+    stat.min_value = std::min(stat.min_value, std::get<1>(entry[i]));
+    values.clear();
+    for (; i < entry.size() && std::get<0>(entry[i]) == fid; ++i) {
+      stat.count += 1;
+      stat.sum_weight += std::get<2>(entry[i]);
+      values.emplace_back(std::get<1>(entry[i]), std::get<2>(entry[i]));
+    }
+    stat.max_value = std::max(stat.max_value, values.back().first);
+    if (sketch_size_ != 0) {
+      summary.Build(values.data(), values.size());
+      summary.Prune(sketch_size_);
+      this->Sketch(static_cast<uint64_t>(fid)).Push(summary);
+    }
+  }
+}
+}  // namespace dmlc
+#endif  // DMLC_FEATURE_STATS_H_
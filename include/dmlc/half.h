@@ -0,0 +1,208 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file half.h
+ * \brief 16-bit floating point types backed by uint16_t,
+ *  usable as the DType of RowBlock, Parser and RowBlockIter
+ */
+#ifndef DMLC_HALF_H_
+#define DMLC_HALF_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__F16C__)
+  #include <immintrin.h>
+#endif  // defined(__F16C__)
+
+#include "./type_traits.h"
+
+namespace dmlc {
+/*!
+ * \brief convert a float to IEEE 754 half precision, rounding to nearest even
+ * \param value the float value
+ * \return the bits of the half precision value
+ */
+inline uint16_t FloatToHalfBits(float value) {
+  uint32_t f;
+  std::memcpy(&f, &value, sizeof(f));
+  const uint32_t sign = f & 0x80000000U;
+  f ^= sign;
+  uint32_t out;
+  if (f >= (127U + 16U) << 23) {
+    // overflow to infinity, NaN stays a quiet NaN
+    out = f > (255U << 23) ? 0x7e00U : 0x7c00U;
+  } else if (f < (113U << 23)) {
+    // subnormal or zero, let the float addition do the rounding
+    const uint32_t magic_bits = ((127U - 15U) + (23U - 10U) + 1U) << 23;
+    float magic, x;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&x, &f, sizeof(x));
+    x += magic;
+    std::memcpy(&out, &x, sizeof(out));
+    out -= magic_bits;
+  } else {
+    const uint32_t mant_odd = (f >> 13) & 1U;
+    f += (static_cast<uint32_t>(15 - 127) << 23) + 0xfffU + mant_odd;
+    out = f >> 13;
+  }
+  return static_cast<uint16_t>(out | (sign >> 16));
+}
+/*!
+ * \brief convert IEEE 754 half precision to a float
+ * \param bits the bits of the half precision value
+ * \return the float value
+ */
+inline float HalfBitsToFloat(uint16_t bits) {
+  const uint32_t shifted_exp = 0x7c00U << 13;
+  uint32_t o = (bits & 0x7fffU) << 13;
+  const uint32_t exp = shifted_exp & o;
+  o += (127U - 15U) << 23;
+  if (exp == shifted_exp) {
+    // infinity or NaN
+    o += (128U - 16U) << 23;
+  } else if (exp == 0) {
+    // zero or subnormal, renormalize
+    const uint32_t magic_bits = 113U << 23;
+    float magic, x;
+    o += 1U << 23;
+    std::memcpy(&magic, &magic_bits, sizeof(magic));
+    std::memcpy(&x, &o, sizeof(x));
+    x -= magic;
+    std::memcpy(&o, &x, sizeof(o));
+  }
+  o |= static_cast<uint32_t>(bits & 0x8000U) << 16;
+  float ret;
+  std::memcpy(&ret, &o, sizeof(ret));
+  return ret;
+}
+/*!
+ * \brief convert a float to bfloat16, rounding to nearest even
+ * \param value the float value
+ * \return the bits of the bfloat16 value
+ */
+inline uint16_t FloatToBFloat16Bits(float value) {
+  uint32_t f;
+  std::memcpy(&f, &value, sizeof(f));
+  if ((f & 0x7fffffffU) > 0x7f800000U) {
+    // keep NaN a quiet NaN
+    return static_cast<uint16_t>((f >> 16) | 0x40U);
+  }
+  f += 0x7fffU + ((f >> 16) & 1U);
+  return static_cast<uint16_t>(f >> 16);
+}
+/*!
+ * \brief convert bfloat16 to a float
+ * \param bits the bits of the bfloat16 value
+ * \return the float value
+ */
+inline float BFloat16BitsToFloat(uint16_t bits) {
+  const uint32_t o = static_cast<uint32_t>(bits) << 16;
+  float ret;
+  std::memcpy(&ret, &o, sizeof(ret));
+  return ret;
+}
+
+/*!
+ * \brief IEEE 754 half precision floating point, stored in 16 bits.
+ *  Converts implicitly from and to float, arithmetic happens in float.
+ */
+struct half_t {
+  /*! \brief the raw bits */
+  uint16_t bits;
+  /*! \brief default constructor, leaves the value uninitialized */
+  half_t() = default;
+  /*! \brief construct from a float */
+  half_t(float value) : bits(FloatToHalfBits(value)) {}  // NOLINT(*)
+  /*! \return the value as a float */
+  operator float() const {
+    return HalfBitsToFloat(bits);
+  }
+};
+
+/*!
+ * \brief bfloat16 floating point, the upper 16 bits of a float.
+ *  Converts implicitly from and to float, arithmetic happens in float.
+ */
+struct bfloat16_t {
+  /*! \brief the raw bits */
+  uint16_t bits;
+  /*! \brief default constructor, leaves the value uninitialized */
+  bfloat16_t() = default;
+  /*! \brief construct from a float */
+  bfloat16_t(float value) : bits(FloatToBFloat16Bits(value)) {}  // NOLINT(*)
+  /*! \return the value as a float */
+  operator float() const {
+    return BFloat16BitsToFloat(bits);
+  }
+};
+
+static_assert(sizeof(half_t) == 2 && std::is_pod<half_t>::value,
+    "half_t must be a 16-bit POD to be saved as raw bytes");
+static_assert(sizeof(bfloat16_t) == 2 && std::is_pod<bfloat16_t>::value,
+    "bfloat16_t must be a 16-bit POD to be saved as raw bytes");
+
+/*!
+ * \brief convert an array of values, uses the F16C instructions
+ *  for float and half_t when compiled with them
+ * \param src the source array
+ * \param size number of values
+ * \param dst the destination array
+ * \tparam SrcType the source type
+ * \tparam DstType the destination type
+ */
+template <typename SrcType, typename DstType>
+inline void ConvertArray(const SrcType *src, size_t size, DstType *dst) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = static_cast<DstType>(src[i]);
+  }
+}
+
+template <>
+inline void ConvertArray<float, half_t>(const float *src, size_t size, half_t *dst) {
+  size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= size; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+  }
+#endif  // defined(__F16C__)
+  for (; i < size; ++i) {
+    dst[i].bits = FloatToHalfBits(src[i]);
+  }
+}
+
+template <>
+inline void ConvertArray<half_t, float>(const half_t *src, size_t size, float *dst) {
+  size_t i = 0;
+#if defined(__F16C__)
+  for (; i + 8 <= size; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif  // defined(__F16C__)
+  for (; i < size; ++i) {
+    dst[i] = HalfBitsToFloat(src[i].bits);
+  }
+}
+
+template <>
+inline void ConvertArray<float, bfloat16_t>(const float *src, size_t size, bfloat16_t *dst) {
+  // branch free except for NaN, the compiler vectorizes this loop
+  for (size_t i = 0; i < size; ++i) {
+    dst[i].bits = FloatToBFloat16Bits(src[i]);
+  }
+}
+
+template <>
+inline void ConvertArray<bfloat16_t, float>(const bfloat16_t *src, size_t size, float *dst) {
+  for (size_t i = 0; i < size; ++i) {
+    dst[i] = BFloat16BitsToFloat(src[i].bits);
+  }
+}
+
+DMLC_DECLARE_TYPE_NAME(half_t, "half");
+DMLC_DECLARE_TYPE_NAME(bfloat16_t, "bfloat16");
+}  // namespace dmlc
+#endif  // DMLC_HALF_H_
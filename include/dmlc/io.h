@@ -144,6 +144,24 @@ class Serializable {
   virtual void Save(Stream *fo) const = 0;
 };
 
+/*! \brief statistics of a prefetch queue, see ThreadedIter */
+struct PrefetchStats {
+  /*! \brief number of items produced */
+  size_t num_produced{0};
+  /*! \brief number of times the consumer waited for an item */
+  size_t num_consumer_wait{0};
+  /*! \brief seconds the consumer waited for items */
+  double consumer_wait_sec{0};
+  /*! \brief seconds the producer waited for room in the queue */
+  double producer_wait_sec{0};
+  /*! \brief current maximum number of items in the queue */
+  size_t depth{0};
+  /*! \brief number of items in the queue */
+  size_t queue_size{0};
+  /*! \brief bytes held by the items of the queue, 0 if not measured */
+  size_t bytes{0};
+};
+
 /*!
  * \brief input split creates that allows reading
  *  of records from split of data,
@@ -170,6 +188,32 @@ class InputSplit {
   virtual void HintChunkSize(size_t /*chunk_size*/) {}
   /*! \brief get the total size of the InputSplit */
   virtual size_t GetTotalSize(void) = 0;
+  /*!
+   * \brief get the statistics of the prefetch queue
+   * \param out the statistics
+   * \return false if the split does not prefetch
+   */
+  virtual bool GetPrefetchStats(PrefetchStats * /*out*/) {
+    return false;
+  }
+  /*!
+   * \brief get the number of records of the partition without reading it,
+   *  known for "text" inputs with a line index, see Create
+   * \param out_num_records the number of records
+   * \return false if the number is not known
+   */
+  virtual bool GetNumRecords(size_t * /*out_num_records*/) {
+    return false;
+  }
+  /*!
+   * \brief restart the partition at a record, the next records are read from there,
+   *  supported by "text" inputs with a line index, see Create
+   * \param index the index of the record in the partition
+   * \return false if not supported
+   */
+  virtual bool SeekRecord(size_t /*index*/) {
+    return false;
+  }
   /*! \brief reset the position of InputSplit to beginning */
   virtual void BeforeFirst(void) = 0;
   /*!
@@ -240,7 +284,24 @@ class InputSplit {
   /*!
    * \brief factory function:
    *  create input split given a uri
-   * \param uri the uri of the input, can contain hdfs prefix
+   * \param uri the uri of the input, can contain hdfs prefix.
+   *   Local "text" and "recordio" files are read through memory maps with uri?mmap=1,
+   *   the records then point into the mapping instead of a copy of the file.
+   *   With uri?readers=n, n threads read the next chunks ahead with positioned reads,
+   *   for shuffled "indexed_recordio" they read the sorted ranges of each batch.
+   *   With uri?aio=n, n blocks of the local files are kept in flight through io_uring,
+   *   and uri?direct=1 reads them with O_DIRECT, bypassing the page cache.
+   *   With uri?line_index=file, "text" inputs use a sidecar index of the line offsets,
+   *   built on first use, to have the same number of lines in each partition.
+   *   With uri?whole_files=1, the partitions are made of whole files, which are
+   *   read 8 at a time unless uri?readers=n is given, for datasets of many small files.
+   *   The entries of the uri can be glob patterns such as /data/2024-0?/part-[0-9]*.
+   *   With uri?manifest=file, the listing of the files is read from the file instead
+   *   of listing the directories again, the file is written on first use, and
+   *   written again when the size of its first or last file changed.
+   *   With uri?shuffle_mb=n, the records are returned in random order from a reservoir
+   *   of n MB filled by sequential reads, uri?shuffle_seed=s seeds the order together
+   *   with the rank and the epoch; the chunks are made of the shuffled records.
    * \param part_index the part id of current input
    * \param num_parts total number of splits
    * \param type type of record
@@ -573,8 +634,12 @@ struct FileInfo {
   size_t size;
   /*! \brief the type of the file */
   FileType type;
+  /*! \brief last modification time in nanoseconds since epoch, 0 if unknown */
+  uint64_t mtime;
+  /*! \brief entity tag reported by object stores, empty if unknown */
+  std::string etag;
   /*! \brief default constructor */
-  FileInfo() : size(0), type(kFile) {}
+  FileInfo() : size(0), type(kFile), mtime(0) {}
 };
 
 /*! \brief file system system interface */
@@ -0,0 +1,403 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file quantizer.h
+ * \brief quantization of feature values into small bin ids,
+ *  for histogram based learners that do not need the values themselves
+ */
+#ifndef DMLC_QUANTIZER_H_
+#define DMLC_QUANTIZER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "./common.h"
+#include "./data.h"
+#include "./feature_stats.h"
+#include "./io.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief cut points of every feature, mapping a value to the bin
+ *  std::upper_bound(cuts, value) - cuts.begin(), so a feature with
+ *  n cut points has n + 1 bins. Features without cut points have one bin.
+ */
+class BinQuantizer {
+ public:
+  BinQuantizer(void) : cut_ptr_(1, 0) {}
+  /*!
+   * \brief add the cut points of the next feature
+   * \param cuts the cut points, in increasing order
+   */
+  inline void AddFeature(const std::vector<float> &cuts) {
+    CHECK(std::is_sorted(cuts.begin(), cuts.end())) << "cut points must be sorted";
+    cut_.insert(cut_.end(), cuts.begin(), cuts.end());
+    cut_ptr_.push_back(cut_.size());
+  }
+  /*!
+   * \brief create the quantizer of the features of a dataset
+   * \param stats statistics of the dataset, with quantile sketches
+   * \param max_bin maximum number of bins of each feature
+   * \return the quantizer with the quantile cut points of each feature
+   */
+  inline static BinQuantizer FromStats(const FeatureStats &stats, size_t max_bin) {
+    BinQuantizer ret;
+    for (size_t fid = 0; fid < stats.Size(); ++fid) {
+      ret.AddFeature(stats[fid].count == 0 ? std::vector<float>() : stats.Cuts(fid, max_bin));
+    }
+    return ret;
+  }
+  /*! \return number of features with cut points */
+  inline size_t NumFeature(void) const {
+    return cut_ptr_.size() - 1;
+  }
+  /*! \return maximum number of bins over the features */
+  inline size_t MaxBin(void) const {
+    size_t ret = 1;
+    for (size_t fid = 0; fid < this->NumFeature(); ++fid) {
+      ret = std::max(ret, cut_ptr_[fid + 1] - cut_ptr_[fid] + 1);
+    }
+    return ret;
+  }
+  /*!
+   * \brief get the bin of a value
+   * \param fid the feature id
+   * \param value the value
+   * \return the bin id
+   */
+  inline size_t Bin(size_t fid, float value) const {
+    if (fid >= this->NumFeature()) {
+      return 0;
+    }
+    // branch free binary search, the loop has a fixed trip count for a feature
+    const float *cuts = cut_.data() + cut_ptr_[fid];
+    const float *base = cuts;
+    size_t len = cut_ptr_[fid + 1] - cut_ptr_[fid];
+    while (len > 1) {
+      const size_t half = len / 2;
+      base = base[half - 1] <= value ? base + half : base;
+      len -= half;
+    }
+    return static_cast<size_t>(base - cuts) + (len == 1 && base[0] <= value);
+  }
+  /*!
+   * \brief get the bins of consecutive entries, as Bin. The binary searches of
+   *  kLane entries run in lockstep on independent lanes, so their loads overlap
+   *  and the compiler can vectorize the steps across the lanes.
+   * \param index array[n], the feature id of each entry
+   * \param value array[n], the value of each entry, NULL for values of 1
+   * \param n number of entries
+   * \param out array[n], the bin of each entry, can be value
+   * \tparam BinType type of the bin id, must hold MaxBin() - 1
+   */
+  template <typename IndexType, typename DType, typename BinType>
+  inline void BinEntries(
+      const IndexType *index, const DType *value, size_t n, BinType *out) const {
+    const size_t nfeature = this->NumFeature();
+    for (size_t i = 0; i < n; i += kLane) {
+      const size_t nlane = n - i < kLane ? n - i : kLane;
+      const float *cuts[kLane];
+      size_t len[kLane], pos[kLane];
+      float v[kLane];
+      size_t max_len = 0;
+      for (size_t k = 0; k < kLane; ++k) {
+        // the lanes past the end search an empty feature
+        const size_t fid = k < nlane ? static_cast<size_t>(index[i + k]) : nfeature;
+        cuts[k] = cut_.data() + (fid < nfeature ? cut_ptr_[fid] : 0);
+        len[k] = fid < nfeature ? cut_ptr_[fid + 1] - cut_ptr_[fid] : 0;
+        pos[k] = 0;
+        v[k] = k < nlane && value != NULL ? static_cast<float>(value[i + k]) : 1.0f;
+        max_len = std::max(max_len, len[k]);
+      }
+      // the lanes take the same number of steps, a finished lane steps by 0
+      for (; max_len > 1; max_len -= max_len / 2) {
+        for (size_t k = 0; k < kLane; ++k) {
+          const size_t half = len[k] / 2;
+          const size_t probe = pos[k] + half - (half != 0);
+          pos[k] += (half != 0 && cuts[k][probe] <= v[k]) ? half : 0;
+          len[k] -= half;
+        }
+      }
+      for (size_t k = 0; k < nlane; ++k) {
+        const size_t bin = pos[k] + (len[k] == 1 && cuts[k][pos[k]] <= v[k]);
+        out[i + k] = static_cast<BinType>(bin);
+      }
+    }
+  }
+  /*!
+   * \brief quantize the values of a block, in parallel over rows
+   * \param batch the block
+   * \param out array[number of entries of batch], the bin of each entry
+   * \param nthread number of threads, the number of cores if not positive
+   * \tparam BinType type of the bin id, must hold MaxBin() - 1
+   */
+  template <typename IndexType, typename DType, typename BinType>
+  inline void Quantize(
+      const RowBlock<IndexType, DType> &batch, BinType *out, int nthread = 0) const {
+    CHECK_LE(this->MaxBin() - 1, static_cast<size_t>(std::numeric_limits<BinType>::max()))
+        << "number of bins exceed numeric bound of the bin type";
+    const size_t base = batch.offset[0];
+    ParallelFor(batch.size, nthread, [&](int /*tid*/, size_t begin, size_t end) {
+      const size_t j = batch.offset[begin];
+      this->BinEntries(batch.index + j, batch.value == NULL ? NULL : batch.value + j,
+          batch.offset[end] - j, out + (j - base));
+    });
+  }
+  /*!
+   * \brief save the quantizer to a stream
+   * \param fo the output stream
+   */
+  inline void Save(Stream *fo) const {
+    fo->Write(cut_ptr_);
+    fo->Write(cut_);
+  }
+  /*!
+   * \brief load the quantizer from a stream
+   * \param fi the input stream
+   * \return false if the stream is at its end
+   */
+  inline bool Load(Stream *fi) {
+    if (!fi->Read(&cut_ptr_)) {
+      return false;
+    }
+    CHECK(fi->Read(&cut_)) << "invalid quantizer format";
+    CHECK(cut_ptr_.size() != 0 && cut_ptr_.back() == cut_.size()) << "invalid quantizer format";
+    return true;
+  }
+
+ private:
+  /*! \brief number of entries searched in lockstep by BinEntries */
+  static const size_t kLane = 8;
+  /*! \brief array[NumFeature()+1], beginning of the cut points of each feature */
+  std::vector<size_t> cut_ptr_;
+  /*! \brief cut points of all the features */
+  std::vector<float> cut_;
+};
+
+/*!
+ * \brief a RowBlock whose values are replaced by bin ids
+ * \tparam IndexType type of the index
+ * \tparam BinType type of the bin id
+ */
+template <typename IndexType, typename BinType = uint8_t>
+struct BinRowBlock {
+  /*! \brief the rows, value is NULL */
+  RowBlock<IndexType> rows;
+  /*! \brief bin id of each entry, at the same position as rows.index */
+  const BinType *bin;
+  /*!
+   * \brief slice a BinRowBlock to get rows in [begin, end)
+   * \param begin the begin row index
+   * \param end the end row index
+   * \return the sliced BinRowBlock
+   */
+  inline BinRowBlock Slice(size_t begin, size_t end) const {
+    BinRowBlock ret;
+    ret.rows = rows.Slice(begin, end);
+    ret.bin = bin;
+    return ret;
+  }
+};
+
+/*!
+ * \brief dynamic data structure that holds a BinRowBlock,
+ *  the float values are quantized as the rows are pushed and never stored
+ * \tparam IndexType type of the index
+ * \tparam BinType type of the bin id
+ */
+template <typename IndexType, typename BinType = uint8_t>
+struct BinRowBlockContainer {
+  /*! \brief array[size+1], row pointer to beginning of each rows */
+  std::vector<size_t> offset;
+  /*! \brief array[size] label of each instance */
+  std::vector<real_t> label;
+  /*! \brief array[size] weight of each instance, empty if not given */
+  std::vector<real_t> weight;
+  /*! \brief array[size] session id of each instance, empty if not given */
+  std::vector<uint64_t> qid;
+  /*! \brief field id of each entry, empty if not given */
+  std::vector<IndexType> field;
+  /*! \brief feature index of each entry */
+  std::vector<IndexType> index;
+  /*! \brief bin id of each entry */
+  std::vector<BinType> bin;
+  BinRowBlockContainer(void) : offset(1, 0) {}
+  /*! \return number of rows */
+  inline size_t Size(void) const {
+    return offset.size() - 1;
+  }
+  /*! \return memory cost of this container in bytes */
+  inline size_t MemCostBytes(void) const {
+    return offset.size() * sizeof(size_t) + label.size() * sizeof(real_t)
+           + weight.size() * sizeof(real_t) + qid.size() * sizeof(uint64_t)
+           + field.size() * sizeof(IndexType) + index.size() * sizeof(IndexType)
+           + bin.size() * sizeof(BinType);
+  }
+  /*!
+   * \brief push the rows of a block, quantizing the values
+   * \param batch the block
+   * \param quantizer the cut points of the features
+   * \param nthread number of threads of the quantization, the number of cores if not positive
+   */
+  template <typename DType>
+  inline void Push(const RowBlock<IndexType, DType> &batch, const BinQuantizer &quantizer,
+      int nthread = 0) {
+    const size_t start = this->PushRows(batch);
+    quantizer.Quantize(batch, BeginPtr(bin) + start, nthread);
+  }
+  /*!
+   * \brief push the rows of a block whose values are already bin ids,
+   *  as parsed with the uri argument bin_cuts
+   * \param batch the block
+   */
+  template <typename DType>
+  inline void PushBins(const RowBlock<IndexType, DType> &batch) {
+    const size_t start = this->PushRows(batch);
+    const size_t base = batch.offset[0];
+    const size_t ndata = batch.offset[batch.size] - base;
+    CHECK(ndata == 0 || batch.value != NULL) << "the values of the block are not bin ids";
+    BinType *out = BeginPtr(bin) + start;
+    for (size_t j = 0; j < ndata; ++j) {
+      out[j] = static_cast<BinType>(static_cast<float>(batch.value[base + j]));
+    }
+  }
+  /*!
+   * \brief push the rows of a block, except the bins, which are resized
+   * \return the position of the first entry of the block
+   */
+  template <typename DType>
+  inline size_t PushRows(const RowBlock<IndexType, DType> &batch) {
+    const size_t nrow = offset.size() - 1;
+    const size_t base = batch.offset[0];
+    const size_t ndata = batch.offset[batch.size] - base;
+    const size_t start = offset.back();
+    for (size_t i = 0; i < batch.size; ++i) {
+      offset.push_back(start + batch.offset[i + 1] - base);
+      label.push_back(static_cast<real_t>(batch.label[i]));
+    }
+    if (batch.weight != NULL) {
+      weight.resize(nrow, 1.0f);
+      weight.insert(weight.end(), batch.weight, batch.weight + batch.size);
+    } else if (weight.size() != 0) {
+      weight.resize(nrow + batch.size, 1.0f);
+    }
+    if (batch.qid != NULL) {
+      qid.resize(nrow, 0);
+      qid.insert(qid.end(), batch.qid, batch.qid + batch.size);
+    } else if (qid.size() != 0) {
+      qid.resize(nrow + batch.size, 0);
+    }
+    if (batch.field != NULL) {
+      field.resize(start, 0);
+      field.insert(field.end(), batch.field + base, batch.field + base + ndata);
+    } else if (field.size() != 0) {
+      field.resize(start + ndata, 0);
+    }
+    index.insert(index.end(), batch.index + base, batch.index + base + ndata);
+    bin.resize(start + ndata);
+    return start;
+  }
+  /*! \brief clear the container */
+  inline void Clear(void) {
+    offset.assign(1, 0);
+    label.clear();
+    weight.clear();
+    qid.clear();
+    field.clear();
+    index.clear();
+    bin.clear();
+  }
+  /*! \brief convert to a BinRowBlock */
+  inline BinRowBlock<IndexType, BinType> GetBlock(void) const {
+    BinRowBlock<IndexType, BinType> out;
+    out.rows.size = this->Size();
+    out.rows.offset = BeginPtr(offset);
+    out.rows.label = BeginPtr(label);
+    out.rows.weight = BeginPtr(weight);
+    out.rows.qid = BeginPtr(qid);
+    out.rows.field = BeginPtr(field);
+    out.rows.index = BeginPtr(index);
+    out.rows.value = NULL;
+    out.bin = BeginPtr(bin);
+    return out;
+  }
+};
+
+/*!
+ * \brief iterator that loads the blocks of a parser into memory as bin ids,
+ *  each block of the parser is quantized as soon as it is parsed,
+ *  so the float values of the dataset are never held at once.
+ *  A parser created with the uri argument bin_cuts=file, the BinQuantizer
+ *  saved to a file, already quantizes in its parsing thread; its blocks are
+ *  then only narrowed to BinType.
+ * \tparam IndexType type of the index
+ * \tparam BinType type of the bin id
+ */
+template <typename IndexType, typename BinType = uint8_t>
+class BinRowIter : public DataIter<BinRowBlock<IndexType, BinType>> {
+ public:
+  /*!
+   * \brief constructor, loads all the data
+   * \param parser the parser, deleted once the data is loaded
+   * \param quantizer the cut points of the features
+   * \param nthread number of threads of the quantization, the number of cores if not positive
+   */
+  BinRowIter(Parser<IndexType> *parser, const BinQuantizer &quantizer, int nthread = 0)
+      : ptr_(0) {
+    CHECK_LE(quantizer.MaxBin() - 1, static_cast<size_t>(std::numeric_limits<BinType>::max()))
+        << "number of bins exceed numeric bound of the bin type";
+    std::unique_ptr<Parser<IndexType>> owned(parser);
+    parser->BeforeFirst();
+    while (parser->Next()) {
+      const RowBlock<IndexType> &batch = parser->Value();
+      if (batch.size == 0) {
+        continue;
+      }
+      blocks_.push_back(BinRowBlockContainer<IndexType, BinType>());
+      blocks_.back().Push(batch, quantizer, nthread);
+    }
+  }
+  /*!
+   * \brief constructor, loads all the data of a parser quantizing in its parsing thread
+   * \param parser the parser, created with the uri argument bin_cuts, deleted once
+   *  the data is loaded
+   */
+  explicit BinRowIter(Parser<IndexType> *parser) : ptr_(0) {
+    std::unique_ptr<Parser<IndexType>> owned(parser);
+    parser->BeforeFirst();
+    while (parser->Next()) {
+      const RowBlock<IndexType> &batch = parser->Value();
+      if (batch.size == 0) {
+        continue;
+      }
+      blocks_.push_back(BinRowBlockContainer<IndexType, BinType>());
+      blocks_.back().PushBins(batch);
+    }
+  }
+  virtual void BeforeFirst(void) {
+    ptr_ = 0;
+  }
+  virtual bool Next(void) {
+    if (ptr_ >= blocks_.size()) {
+      return false;
+    }
+    block_ = blocks_[ptr_++].GetBlock();
+    return true;
+  }
+  virtual const BinRowBlock<IndexType, BinType> &Value(void) const {
+    return block_;
+  }
+
+ private:
+  /*! \brief the quantized blocks */
+  std::vector<BinRowBlockContainer<IndexType, BinType>> blocks_;
+  /*! \brief position of the next block */
+  size_t ptr_;
+  /*! \brief the current block */
+  BinRowBlock<IndexType, BinType> block_;
+};
+}  // namespace dmlc
+#endif  // DMLC_QUANTIZER_H_
@@ -0,0 +1,606 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file row_batch.h
+ * \brief re-batching of row blocks into minibatches of a fixed number of rows,
+ *  returned as views of the source blocks or written into caller owned arrays,
+ *  and into minibatches of rows of similar length
+ */
+#ifndef DMLC_ROW_BATCH_H_
+#define DMLC_ROW_BATCH_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "./data.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief caller owned CSR arrays receiving a minibatch, e.g. pinned
+ *  buffers of a training framework. The optional arrays can be NULL,
+ *  they are then not written.
+ * \tparam IndexType type of the index
+ * \tparam DType type of the label and value
+ */
+template <typename IndexType, typename DType = real_t>
+struct CSRBatchBuffer {
+  /*! \brief maximum number of rows */
+  size_t max_rows;
+  /*! \brief maximum number of entries */
+  size_t max_nnz;
+  /*! \brief array[max_rows+1], beginning of each row, starting at 0 */
+  size_t *offset;
+  /*! \brief optional array[max_rows], label of each row */
+  DType *label;
+  /*! \brief optional array[max_rows], weight of each row, 1 if not given */
+  real_t *weight;
+  /*! \brief optional array[max_rows], session id of each row, 0 if not given */
+  uint64_t *qid;
+  /*! \brief optional array[max_nnz], field of each entry, 0 if not given */
+  IndexType *field;
+  /*! \brief array[max_nnz], feature index of each entry */
+  IndexType *index;
+  /*! \brief optional array[max_nnz], value of each entry, 1 if not given */
+  DType *value;
+};
+
+/*!
+ * \brief copy rows of a block into CSR arrays
+ * \param src the source block
+ * \param begin the first row to copy
+ * \param end the end of the rows to copy
+ * \param dst the destination arrays, with enough room
+ * \param row the position of the first row in dst
+ * \param nnz the position of the first entry in dst, dst.offset[row] must be nnz
+ */
+template <typename IndexType, typename DType>
+inline void CopyRows(const RowBlock<IndexType, DType> &src, size_t begin, size_t end,
+    const CSRBatchBuffer<IndexType, DType> &dst, size_t row, size_t nnz) {
+  const size_t nrow = end - begin;
+  const size_t sbegin = src.offset[begin], send = src.offset[end];
+  for (size_t i = 0; i < nrow; ++i) {
+    dst.offset[row + i + 1] = nnz + src.offset[begin + i + 1] - sbegin;
+  }
+  if (dst.label != NULL) {
+    std::copy(src.label + begin, src.label + end, dst.label + row);
+  }
+  if (dst.weight != NULL) {
+    if (src.weight != NULL) {
+      std::copy(src.weight + begin, src.weight + end, dst.weight + row);
+    } else {
+      std::fill(dst.weight + row, dst.weight + row + nrow, 1.0f);
+    }
+  }
+  if (dst.qid != NULL) {
+    if (src.qid != NULL) {
+      std::copy(src.qid + begin, src.qid + end, dst.qid + row);
+    } else {
+      std::fill(dst.qid + row, dst.qid + row + nrow, 0);
+    }
+  }
+  if (dst.field != NULL) {
+    if (src.field != NULL) {
+      std::copy(src.field + sbegin, src.field + send, dst.field + nnz);
+    } else {
+      std::fill(dst.field + nnz, dst.field + nnz + (send - sbegin), 0);
+    }
+  }
+  std::copy(src.index + sbegin, src.index + send, dst.index + nnz);
+  if (dst.value != NULL) {
+    if (src.value != NULL) {
+      std::copy(src.value + sbegin, src.value + send, dst.value + nnz);
+    } else {
+      std::fill(dst.value + nnz, dst.value + nnz + (send - sbegin), DType(1));
+    }
+  }
+}
+
+/*!
+ * \brief gather rows of a block into CSR arrays
+ * \param src the source block
+ * \param rows array[nrow], the rows to copy, in the order of dst
+ * \param nrow number of rows to copy
+ * \param dst the destination arrays, with enough room
+ * \param row the position of the first row in dst
+ * \param nnz the position of the first entry in dst, dst.offset[row] must be nnz
+ */
+template <typename IndexType, typename DType>
+inline void GatherRows(const RowBlock<IndexType, DType> &src, const size_t *rows, size_t nrow,
+    const CSRBatchBuffer<IndexType, DType> &dst, size_t row, size_t nnz) {
+  for (size_t i = 0; i < nrow; ++i) {
+    dst.offset[row + i + 1] = dst.offset[row + i] + src.offset[rows[i] + 1] - src.offset[rows[i]];
+  }
+  const size_t ndata = dst.offset[row + nrow] - nnz;
+  if (dst.label != NULL) {
+    for (size_t i = 0; i < nrow; ++i) {
+      dst.label[row + i] = src.label[rows[i]];
+    }
+  }
+  if (dst.weight != NULL) {
+    for (size_t i = 0; i < nrow; ++i) {
+      dst.weight[row + i] = src.weight != NULL ? src.weight[rows[i]] : 1.0f;
+    }
+  }
+  if (dst.qid != NULL) {
+    for (size_t i = 0; i < nrow; ++i) {
+      dst.qid[row + i] = src.qid != NULL ? src.qid[rows[i]] : 0;
+    }
+  }
+  // the entries, one array after the other
+  if (dst.field != NULL) {
+    if (src.field != NULL) {
+      for (size_t i = 0; i < nrow; ++i) {
+        std::copy(src.field + src.offset[rows[i]], src.field + src.offset[rows[i] + 1],
+                  dst.field + dst.offset[row + i]);
+      }
+    } else {
+      std::fill(dst.field + nnz, dst.field + nnz + ndata, 0);
+    }
+  }
+  for (size_t i = 0; i < nrow; ++i) {
+    std::copy(src.index + src.offset[rows[i]], src.index + src.offset[rows[i] + 1],
+              dst.index + dst.offset[row + i]);
+  }
+  if (dst.value != NULL) {
+    if (src.value != NULL) {
+      for (size_t i = 0; i < nrow; ++i) {
+        std::copy(src.value + src.offset[rows[i]], src.value + src.offset[rows[i] + 1],
+                  dst.value + dst.offset[row + i]);
+      }
+    } else {
+      std::fill(dst.value + nnz, dst.value + nnz + ndata, DType(1));
+    }
+  }
+}
+
+namespace detail {
+/*!
+ * \brief growable storage of rows copied from several blocks
+ * \tparam IndexType type of the index
+ * \tparam DType type of the label and value
+ */
+template <typename IndexType, typename DType>
+struct RowBuffer {
+  /*! \brief array[Size()+1], beginning of each row */
+  std::vector<size_t> offset;
+  /*! \brief label of each row */
+  std::vector<DType> label;
+  /*! \brief weight of each row */
+  std::vector<real_t> weight;
+  /*! \brief session id of each row */
+  std::vector<uint64_t> qid;
+  /*! \brief field of each entry */
+  std::vector<IndexType> field;
+  /*! \brief feature index of each entry */
+  std::vector<IndexType> index;
+  /*! \brief value of each entry */
+  std::vector<DType> value;
+  /*! \brief whether one of the source blocks had the optional array */
+  bool has_weight, has_qid, has_field, has_value;
+  RowBuffer(void) {
+    this->Clear();
+  }
+  /*! \return number of rows */
+  inline size_t Size(void) const {
+    return offset.size() - 1;
+  }
+  /*! \brief remove all the rows, keeping the memory */
+  inline void Clear(void) {
+    offset.assign(1, 0);
+    label.clear();
+    weight.clear();
+    qid.clear();
+    field.clear();
+    index.clear();
+    value.clear();
+    has_weight = has_qid = has_field = has_value = false;
+  }
+  /*!
+   * \brief append rows of a block. The optional arrays stay empty until a
+   *  source block has them, the rows before it then get the default values.
+   * \param src the source block
+   * \param begin the first row to append
+   * \param end the end of the rows to append
+   */
+  inline void Append(const RowBlock<IndexType, DType> &src, size_t begin, size_t end) {
+    const size_t row = this->Size(), nnz = offset.back();
+    CopyRows(src, begin, end, this->Extend(src, end - begin, src.offset[end] - src.offset[begin]),
+             row, nnz);
+  }
+  /*!
+   * \brief append a list of rows of a block with one gather
+   * \param src the source block
+   * \param rows array[nrow], the rows to append
+   * \param nrow number of rows to append
+   */
+  inline void Gather(const RowBlock<IndexType, DType> &src, const size_t *rows, size_t nrow) {
+    const size_t row = this->Size(), nnz = offset.back();
+    size_t add_nnz = 0;
+    for (size_t i = 0; i < nrow; ++i) {
+      add_nnz += src.offset[rows[i] + 1] - src.offset[rows[i]];
+    }
+    GatherRows(src, rows, nrow, this->Extend(src, nrow, add_nnz), row, nnz);
+  }
+  /*! \return the rows as a block, the optional arrays no source block had are NULL */
+  inline RowBlock<IndexType, DType> GetBlock(void) const {
+    RowBlock<IndexType, DType> out;
+    out.size = this->Size();
+    out.offset = BeginPtr(offset);
+    out.label = BeginPtr(label);
+    out.weight = has_weight ? BeginPtr(weight) : NULL;
+    out.qid = has_qid ? BeginPtr(qid) : NULL;
+    out.field = has_field ? BeginPtr(field) : NULL;
+    out.index = BeginPtr(index);
+    out.value = has_value ? BeginPtr(value) : NULL;
+    return out;
+  }
+
+ private:
+  // make room for add_rows rows and add_nnz entries of src after the current rows,
+  // return the arrays to copy them into
+  inline CSRBatchBuffer<IndexType, DType> Extend(const RowBlock<IndexType, DType> &src,
+      size_t add_rows, size_t add_nnz) {
+    const size_t row = this->Size(), nnz = offset.back();
+    const size_t nrow = row + add_rows, ndata = nnz + add_nnz;
+    has_weight = has_weight || src.weight != NULL;
+    has_qid = has_qid || src.qid != NULL;
+    has_field = has_field || src.field != NULL;
+    has_value = has_value || src.value != NULL;
+    offset.resize(nrow + 1);
+    label.resize(nrow);
+    index.resize(ndata);
+    CSRBatchBuffer<IndexType, DType> buf;
+    buf.max_rows = nrow;
+    buf.max_nnz = ndata;
+    buf.offset = BeginPtr(offset);
+    buf.label = BeginPtr(label);
+    buf.weight = has_weight ? Grow(&weight, row, nrow, 1.0f) : NULL;
+    buf.qid = has_qid ? Grow(&qid, row, nrow, uint64_t(0)) : NULL;
+    buf.field = has_field ? Grow(&field, nnz, ndata, IndexType(0)) : NULL;
+    buf.index = BeginPtr(index);
+    buf.value = has_value ? Grow(&value, nnz, ndata, DType(1)) : NULL;
+    return buf;
+  }
+  // resize an optional array to size, the first old_size elements default to
+  // fill if the array was empty, the others are written by CopyRows or GatherRows
+  template <typename T>
+  inline static T *Grow(std::vector<T> *vec, size_t old_size, size_t size, T fill) {
+    vec->resize(old_size, fill);
+    vec->resize(size);
+    return BeginPtr(*vec);
+  }
+};
+}  // namespace detail
+
+/*!
+ * \brief iterator adapter returning minibatches of exactly batch_size rows,
+ *  except for the last one. A minibatch within one source block is a Slice
+ *  of the block without copy, a minibatch across blocks is stitched from them.
+ *  The minibatches are only valid until the next call to Next.
+ * \tparam IndexType type of the index
+ * \tparam DType type of the label and value
+ */
+template <typename IndexType, typename DType = real_t>
+class RowBatchIter : public RowBlockIter<IndexType, DType> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the source of the blocks, e.g. a Parser or a RowBlockIter, not owned
+   * \param batch_size number of rows of each minibatch
+   * \param drop_last whether to drop the last minibatch if it has less than batch_size rows
+   */
+  RowBatchIter(DataIter<RowBlock<IndexType, DType>> *base, size_t batch_size,
+      bool drop_last = false)
+      : base_(base),
+        base_iter_(dynamic_cast<RowBlockIter<IndexType, DType> *>(base)),
+        batch_size_(batch_size),
+        drop_last_(drop_last),
+        pos_(0),
+        end_(false),
+        max_index_(0) {
+    CHECK_NE(batch_size, 0U) << "batch_size must be positive";
+    block_.size = 0;
+  }
+  virtual void BeforeFirst(void) {
+    base_->BeforeFirst();
+    block_.size = 0;
+    pos_ = 0;
+    end_ = false;
+  }
+  virtual bool Next(void) {
+    if (!this->Fill()) {
+      return false;
+    }
+    if (block_.size - pos_ >= batch_size_) {
+      out_ = block_.Slice(pos_, pos_ + batch_size_);
+      pos_ += batch_size_;
+      this->UpdateMaxIndex(out_);
+      return true;
+    }
+    // stitch the rows of several blocks
+    buffer_.Clear();
+    while (buffer_.Size() < batch_size_ && this->Fill()) {
+      const size_t end = std::min(block_.size, pos_ + batch_size_ - buffer_.Size());
+      buffer_.Append(block_, pos_, end);
+      pos_ = end;
+    }
+    if (buffer_.Size() == 0 || (drop_last_ && buffer_.Size() < batch_size_)) {
+      return false;
+    }
+    out_ = buffer_.GetBlock();
+    this->UpdateMaxIndex(out_);
+    return true;
+  }
+  virtual const RowBlock<IndexType, DType> &Value(void) const {
+    return out_;
+  }
+  /*!
+   * \return number of columns of the base iterator if it is a RowBlockIter,
+   *  otherwise the maximum feature index seen so far plus one
+   */
+  virtual size_t NumCol(void) const {
+    return base_iter_ != NULL ? base_iter_->NumCol() : static_cast<size_t>(max_index_) + 1;
+  }
+  /*!
+   * \brief write the next minibatch into caller owned arrays instead of
+   *  returning it by Value. The minibatch has at most batch_size rows and
+   *  is cut earlier when the arrays are full.
+   * \param out the arrays, out.max_rows and out.max_nnz give their capacity
+   * \return number of rows written, 0 at the end of the data
+   */
+  inline size_t NextBatch(const CSRBatchBuffer<IndexType, DType> &out) {
+    const size_t max_rows = std::min(out.max_rows, batch_size_);
+    size_t nrow = 0;
+    out.offset[0] = 0;
+    while (nrow < max_rows && this->Fill()) {
+      // the rows of this block that fit in the arrays
+      const size_t nnz = out.offset[nrow];
+      size_t end = std::min(block_.size, pos_ + max_rows - nrow);
+      const size_t limit = block_.offset[pos_] + (out.max_nnz - nnz);
+      end = std::upper_bound(block_.offset + pos_, block_.offset + end + 1, limit)
+            - block_.offset - 1;
+      if (end == pos_) {
+        CHECK_NE(nrow, 0U) << "a row with " << block_.offset[pos_ + 1] - block_.offset[pos_]
+                           << " entries exceeds max_nnz of the batch buffer";
+        break;
+      }
+      CopyRows(block_, pos_, end, out, nrow, nnz);
+      nrow += end - pos_;
+      pos_ = end;
+    }
+    if (drop_last_ && nrow < max_rows && !this->Fill()) {
+      return 0;
+    }
+    return nrow;
+  }
+
+ private:
+  /*! \brief source of the blocks */
+  DataIter<RowBlock<IndexType, DType>> *base_;
+  /*! \brief base_ if it is a RowBlockIter, NULL otherwise */
+  RowBlockIter<IndexType, DType> *base_iter_;
+  /*! \brief number of rows of each minibatch */
+  size_t batch_size_;
+  /*! \brief whether to drop the last incomplete minibatch */
+  bool drop_last_;
+  /*! \brief current block of the base iterator */
+  RowBlock<IndexType, DType> block_;
+  /*! \brief next row of block_ */
+  size_t pos_;
+  /*! \brief whether the base iterator reached its end */
+  bool end_;
+  /*! \brief maximum feature index seen so far */
+  IndexType max_index_;
+  /*! \brief the minibatch to return */
+  RowBlock<IndexType, DType> out_;
+  /*! \brief storage of stitched minibatches */
+  detail::RowBuffer<IndexType, DType> buffer_;
+  // make sure block_ has rows left, return false at the end of the data
+  inline bool Fill(void) {
+    while (pos_ >= block_.size) {
+      if (end_ || !base_->Next()) {
+        end_ = true;
+        return false;
+      }
+      block_ = base_->Value();
+      pos_ = 0;
+    }
+    return true;
+  }
+  // track the maximum feature index for NumCol, unless the base gives it
+  inline void UpdateMaxIndex(const RowBlock<IndexType, DType> &batch) {
+    if (base_iter_ != NULL) {
+      return;
+    }
+    for (size_t j = batch.offset[0]; j < batch.offset[batch.size]; ++j) {
+      max_index_ = std::max(max_index_, batch.index[j]);
+    }
+  }
+};
+
+/*!
+ * \brief iterator adapter returning minibatches of rows of similar number of
+ *  entries, to limit the padding of dense or ELL minibatches. Rows are read
+ *  into a window of window_size rows, shuffled, and grouped by the bucket of
+ *  their length. Each bucket is cut into minibatches of batch_size rows,
+ *  the remaining rows of a bucket move to the next window, and the minibatches
+ *  of the window are returned in random order. Only the last window returns
+ *  incomplete minibatches, at most one per bucket.
+ * \tparam IndexType type of the index
+ * \tparam DType type of the label and value
+ */
+template <typename IndexType, typename DType = real_t>
+class BucketBatchIter : public RowBlockIter<IndexType, DType> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the source of the blocks, e.g. a Parser or a RowBlockIter, not owned
+   * \param batch_size number of rows of each minibatch
+   * \param bucket_bounds increasing upper bounds of the number of entries of each
+   *  bucket, rows longer than the last bound go to an extra bucket
+   * \param window_size number of rows shuffled and bucketed together,
+   *  at least batch_size times the number of buckets
+   * \param seed seed of the shuffle
+   */
+  BucketBatchIter(DataIter<RowBlock<IndexType, DType>> *base, size_t batch_size,
+      const std::vector<size_t> &bucket_bounds, size_t window_size, unsigned seed = 0)
+      : base_(base),
+        base_iter_(dynamic_cast<RowBlockIter<IndexType, DType> *>(base)),
+        batch_size_(batch_size),
+        bounds_(bucket_bounds),
+        window_size_(window_size),
+        rnd_(seed),
+        pos_(0),
+        end_(false),
+        batch_ptr_(0),
+        max_index_(0) {
+    CHECK_NE(batch_size, 0U) << "batch_size must be positive";
+    CHECK(std::is_sorted(bounds_.begin(), bounds_.end())) << "bucket_bounds must be sorted";
+    // a smaller window may hold no complete minibatch
+    CHECK_GE(window_size, batch_size * (bounds_.size() + 1))
+        << "window_size must be at least batch_size times the number of buckets";
+    block_.size = 0;
+  }
+  virtual void BeforeFirst(void) {
+    base_->BeforeFirst();
+    block_.size = 0;
+    pos_ = 0;
+    end_ = false;
+    window_.Clear();
+    carry_.clear();
+    batches_.clear();
+    batch_ptr_ = 0;
+  }
+  virtual bool Next(void) {
+    while (batch_ptr_ == batches_.size()) {
+      if (!this->LoadWindow()) {
+        return false;
+      }
+    }
+    const std::vector<size_t> &rows = batches_[batch_ptr_++];
+    out_.Clear();
+    out_.Gather(window_.GetBlock(), BeginPtr(rows), rows.size());
+    value_ = out_.GetBlock();
+    if (base_iter_ == NULL) {
+      for (IndexType findex : out_.index) {
+        max_index_ = std::max(max_index_, findex);
+      }
+    }
+    return true;
+  }
+  virtual const RowBlock<IndexType, DType> &Value(void) const {
+    return value_;
+  }
+  /*!
+   * \return number of columns of the base iterator if it is a RowBlockIter,
+   *  otherwise the maximum feature index seen so far plus one
+   */
+  virtual size_t NumCol(void) const {
+    return base_iter_ != NULL ? base_iter_->NumCol() : static_cast<size_t>(max_index_) + 1;
+  }
+  /*!
+   * \param length number of entries of a row
+   * \return the bucket of the row
+   */
+  inline size_t Bucket(size_t length) const {
+    return std::lower_bound(bounds_.begin(), bounds_.end(), length) - bounds_.begin();
+  }
+
+ private:
+  /*! \brief source of the blocks */
+  DataIter<RowBlock<IndexType, DType>> *base_;
+  /*! \brief base_ if it is a RowBlockIter, NULL otherwise */
+  RowBlockIter<IndexType, DType> *base_iter_;
+  /*! \brief number of rows of each minibatch */
+  size_t batch_size_;
+  /*! \brief upper bounds of the length of each bucket */
+  std::vector<size_t> bounds_;
+  /*! \brief number of rows of a window */
+  size_t window_size_;
+  /*! \brief random engine of the shuffle */
+  std::mt19937 rnd_;
+  /*! \brief current block of the base iterator */
+  RowBlock<IndexType, DType> block_;
+  /*! \brief next row of block_ */
+  size_t pos_;
+  /*! \brief whether the base iterator reached its end */
+  bool end_;
+  /*! \brief rows of the current window */
+  detail::RowBuffer<IndexType, DType> window_;
+  /*! \brief rows of window_ carried over to the next window */
+  std::vector<size_t> carry_;
+  /*! \brief storage of the next window */
+  detail::RowBuffer<IndexType, DType> next_;
+  /*! \brief minibatches of the current window, as rows of window_ */
+  std::vector<std::vector<size_t>> batches_;
+  /*! \brief next minibatch in batches_ */
+  size_t batch_ptr_;
+  /*! \brief storage of the minibatch to return */
+  detail::RowBuffer<IndexType, DType> out_;
+  /*! \brief the minibatch to return */
+  RowBlock<IndexType, DType> value_;
+  /*! \brief maximum feature index seen so far */
+  IndexType max_index_;
+  // read the next window and plan its minibatches, return false at the end of the data
+  inline bool LoadWindow(void) {
+    // the next window starts with the carried rows, gathered at once
+    next_.Clear();
+    next_.Gather(window_.GetBlock(), BeginPtr(carry_), carry_.size());
+    std::swap(window_, next_);
+    carry_.clear();
+    while (window_.Size() < window_size_ && !end_) {
+      if (pos_ >= block_.size) {
+        if (!base_->Next()) {
+          end_ = true;
+          break;
+        }
+        block_ = base_->Value();
+        pos_ = 0;
+        continue;
+      }
+      const size_t end = std::min(block_.size, pos_ + window_size_ - window_.Size());
+      window_.Append(block_, pos_, end);
+      pos_ = end;
+    }
+    batches_.clear();
+    batch_ptr_ = 0;
+    const size_t nrow = window_.Size();
+    if (nrow == 0) {
+      return false;
+    }
+    // shuffle, then group by bucket keeping the shuffled order
+    std::vector<std::pair<size_t, size_t>> order(nrow);
+    for (size_t i = 0; i < nrow; ++i) {
+      order[i] = std::make_pair(this->Bucket(window_.offset[i + 1] - window_.offset[i]), i);
+    }
+    std::shuffle(order.begin(), order.end(), rnd_);
+    std::stable_sort(order.begin(), order.end(),
+        [](const std::pair<size_t, size_t> &a, const std::pair<size_t, size_t> &b) {
+          return a.first < b.first;
+        });
+    for (size_t i = 0; i < nrow;) {
+      size_t j = i;
+      while (j < nrow && order[j].first == order[i].first && j - i < batch_size_) {
+        ++j;
+      }
+      if (j - i == batch_size_ || end_) {
+        batches_.push_back(std::vector<size_t>());
+        for (size_t k = i; k < j; ++k) {
+          batches_.back().push_back(order[k].second);
+        }
+      } else {
+        for (size_t k = i; k < j; ++k) {
+          carry_.push_back(order[k].second);
+        }
+      }
+      i = j;
+    }
+    std::shuffle(batches_.begin(), batches_.end(), rnd_);
+    return true;
+  }
+};
+}  // namespace dmlc
+#endif  // DMLC_ROW_BATCH_H_
@@ -0,0 +1,225 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file sparse_ops.h
+ * \brief batched sparse kernels over RowBlock,
+ *  and materialization of row blocks into dense matrices
+ */
+#ifndef DMLC_SPARSE_OPS_H_
+#define DMLC_SPARSE_OPS_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "./common.h"
+#include "./data.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief check that every feature index of the block is smaller than size
+ * \param batch the row block
+ * \param size the bound
+ * \param nthread number of threads, the number of cores if not positive
+ */
+template <typename IndexType, typename DType>
+inline void CheckIndexBound(const RowBlock<IndexType, DType> &batch, size_t size, int nthread = 0) {
+  nthread = ParallelNumThreads(batch.size, nthread);
+  std::vector<size_t> thread_ncol(nthread, 0);
+  ParallelFor(batch.size, nthread, [&](int tid, size_t begin, size_t end) {
+    IndexType max_index = 0;
+    for (size_t j = batch.offset[begin]; j < batch.offset[end]; ++j) {
+      max_index = std::max(max_index, batch.index[j]);
+    }
+    thread_ncol[tid] = batch.offset[begin] == batch.offset[end] ? 0 : max_index + size_t(1);
+  });
+  CHECK_LE(*std::max_element(thread_ncol.begin(), thread_ncol.end()), size)
+      << "feature index exceed bound";
+}
+
+/*!
+ * \brief sparse matrix-vector product, out[i] = dot(batch[i], weight)
+ * \param batch the row block
+ * \param weight the dense vector
+ * \param size size of the dense vector
+ * \param out array[batch.size] receiving the products
+ * \param nthread number of threads, the number of cores if not positive
+ * \tparam V type of the dense vector
+ * \tparam AccType type of the output and accumulator, e.g. double for float weights
+ */
+template <typename IndexType, typename DType, typename V, typename AccType>
+inline void SpMV(const RowBlock<IndexType, DType> &batch, const V *weight, size_t size,
+    AccType *out, int nthread = 0) {
+  ParallelFor(batch.size, nthread, [&](int, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      // Row::SDot checks the bound of the row before the branch free kernel
+      out[i] = batch[i].template SDot<V, AccType>(weight, size);
+    }
+  });
+}
+
+/*!
+ * \brief transposed product accumulated into a dense vector,
+ *  out[index] += coef[i] * value for every entry of every row i,
+ *  i.e. out += transpose(batch) * coef, used to scatter gradients.
+ *  With several threads, each thread but the first accumulates into a
+ *  private copy of out, the copies are summed at the end,
+ *  so memory grows with size * nthread. By default a thread is only added
+ *  for every size entries of the block, so the copies never outweigh the
+ *  block and a small block is scattered by the calling thread alone.
+ * \param batch the row block
+ * \param coef array[batch.size], coefficient of each row
+ * \param size size of the dense vector
+ * \param out array[size], the dense vector to accumulate into
+ * \param nthread number of threads, bounded by the number of cores and
+ *  the number of entries divided by size if not positive
+ * \tparam V type of the coefficients
+ * \tparam AccType type of the dense vector
+ */
+template <typename IndexType, typename DType, typename V, typename AccType>
+inline void ScatterAdd(const RowBlock<IndexType, DType> &batch, const V *coef, size_t size,
+    AccType *out, int nthread = 0) {
+  if (nthread <= 0) {
+    // one thread, and its private copy of out, for every size entries
+    const size_t nnz = batch.offset[batch.size] - batch.offset[0];
+    nthread = static_cast<int>(std::min(static_cast<size_t>(ParallelNumThreads(batch.size, 0)),
+                                        1 + nnz / std::max(size, size_t(1))));
+  }
+  CheckIndexBound(batch, size, nthread);
+  nthread = ParallelNumThreads(batch.size, nthread);
+  std::vector<std::vector<AccType>> buffer(nthread - 1);
+  ParallelFor(batch.size, nthread, [&](int tid, size_t begin, size_t end) {
+    AccType *dst = out;
+    if (tid != 0) {
+      buffer[tid - 1].resize(size, AccType(0));
+      dst = BeginPtr(buffer[tid - 1]);
+    }
+    for (size_t i = begin; i < end; ++i) {
+      const AccType c = static_cast<AccType>(coef[i]);
+      if (batch.value == NULL) {
+        for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+          dst[batch.index[j]] += c;
+        }
+      } else {
+        for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+          dst[batch.index[j]] += c * static_cast<AccType>(batch.value[j]);
+        }
+      }
+    }
+  });
+  if (buffer.size() != 0) {
+    ParallelFor(size, nthread, [&](int, size_t begin, size_t end) {
+      for (const std::vector<AccType> &buf : buffer) {
+        for (size_t k = begin; k < end; ++k) {
+          out[k] += buf[k];
+        }
+      }
+    });
+  }
+}
+
+/*! \brief memory layout of a dense matrix */
+enum DenseLayout {
+  /*! \brief element (i, j) at out[i * num_col + j] */
+  kRowMajor,
+  /*! \brief element (i, j) at out[j * num_row + i] */
+  kColMajor
+};
+
+/*!
+ * \brief write the rows of a block into a caller provided dense matrix.
+ *  The matrix is first filled with the missing value, then the entries
+ *  of the block are scattered, both in parallel over row ranges.
+ * \param batch the row block, e.g. a Slice of a larger block
+ * \param num_col number of columns of the dense matrix
+ * \param out array[batch.size * num_col], the dense matrix
+ * \param layout memory layout of the dense matrix
+ * \param missing value of the elements without entry
+ * \param columns optional array[num_col], column j of the matrix receives
+ *  feature columns[j], entries of other features are skipped.
+ *  If NULL, column j receives feature j and every feature index must be
+ *  smaller than num_col.
+ * \param nthread number of threads, the number of cores if not positive
+ * \tparam OType type of the dense matrix
+ */
+template <typename IndexType, typename DType, typename OType>
+inline void ToDense(const RowBlock<IndexType, DType> &batch, size_t num_col, OType *out,
+    DenseLayout layout = kRowMajor,
+    // non-deduced, so literals and NULL are accepted for these arguments
+    typename std::common_type<OType>::type missing = OType(0),
+    const typename std::common_type<IndexType>::type *columns = NULL,
+    int nthread = 0) {
+  const size_t num_row = batch.size;
+  // (feature index, output column) sorted by feature index, searched per entry,
+  // so its size does not depend on the largest feature index
+  std::vector<std::pair<IndexType, size_t>> colmap;
+  if (columns != NULL) {
+    colmap.reserve(num_col);
+    for (size_t j = 0; j < num_col; ++j) {
+      colmap.push_back(std::make_pair(columns[j], j));
+    }
+    std::sort(colmap.begin(), colmap.end());
+    // a feature listed twice goes to the last of its columns
+    size_t top = 0;
+    for (size_t j = 0; j < colmap.size(); ++j) {
+      if (top != 0 && colmap[top - 1].first == colmap[j].first) {
+        --top;
+      }
+      colmap[top++] = colmap[j];
+    }
+    colmap.resize(top);
+  } else {
+    CheckIndexBound(batch, num_col, nthread);
+  }
+  const size_t stride_row = layout == kRowMajor ? num_col : 1;
+  const size_t stride_col = layout == kRowMajor ? 1 : num_row;
+  ParallelFor(num_row, nthread, [&](int, size_t begin, size_t end) {
+    if (layout == kRowMajor) {
+      std::fill(out + begin * num_col, out + end * num_col, missing);
+    } else {
+      for (size_t j = 0; j < num_col; ++j) {
+        std::fill(out + j * num_row + begin, out + j * num_row + end, missing);
+      }
+    }
+    for (size_t i = begin; i < end; ++i) {
+      OType *orow = out + i * stride_row;
+      const size_t rend = batch.offset[i + 1];
+      for (size_t k = batch.offset[i]; k < rend;) {
+        size_t j = static_cast<size_t>(batch.index[k]);
+        if (columns != NULL) {
+          typename std::vector<std::pair<IndexType, size_t>>::const_iterator it
+              = std::lower_bound(colmap.begin(), colmap.end(),
+                                 std::make_pair(batch.index[k], size_t(0)));
+          if (it != colmap.end() && it->first == batch.index[k]) {
+            orow[it->second * stride_col]
+                = batch.value == NULL ? OType(1) : static_cast<OType>(batch.value[k]);
+          }
+          ++k;
+          continue;
+        }
+        // run of consecutive features, written to consecutive elements in row
+        // major layout, as a unit stride copy the compiler can vectorize
+        size_t run = 1;
+        if (stride_col == 1) {
+          while (k + run < rend && batch.index[k + run] == batch.index[k] + run) {
+            ++run;
+          }
+        }
+        OType *dst = orow + j * stride_col;
+        if (batch.value == NULL) {
+          std::fill(dst, dst + run, OType(1));
+        } else {
+          const DType *src = batch.value + k;
+          for (size_t t = 0; t < run; ++t) {
+            dst[t] = static_cast<OType>(src[t]);
+          }
+        }
+        k += run;
+      }
+    }
+  });
+}
+}  // namespace dmlc
+#endif  // DMLC_SPARSE_OPS_H_
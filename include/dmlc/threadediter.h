@@ -13,12 +13,14 @@
 // this code depends on c++11
 #if DMLC_ENABLE_STD_THREAD
   #include <atomic>
+  #include <chrono>
   #include <condition_variable>
   #include <functional>
   #include <memory>
   #include <mutex>
   #include <queue>
   #include <thread>
+  #include <unordered_map>
   #include <utility>
 
   #include "./data.h"
@@ -132,8 +134,34 @@ class ThreadedIter : public DataIter<DType> {
    * \param max_capacity maximum capacity of the queue
    */
   inline void set_max_capacity(size_t max_capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
     max_capacity_ = max_capacity;
   }
+  /*!
+   * \brief make the capacity of the queue adaptive under a byte budget.
+   *  The capacity grows by one each time the consumer waits for the producer,
+   *  while the cells of that capacity fit in the budget, and shrinks by one each
+   *  time the cells exceed the budget, the surplus free cells are then deleted.
+   *  The free cells are deleted by the producer thread right after a call to next,
+   *  so next must not keep pointers into the cells it filled before.
+   *  The capacity set by set_max_capacity is the initial one.
+   *  Must be called before Init.
+   * \param max_bytes the budget of all the cells, 0 for a fixed capacity
+   * \param bytes_of function returning the bytes held by a cell
+   */
+  inline void set_max_bytes(size_t max_bytes, std::function<size_t(const DType &)> bytes_of) {
+    max_bytes_ = max_bytes;
+    bytes_of_ = bytes_of;
+  }
+  /*! \return the statistics of the queue, this function is threadsafe */
+  inline PrefetchStats GetStats(void) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PrefetchStats ret = stats_;
+    ret.depth = max_capacity_;
+    ret.queue_size = queue_.size();
+    ret.bytes = total_bytes_;
+    return ret;
+  }
   /*!
    * \brief initialize the producer and start the thread can only be
    *   called once
@@ -275,6 +303,29 @@ class ThreadedIter : public DataIter<DType> {
   std::queue<DType *> free_cells_;
   /*! \brief holds a reference to iterator exception thrown in spawned threads */
   std::exception_ptr iter_exception_{nullptr};
+  /*! \brief byte budget of the cells, 0 for a fixed capacity */
+  size_t max_bytes_{0};
+  /*! \brief bytes held by a cell */
+  std::function<size_t(const DType &)> bytes_of_;
+  /*! \brief bytes held by each cell, measured when it is produced */
+  std::unordered_map<const DType *, size_t> cell_bytes_;
+  /*! \brief bytes held by all the cells */
+  size_t total_bytes_{0};
+  /*! \brief statistics of the queue */
+  PrefetchStats stats_;
+  /*! \brief seconds elapsed since start */
+  inline static double SecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  /*! \brief delete a cell, called with the lock held */
+  inline void DeleteCell(DType *cell) {
+    auto it = cell_bytes_.find(cell);
+    if (it != cell_bytes_.end()) {
+      total_bytes_ -= it->second;
+      cell_bytes_.erase(it);
+    }
+    delete cell;
+  }
 };
 
 // implementation of functions
@@ -309,6 +360,8 @@ inline void ThreadedIter<DType>::Destroy(void) {
     delete out_data_;
     out_data_ = NULL;
   }
+  cell_bytes_.clear();
+  total_bytes_ = 0;
 }
 
 template <typename DType>
@@ -336,6 +389,9 @@ inline void ThreadedIter<DType>::Init(
           // lockscope
           std::unique_lock<std::mutex> lock(mutex_);
           ++this->nwait_producer_;
+          // waiting at the end of the data is not counted
+          const bool idle = produce_end_.load(std::memory_order_acquire);
+          const auto start = std::chrono::steady_clock::now();
           producer_cond_.wait(lock, [this]() {
             if (producer_sig_.load(std::memory_order_acquire) == kProduce) {
               bool ret = !produce_end_.load(std::memory_order_acquire)
@@ -345,6 +401,9 @@ inline void ThreadedIter<DType>::Init(
               return true;
             }
           });
+          if (!idle) {
+            stats_.producer_wait_sec += SecondsSince(start);
+          }
           --this->nwait_producer_;
           if (producer_sig_.load(std::memory_order_acquire) == kProduce) {
             if (free_cells_.size() != 0) {
@@ -380,12 +439,29 @@ inline void ThreadedIter<DType>::Init(
         // now without lock
         produce_end_.store(!next(&cell), std::memory_order_release);
         DCHECK(cell != NULL || produce_end_.load(std::memory_order_acquire));
+        const size_t nbytes = max_bytes_ != 0 && cell != NULL ? bytes_of_(*cell) : 0;
         bool notify;
         {
           // lockscope
           std::lock_guard<std::mutex> lock(mutex_);
+          if (max_bytes_ != 0 && cell != NULL) {
+            size_t &cell_bytes = cell_bytes_[cell];
+            total_bytes_ += nbytes - cell_bytes;
+            cell_bytes = nbytes;
+            // shrink under memory pressure
+            if (total_bytes_ > max_bytes_) {
+              if (max_capacity_ > 1) {
+                --max_capacity_;
+              }
+              while (free_cells_.size() != 0 && total_bytes_ > max_bytes_) {
+                this->DeleteCell(free_cells_.front());
+                free_cells_.pop();
+              }
+            }
+          }
           if (!produce_end_.load(std::memory_order_acquire)) {
             queue_.push(cell);
+            ++stats_.num_produced;
           } else {
             if (cell != NULL) {
               free_cells_.push(cell);
@@ -443,9 +519,22 @@ inline bool ThreadedIter<DType>::Next(DType **out_dptr) {
   std::unique_lock<std::mutex> lock(mutex_);
   CHECK(producer_sig_.load(std::memory_order_acquire) == kProduce)
       << "Make sure you call BeforeFirst not inconcurrent with Next!";
+  const bool stall = queue_.size() == 0 && !produce_end_.load(std::memory_order_acquire);
+  if (stall) {
+    // the consumer waits for the producer, let the producer run further ahead
+    ++stats_.num_consumer_wait;
+    if (max_bytes_ != 0 && cell_bytes_.size() != 0
+        && (max_capacity_ + 1) * (total_bytes_ / cell_bytes_.size()) <= max_bytes_) {
+      ++max_capacity_;
+    }
+  }
   ++nwait_consumer_;
+  const auto start = std::chrono::steady_clock::now();
   consumer_cond_.wait(lock,
       [this]() { return queue_.size() != 0 || produce_end_.load(std::memory_order_acquire); });
+  if (stall) {
+    stats_.consumer_wait_sec += SecondsSince(start);
+  }
   --nwait_consumer_;
   if (queue_.size() != 0) {
     *out_dptr = queue_.front();
@@ -473,6 +562,7 @@ inline void ThreadedIter<DType>::Recycle(DType **inout_dptr) {
   ThrowExceptionIfSet();
   {
     std::lock_guard<std::mutex> lock(mutex_);
+    // the surplus cells are only deleted by the producer, after its next call
     free_cells_.push(*inout_dptr);
     *inout_dptr = NULL;
     notify = nwait_producer_ != 0 && !produce_end_.load(std::memory_order_acquire);
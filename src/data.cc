@@ -1,19 +1,31 @@
 // Copyright by Contributors
 #include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <dmlc/base.h>
 #include <dmlc/data.h>
+#include <dmlc/feature_map.h>
+#include <dmlc/half.h>
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
 #include <dmlc/registry.h>
 
 #include "data/basic_row_iter.h"
+#include "data/convert_parser.h"
 #include "data/csv_parser.h"
 #include "data/disk_row_iter.h"
 #include "data/libfm_parser.h"
 #include "data/libsvm_parser.h"
 #include "data/parser.h"
+#include "data/quantize_parser.h"
+#include "data/remap_parser.h"
+#include "io/cache_header.h"
+#include "io/input_split_base.h"
 #include "io/uri_spec.h"
 
 #ifdef DMLC_USE_PARQUET
@@ -24,13 +36,54 @@ namespace dmlc {
 /*! \brief namespace for useful input data structure */
 namespace data {
 
+#if DMLC_ENABLE_STD_THREAD
+/*!
+ * \brief initialize the parameters of ThreadedParser from the uri arguments
+ * \return the remaining arguments, to be passed to the underlying parser
+ */
+inline std::map<std::string, std::string> InitThreadedParserParam(
+    ThreadedParserParam *param, const std::map<std::string, std::string> &args) {
+  std::vector<std::pair<std::string, std::string>> rest = param->InitAllowUnknown(args);
+  return std::map<std::string, std::string>(rest.begin(), rest.end());
+}
+
+/*!
+ * \brief wrap the parser with ThreadedParser, each part spills into its own file
+ */
+template <typename IndexType, typename DType = real_t>
+inline ParserImpl<IndexType, DType> *CreateThreadedParser_(ParserImpl<IndexType, DType> *base,
+    const ThreadedParserParam &param, unsigned part_index, unsigned num_parts) {
+  if (param.bin_cuts.length() != 0) {
+    CHECK(!param.feature_stats) << "feature_stats can not be collected on the bin ids";
+    std::unique_ptr<Stream> fi(Stream::Create(param.bin_cuts.c_str(), "r"));
+    BinQuantizer quantizer;
+    CHECK(quantizer.Load(fi.get())) << "invalid bin cuts " << param.bin_cuts;
+    base = new QuantizeParser<IndexType, DType>(base, quantizer);
+  }
+  std::string spill = param.epoch_cache_spill;
+  if (spill.length() != 0 && num_parts != 1) {
+    std::ostringstream os;
+    os << spill << ".split" << num_parts << ".part" << part_index;
+    spill = os.str();
+  }
+  return new ThreadedParser<IndexType, DType>(base,
+      static_cast<size_t>(param.epoch_cache_mb) << 20UL, spill, param.feature_stats,
+      static_cast<size_t>(param.stats_sketch_size),
+      static_cast<size_t>(param.prefetch_mb) << 20UL);
+}
+#endif  // DMLC_ENABLE_STD_THREAD
+
 template <typename IndexType, typename DType = real_t>
 Parser<IndexType> *CreateLibSVMParser(const std::string &path,
     const std::map<std::string, std::string> &args, unsigned part_index, unsigned num_parts) {
   InputSplit *source = InputSplit::Create(path.c_str(), part_index, num_parts, "text");
-  ParserImpl<IndexType> *parser = new LibSVMParser<IndexType>(source, args, 2);
 #if DMLC_ENABLE_STD_THREAD
-  parser = new ThreadedParser<IndexType>(parser);
+  ThreadedParserParam param;
+  std::map<std::string, std::string> rest = InitThreadedParserParam(&param, args);
+  ParserImpl<IndexType> *parser = new LibSVMParser<IndexType>(source, rest, 2);
+  parser = CreateThreadedParser_(parser, param, part_index, num_parts);
+#else
+  ParserImpl<IndexType> *parser = new LibSVMParser<IndexType>(source, args, 2);
 #endif
   return parser;
 }
@@ -39,13 +92,93 @@ template <typename IndexType, typename DType = real_t>
 Parser<IndexType> *CreateLibFMParser(const std::string &path,
     const std::map<std::string, std::string> &args, unsigned part_index, unsigned num_parts) {
   InputSplit *source = InputSplit::Create(path.c_str(), part_index, num_parts, "text");
+#if DMLC_ENABLE_STD_THREAD
+  ThreadedParserParam param;
+  std::map<std::string, std::string> rest = InitThreadedParserParam(&param, args);
+  ParserImpl<IndexType> *parser = new LibFMParser<IndexType>(source, rest, 2);
+  parser = CreateThreadedParser_(parser, param, part_index, num_parts);
+#else
   ParserImpl<IndexType> *parser = new LibFMParser<IndexType>(source, args, 2);
+#endif
+  return parser;
+}
+
+/*!
+ * \brief create a text parser whose real_t values are converted to DType,
+ *  the conversion runs in the parsing thread
+ * \tparam TextParser the text parser producing real_t values
+ */
+template <typename IndexType, typename DType, typename TextParser>
+Parser<IndexType, DType> *CreateConvertParser(const std::string &path,
+    const std::map<std::string, std::string> &args, unsigned part_index, unsigned num_parts) {
+  InputSplit *source = InputSplit::Create(path.c_str(), part_index, num_parts, "text");
 #if DMLC_ENABLE_STD_THREAD
-  parser = new ThreadedParser<IndexType>(parser);
+  ThreadedParserParam param;
+  std::map<std::string, std::string> rest = InitThreadedParserParam(&param, args);
+  ParserImpl<IndexType, DType> *parser
+      = new ConvertParser<IndexType, DType>(new TextParser(source, rest, 2));
+  parser = CreateThreadedParser_(parser, param, part_index, num_parts);
+#else
+  ParserImpl<IndexType, DType> *parser
+      = new ConvertParser<IndexType, DType>(new TextParser(source, args, 2));
 #endif
   return parser;
 }
 
+#if DMLC_ENABLE_STD_THREAD
+/*!
+ * \brief create a text parser producing 64-bit feature ids,
+ *  mapped to dense 32-bit ids in the parsing thread
+ * \tparam TextParser the text parser producing uint64_t ids
+ */
+template <typename DType, typename TextParser>
+Parser<uint32_t, DType> *CreateRemapParser(const std::string &path,
+    const std::map<std::string, std::string> &args, unsigned part_index, unsigned num_parts) {
+  RemapParserParam remap;
+  std::vector<std::pair<std::string, std::string>> rest_remap = remap.InitAllowUnknown(args);
+  ThreadedParserParam param;
+  std::map<std::string, std::string> rest = InitThreadedParserParam(
+      &param, std::map<std::string, std::string>(rest_remap.begin(), rest_remap.end()));
+  // the format names this factory, not the one of the text parser
+  rest.erase("format");
+  InputSplit *source = InputSplit::Create(path.c_str(), part_index, num_parts, "text");
+  ParserImpl<uint64_t, DType> *base = new TextParser(source, rest, 2);
+  std::shared_ptr<FeatureIdMap> map = std::make_shared<FeatureIdMap>();
+  std::string dict_out;
+  std::unique_ptr<SeekStream> fdict(remap.feature_dict.length() == 0
+      ? NULL : SeekStream::CreateForRead(remap.feature_dict.c_str(), true));
+  if (fdict != nullptr) {
+    CHECK(map->Load(fdict.get())) << "invalid feature dictionary " << remap.feature_dict;
+  } else if (remap.feature_whitelist.length() != 0) {
+    CHECK_EQ(remap.feature_min_count, 0)
+        << "feature_whitelist and feature_min_count cannot be used together";
+    std::unique_ptr<Stream> fi(Stream::Create(remap.feature_whitelist.c_str(), "r"));
+    dmlc::istream is(fi.get());
+    uint64_t id;
+    while (is >> id) {
+      map->Insert(id);
+    }
+    map->Freeze();
+  } else {
+    // each part would number the features differently
+    CHECK_EQ(num_parts, 1U)
+        << "the feature dictionary can only be learned from the whole data, "
+        << "learn it with a single part or give an existing feature_dict";
+    if (remap.feature_min_count > 1) {
+      RemapParser<DType>::CountFeatures(base, remap.feature_min_count, map.get());
+      if (remap.feature_dict.length() != 0) {
+        std::unique_ptr<Stream> fo(Stream::Create(remap.feature_dict.c_str(), "w"));
+        map->Save(fo.get());
+      }
+    } else {
+      dict_out = remap.feature_dict;
+    }
+  }
+  ParserImpl<uint32_t, DType> *parser = new RemapParser<DType>(base, map, dict_out);
+  return CreateThreadedParser_(parser, param, part_index, num_parts);
+}
+#endif  // DMLC_ENABLE_STD_THREAD
+
 template <typename IndexType, typename DType = real_t>
 Parser<IndexType, DType> *CreateCSVParser(const std::string &path,
     const std::map<std::string, std::string> &args, unsigned part_index, unsigned num_parts) {
@@ -81,8 +214,42 @@ inline Parser<IndexType, DType> *CreateParser_(
   if (e == NULL) {
     LOG(FATAL) << "Unknown data type " << ptype;
   }
+  // the sugars of the input split are handled by InputSplit::Create, not by the parsers
+  std::string uri = spec.uri;
+  std::map<std::string, std::string> args = spec.args;
+  char sep = '?';
+  for (const char *key :
+       {"mmap", "readers", "aio", "direct", "line_index", "whole_files", "manifest", "shuffle_mb",
+           "shuffle_seed"}) {
+    if (args.count(key) != 0) {
+      uri += sep + std::string(key) + "=" + args.at(key);
+      sep = '&';
+      args.erase(key);
+    }
+  }
   // create parser
-  return (*e->body)(spec.uri, spec.args, part_index, num_parts);
+  return (*e->body)(uri, args, part_index, num_parts);
+}
+
+/*!
+ * \brief create the header of a row block cache, the cache is bound to
+ *  the source files, the parser arguments and the data types
+ */
+template <typename IndexType, typename DType = real_t>
+inline io::CacheHeader CreateCacheHeader_(const io::URISpec &spec, const char *type) {
+  io::CacheHeader header;
+  if (spec.uri != "stdin") {
+    io::URI path(spec.uri.c_str());
+    // the files are listed, the manifest could hold a stale listing
+    header.Add(io::InputSplitBase::ListInputFiles(
+        io::FileSystem::GetInstance(path), spec.uri, false, ""));
+  }
+  header.Add(spec.args);
+  header.Add(std::string(type));
+  header.Add(static_cast<uint64_t>(sizeof(IndexType)));
+  header.Add(static_cast<uint64_t>(sizeof(DType)));
+  header.Add(type_name<DType>());
+  return header;
 }
 
 template <typename IndexType, typename DType = real_t>
@@ -94,19 +261,30 @@ inline RowBlockIter<IndexType, DType> *CreateIter_(
       = CreateParser_<IndexType, DType>(spec.uri.c_str(), part_index, num_parts, type);
   if (spec.cache_file.length() != 0) {
 #if DMLC_ENABLE_STD_THREAD
-    return new DiskRowIter<IndexType, DType>(parser, spec.cache_file.c_str(), true);
+    DiskRowIterParam param;
+    param.InitAllowUnknown(spec.args);
+    return new DiskRowIter<IndexType, DType>(parser, spec.cache_file.c_str(), true,
+        CreateCacheHeader_<IndexType, DType>(spec, type), param.page_format == 1);
 #else
     LOG(FATAL) << "compile with c++0x or c++11 to enable cache file";
     return NULL;
 #endif
   } else {
-    return new BasicRowIter<IndexType, DType>(parser);
+    BasicRowIterParam param;
+    param.InitAllowUnknown(spec.args);
+    return new BasicRowIter<IndexType, DType>(parser, param.compact);
   }
 }
 
 DMLC_REGISTER_PARAMETER(LibSVMParserParam);
 DMLC_REGISTER_PARAMETER(LibFMParserParam);
 DMLC_REGISTER_PARAMETER(CSVParserParam);
+DMLC_REGISTER_PARAMETER(BasicRowIterParam);
+#if DMLC_ENABLE_STD_THREAD
+DMLC_REGISTER_PARAMETER(ThreadedParserParam);
+DMLC_REGISTER_PARAMETER(DiskRowIterParam);
+DMLC_REGISTER_PARAMETER(RemapParserParam);
+#endif
 #ifdef DMLC_USE_PARQUET
 DMLC_REGISTER_PARAMETER(ParquetParserParam);
 #endif
@@ -149,6 +327,30 @@ RowBlockIter<uint64_t, int64_t> *RowBlockIter<uint64_t, int64_t>::Create(
   return data::CreateIter_<uint64_t, int64_t>(uri, part_index, num_parts, type);
 }
 
+template <>
+RowBlockIter<uint32_t, half_t> *RowBlockIter<uint32_t, half_t>::Create(
+    const char *uri, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateIter_<uint32_t, half_t>(uri, part_index, num_parts, type);
+}
+
+template <>
+RowBlockIter<uint64_t, half_t> *RowBlockIter<uint64_t, half_t>::Create(
+    const char *uri, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateIter_<uint64_t, half_t>(uri, part_index, num_parts, type);
+}
+
+template <>
+RowBlockIter<uint32_t, bfloat16_t> *RowBlockIter<uint32_t, bfloat16_t>::Create(
+    const char *uri, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateIter_<uint32_t, bfloat16_t>(uri, part_index, num_parts, type);
+}
+
+template <>
+RowBlockIter<uint64_t, bfloat16_t> *RowBlockIter<uint64_t, bfloat16_t>::Create(
+    const char *uri, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateIter_<uint64_t, bfloat16_t>(uri, part_index, num_parts, type);
+}
+
 template <>
 Parser<uint32_t, real_t> *Parser<uint32_t, real_t>::Create(
     const char *uri_, unsigned part_index, unsigned num_parts, const char *type) {
@@ -185,6 +387,30 @@ Parser<uint64_t, int64_t> *Parser<uint64_t, int64_t>::Create(
   return data::CreateParser_<uint64_t, int64_t>(uri_, part_index, num_parts, type);
 }
 
+template <>
+Parser<uint32_t, half_t> *Parser<uint32_t, half_t>::Create(
+    const char *uri_, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateParser_<uint32_t, half_t>(uri_, part_index, num_parts, type);
+}
+
+template <>
+Parser<uint64_t, half_t> *Parser<uint64_t, half_t>::Create(
+    const char *uri_, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateParser_<uint64_t, half_t>(uri_, part_index, num_parts, type);
+}
+
+template <>
+Parser<uint32_t, bfloat16_t> *Parser<uint32_t, bfloat16_t>::Create(
+    const char *uri_, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateParser_<uint32_t, bfloat16_t>(uri_, part_index, num_parts, type);
+}
+
+template <>
+Parser<uint64_t, bfloat16_t> *Parser<uint64_t, bfloat16_t>::Create(
+    const char *uri_, unsigned part_index, unsigned num_parts, const char *type) {
+  return data::CreateParser_<uint64_t, bfloat16_t>(uri_, part_index, num_parts, type);
+}
+
 // registry
 typedef ParserFactoryReg<uint32_t, real_t> Reg32flt;
 typedef ParserFactoryReg<uint32_t, int32_t> Reg32int32;
@@ -192,12 +418,20 @@ typedef ParserFactoryReg<uint32_t, int64_t> Reg32int64;
 typedef ParserFactoryReg<uint64_t, real_t> Reg64flt;
 typedef ParserFactoryReg<uint64_t, int32_t> Reg64int32;
 typedef ParserFactoryReg<uint64_t, int64_t> Reg64int64;
+typedef ParserFactoryReg<uint32_t, half_t> Reg32half;
+typedef ParserFactoryReg<uint64_t, half_t> Reg64half;
+typedef ParserFactoryReg<uint32_t, bfloat16_t> Reg32bf16;
+typedef ParserFactoryReg<uint64_t, bfloat16_t> Reg64bf16;
 DMLC_REGISTRY_ENABLE(Reg32flt);
 DMLC_REGISTRY_ENABLE(Reg32int32);
 DMLC_REGISTRY_ENABLE(Reg32int64);
 DMLC_REGISTRY_ENABLE(Reg64flt);
 DMLC_REGISTRY_ENABLE(Reg64int32);
 DMLC_REGISTRY_ENABLE(Reg64int64);
+DMLC_REGISTRY_ENABLE(Reg32half);
+DMLC_REGISTRY_ENABLE(Reg64half);
+DMLC_REGISTRY_ENABLE(Reg32bf16);
+DMLC_REGISTRY_ENABLE(Reg64bf16);
 
 DMLC_REGISTER_DATA_PARSER(
     uint32_t, real_t, libsvm, data::CreateLibSVMParser<uint32_t __DMLC_COMMA real_t>);
@@ -219,6 +453,36 @@ DMLC_REGISTER_DATA_PARSER(
     uint32_t, int64_t, csv, data::CreateCSVParser<uint32_t __DMLC_COMMA int64_t>);
 DMLC_REGISTER_DATA_PARSER(
     uint64_t, int64_t, csv, data::CreateCSVParser<uint64_t __DMLC_COMMA int64_t>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, half_t, libsvm,
+    data::CreateConvertParser<uint32_t __DMLC_COMMA half_t __DMLC_COMMA data::LibSVMParser<uint32_t>>);
+DMLC_REGISTER_DATA_PARSER(uint64_t, half_t, libsvm,
+    data::CreateConvertParser<uint64_t __DMLC_COMMA half_t __DMLC_COMMA data::LibSVMParser<uint64_t>>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, half_t, libfm,
+    data::CreateConvertParser<uint32_t __DMLC_COMMA half_t __DMLC_COMMA data::LibFMParser<uint32_t>>);
+DMLC_REGISTER_DATA_PARSER(uint64_t, half_t, libfm,
+    data::CreateConvertParser<uint64_t __DMLC_COMMA half_t __DMLC_COMMA data::LibFMParser<uint64_t>>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, half_t, csv,
+    data::CreateConvertParser<uint32_t __DMLC_COMMA half_t __DMLC_COMMA data::CSVParser<uint32_t>>);
+DMLC_REGISTER_DATA_PARSER(uint64_t, half_t, csv,
+    data::CreateConvertParser<uint64_t __DMLC_COMMA half_t __DMLC_COMMA data::CSVParser<uint64_t>>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, bfloat16_t, libsvm,
+    data::CreateConvertParser<uint32_t __DMLC_COMMA bfloat16_t __DMLC_COMMA data::LibSVMParser<uint32_t>>);
+DMLC_REGISTER_DATA_PARSER(uint64_t, bfloat16_t, libsvm,
+    data::CreateConvertParser<uint64_t __DMLC_COMMA bfloat16_t __DMLC_COMMA data::LibSVMParser<uint64_t>>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, bfloat16_t, libfm,
+    data::CreateConvertParser<uint32_t __DMLC_COMMA bfloat16_t __DMLC_COMMA data::LibFMParser<uint32_t>>);
+DMLC_REGISTER_DATA_PARSER(uint64_t, bfloat16_t, libfm,
+    data::CreateConvertParser<uint64_t __DMLC_COMMA bfloat16_t __DMLC_COMMA data::LibFMParser<uint64_t>>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, bfloat16_t, csv,
+    data::CreateConvertParser<uint32_t __DMLC_COMMA bfloat16_t __DMLC_COMMA data::CSVParser<uint32_t>>);
+DMLC_REGISTER_DATA_PARSER(uint64_t, bfloat16_t, csv,
+    data::CreateConvertParser<uint64_t __DMLC_COMMA bfloat16_t __DMLC_COMMA data::CSVParser<uint64_t>>);
+#if DMLC_ENABLE_STD_THREAD
+DMLC_REGISTER_DATA_PARSER(uint32_t, real_t, libsvm_remap,
+    data::CreateRemapParser<real_t __DMLC_COMMA data::LibSVMParser<uint64_t>>);
+DMLC_REGISTER_DATA_PARSER(uint32_t, real_t, libfm_remap,
+    data::CreateRemapParser<real_t __DMLC_COMMA data::LibFMParser<uint64_t>>);
+#endif  // DMLC_ENABLE_STD_THREAD
 #ifdef DMLC_USE_PARQUET
 DMLC_REGISTER_DATA_PARSER(
     uint32_t, real_t, parquet, data::CreateParquetParser<uint32_t __DMLC_COMMA real_t>);
@@ -7,64 +7,200 @@
  */
 #ifndef DMLC_DATA_BASIC_ROW_ITER_H_
 #define DMLC_DATA_BASIC_ROW_ITER_H_
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include <dmlc/data.h>
+#include <dmlc/feature_stats.h>
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <dmlc/timer.h>
 
+#if DMLC_ENABLE_STD_THREAD
+  #include <atomic>
+  #include <condition_variable>
+  #include <exception>
+  #include <mutex>
+  #include <thread>
+#endif  // DMLC_ENABLE_STD_THREAD
+
 #include "./parser.h"
 #include "./row_block.h"
 
 namespace dmlc {
 namespace data {
+/*! \brief parameters of BasicRowIter, given as arguments of the uri */
+struct BasicRowIterParam : public Parameter<BasicRowIterParam> {
+  /*! \brief whether to merge the loaded blocks into one contiguous block */
+  bool compact;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(BasicRowIterParam) {
+    DMLC_DECLARE_FIELD(compact).set_default(false).describe(
+        "Merge all the loaded blocks into one contiguous block. "
+        "Otherwise the blocks of the parser are kept as they are.");
+  }
+};
+
 /*!
  * \brief basic set of row iterators that provides
+ *  the blocks of the parser from memory.
+ *  The blocks are moved out of the parser and kept in a list,
+ *  loading happens in background and the blocks can be
+ *  consumed before it completes.
  * \tparam IndexType the type of index we are using
  */
 template <typename IndexType, typename DType = real_t>
 class BasicRowIter : public RowBlockIter<IndexType, DType> {
  public:
-  explicit BasicRowIter(Parser<IndexType, DType> *parser) : at_head_(true) {
-    this->Init(parser);
-    delete parser;
+  /*!
+   * \brief constructor
+   * \param parser the parser, deleted by the iterator once loading completes
+   * \param compact whether to merge all the blocks into one contiguous block,
+   *   the blocks are then only available after loading completes
+   */
+  explicit BasicRowIter(Parser<IndexType, DType> *parser, bool compact = false)
+      : compact_(compact),
+        num_ready_(0),
+        load_end_(false),
+        max_index_(0),
+        has_stats_(false),
+        ptr_(0),
+        stop_(false) {
+#if DMLC_ENABLE_STD_THREAD
+    loader_ = std::thread([this, parser]() {
+      try {
+        this->Load(parser);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        except_ = std::current_exception();
+        load_end_ = true;
+        cond_.notify_all();
+      }
+    });
+#else
+    this->Load(parser);
+#endif  // DMLC_ENABLE_STD_THREAD
+  }
+  virtual ~BasicRowIter() {
+#if DMLC_ENABLE_STD_THREAD
+    stop_ = true;
+    loader_.join();
+#endif  // DMLC_ENABLE_STD_THREAD
   }
-  virtual ~BasicRowIter() {}
   virtual void BeforeFirst(void) {
-    at_head_ = true;
+    ptr_ = 0;
   }
   virtual bool Next(void) {
-    if (at_head_) {
-      at_head_ = false;
-      return true;
-    } else {
+#if DMLC_ENABLE_STD_THREAD
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return ptr_ < num_ready_ || load_end_; });
+    this->ThrowExceptionIfSet();
+#endif  // DMLC_ENABLE_STD_THREAD
+    if (ptr_ >= num_ready_) {
       return false;
     }
+    row_ = blocks_[ptr_++].GetBlock();
+    return true;
   }
   virtual const RowBlock<IndexType, DType> &Value(void) const {
     return row_;
   }
   virtual size_t NumCol(void) const {
-    return static_cast<size_t>(data_.max_index) + 1;
+#if DMLC_ENABLE_STD_THREAD
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return load_end_; });
+    this->ThrowExceptionIfSet();
+#endif  // DMLC_ENABLE_STD_THREAD
+    return static_cast<size_t>(max_index_) + 1;
+  }
+  virtual const FeatureStats *Stats(void) const {
+#if DMLC_ENABLE_STD_THREAD
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this]() { return load_end_; });
+    this->ThrowExceptionIfSet();
+#endif  // DMLC_ENABLE_STD_THREAD
+    return has_stats_ ? &stats_ : NULL;
   }
 
  private:
-  // at head
-  bool at_head_;
-  // row block to store
+  // whether to merge the blocks after loading
+  bool compact_;
+  // loaded blocks
+  std::vector<RowBlockContainer<IndexType, DType>> blocks_;
+  // number of blocks visible to the reader
+  size_t num_ready_;
+  // whether loading completed
+  bool load_end_;
+  // maximum feature index over the loaded blocks
+  IndexType max_index_;
+  // whether the parser collected statistics of the features
+  bool has_stats_;
+  // statistics of the features, taken from the parser
+  FeatureStats stats_;
+  // position of the next block
+  size_t ptr_;
+  // row block to return
   RowBlock<IndexType, DType> row_;
-  // back end data
-  RowBlockContainer<IndexType, DType> data_;
-  // initialize
-  inline void Init(Parser<IndexType, DType> *parser);
+#if DMLC_ENABLE_STD_THREAD
+  // signal the loader to stop early
+  std::atomic<bool> stop_;
+  // protects blocks_, num_ready_, load_end_ and max_index_
+  mutable std::mutex mutex_;
+  // signals new blocks or the end of loading
+  mutable std::condition_variable cond_;
+  // background loading thread
+  std::thread loader_;
+  // exception raised by the loader
+  std::exception_ptr except_;
+  // rethrow the exception of the loader, must hold mutex_
+  inline void ThrowExceptionIfSet(void) const {
+    if (except_ != nullptr) {
+      std::rethrow_exception(except_);
+    }
+  }
+#else
+  // signal the loader to stop early
+  bool stop_;
+#endif  // DMLC_ENABLE_STD_THREAD
+  // load all the blocks of the parser
+  inline void Load(Parser<IndexType, DType> *parser);
+  // publish a loaded block
+  inline void Publish(RowBlockContainer<IndexType, DType> *blk);
+  // merge all the blocks into one
+  inline void Compact(void);
 };
 
 template <typename IndexType, typename DType>
-inline void BasicRowIter<IndexType, DType>::Init(Parser<IndexType, DType> *parser) {
-  data_.Clear();
+inline void BasicRowIter<IndexType, DType>::Load(Parser<IndexType, DType> *parser_ptr) {
+  // the parser is deleted on every path, including the exceptions of the parsing
+  std::unique_ptr<Parser<IndexType, DType>> parser(parser_ptr);
   double tstart = GetTime();
   size_t bytes_expect = 10UL << 20UL;
-  while (parser->Next()) {
-    data_.Push(parser->Value());
+  ParserImpl<IndexType, DType> *impl = dynamic_cast<ParserImpl<IndexType, DType> *>(parser.get());
+  std::vector<RowBlockContainer<IndexType, DType>> chunk;
+  while (!stop_) {
+    if (impl != NULL) {
+      if (!impl->NextChunk(&chunk)) {
+        break;
+      }
+    } else {
+      // parsers without access to their containers are copied block by block
+      if (!parser->Next()) {
+        break;
+      }
+      chunk.resize(1);
+      chunk[0].Clear();
+      chunk[0].Push(parser->Value());
+    }
+    for (RowBlockContainer<IndexType, DType> &blk : chunk) {
+      if (blk.Size() != 0) {
+        this->Publish(&blk);
+      }
+    }
+    chunk.clear();
     double tdiff = GetTime() - tstart;
     size_t bytes_read = parser->BytesRead();
     if (bytes_read >= bytes_expect) {
@@ -73,9 +209,79 @@ inline void BasicRowIter<IndexType, DType>::Init(Parser<IndexType, DType> *parse
       bytes_expect += 10UL << 20UL;
     }
   }
-  row_ = data_.GetBlock();
   double tdiff = GetTime() - tstart;
   LOG(INFO) << "finish reading at " << (parser->BytesRead() >> 20UL) / tdiff << " MB/sec";
+  if (!stop_ && parser->Stats() != NULL) {
+    stats_ = *parser->Stats();
+    has_stats_ = true;
+  }
+  parser.reset();
+  if (compact_ && !stop_) {
+    this->Compact();
+  }
+#if DMLC_ENABLE_STD_THREAD
+  std::lock_guard<std::mutex> lock(mutex_);
+#endif  // DMLC_ENABLE_STD_THREAD
+  num_ready_ = blocks_.size();
+  load_end_ = true;
+#if DMLC_ENABLE_STD_THREAD
+  cond_.notify_all();
+#endif  // DMLC_ENABLE_STD_THREAD
+}
+
+template <typename IndexType, typename DType>
+inline void BasicRowIter<IndexType, DType>::Publish(RowBlockContainer<IndexType, DType> *blk) {
+  // parsers do not track the maximum, compute it before the block is shared
+  blk->max_index = 0;
+  for (IndexType findex : blk->index) {
+    blk->max_index = std::max(blk->max_index, findex);
+  }
+  blk->max_field = 0;
+  for (IndexType field_id : blk->field) {
+    blk->max_field = std::max(blk->max_field, field_id);
+  }
+#if DMLC_ENABLE_STD_THREAD
+  std::lock_guard<std::mutex> lock(mutex_);
+#endif  // DMLC_ENABLE_STD_THREAD
+  max_index_ = std::max(max_index_, blk->max_index);
+  // the buffers of the container are moved, views handed out earlier stay valid
+  blocks_.push_back(std::move(*blk));
+  if (!compact_) {
+    num_ready_ = blocks_.size();
+#if DMLC_ENABLE_STD_THREAD
+    cond_.notify_all();
+#endif  // DMLC_ENABLE_STD_THREAD
+  }
+}
+
+template <typename IndexType, typename DType>
+inline void BasicRowIter<IndexType, DType>::Compact(void) {
+  // blocks are not visible to the reader yet in compact mode
+  size_t nrow = 0, ndata = 0;
+  bool has_weight = false, has_qid = false, has_field = false, has_value = false;
+  for (const RowBlockContainer<IndexType, DType> &blk : blocks_) {
+    nrow += blk.Size();
+    ndata += blk.index.size();
+    has_weight = has_weight || blk.weight.size() != 0;
+    has_qid = has_qid || blk.qid.size() != 0;
+    has_field = has_field || blk.field.size() != 0;
+    has_value = has_value || blk.value.size() != 0;
+  }
+  // reserve the exact size, so the peak is the data plus one source block
+  RowBlockContainer<IndexType, DType> out;
+  out.offset.reserve(nrow + 1);
+  out.label.reserve(nrow);
+  out.index.reserve(ndata);
+  if (has_weight) out.weight.reserve(nrow);
+  if (has_qid) out.qid.reserve(nrow);
+  if (has_field) out.field.reserve(ndata);
+  if (has_value) out.value.reserve(ndata);
+  for (RowBlockContainer<IndexType, DType> &blk : blocks_) {
+    out.Push(blk.GetBlock());
+    blk = RowBlockContainer<IndexType, DType>();
+  }
+  blocks_.clear();
+  blocks_.push_back(std::move(out));
 }
 }  // namespace data
 }  // namespace dmlc
@@ -0,0 +1,433 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file compact_row_block.h
+ * \brief row block container with compact offset and index encodings
+ */
+#ifndef DMLC_DATA_COMPACT_ROW_BLOCK_H_
+#define DMLC_DATA_COMPACT_ROW_BLOCK_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <dmlc/data.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+
+#include "./row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief non-decreasing array of offsets, stored in 32 bits
+ *  until a value no longer fits, then in 64 bits
+ */
+class CompactOffset {
+ public:
+  CompactOffset(void) : wide_(false) {}
+  /*! \brief clear the array */
+  inline void Clear(void) {
+    wide_ = false;
+    narrow_.clear();
+    wide_data_.clear();
+  }
+  /*! \return number of offsets */
+  inline size_t Size(void) const {
+    return wide_ ? wide_data_.size() : narrow_.size();
+  }
+  /*! \return whether the offsets are stored in 64 bits */
+  inline bool IsWide(void) const {
+    return wide_;
+  }
+  /*! \brief get the i-th offset */
+  inline size_t operator[](size_t i) const {
+    return wide_ ? static_cast<size_t>(wide_data_[i]) : narrow_[i];
+  }
+  /*! \return the last offset */
+  inline size_t Back(void) const {
+    return (*this)[this->Size() - 1];
+  }
+  /*!
+   * \brief append an offset, switches to 64 bits when it does not fit
+   * \param value the offset, not smaller than the previous one
+   */
+  inline void Push(size_t value) {
+    if (!wide_ && value > std::numeric_limits<uint32_t>::max()) {
+      wide_data_.assign(narrow_.begin(), narrow_.end());
+      std::vector<uint32_t>().swap(narrow_);
+      wide_ = true;
+    }
+    if (wide_) {
+      wide_data_.push_back(value);
+    } else {
+      narrow_.push_back(static_cast<uint32_t>(value));
+    }
+  }
+  /*! \brief reserve space for n offsets */
+  inline void Reserve(size_t n) {
+    if (wide_) {
+      wide_data_.reserve(n);
+    } else {
+      narrow_.reserve(n);
+    }
+  }
+  /*! \return memory cost in bytes */
+  inline size_t MemCostBytes(void) const {
+    return narrow_.size() * sizeof(uint32_t) + wide_data_.size() * sizeof(uint64_t);
+  }
+  /*!
+   * \brief write the array to a binary stream
+   * \param fo output stream
+   */
+  inline void Save(Stream *fo) const {
+    uint8_t wide = wide_ ? 1 : 0;
+    fo->Write(wide);
+    if (wide_) {
+      fo->Write(wide_data_);
+    } else {
+      fo->Write(narrow_);
+    }
+  }
+  /*!
+   * \brief load the array from a binary stream
+   * \param fi input stream
+   * \return false if at end of file
+   */
+  inline bool Load(Stream *fi) {
+    uint8_t wide;
+    if (!fi->Read(&wide)) {
+      return false;
+    }
+    this->Clear();
+    wide_ = wide != 0;
+    if (wide_) {
+      CHECK(fi->Read(&wide_data_)) << "Bad CompactRowBlock format";
+    } else {
+      CHECK(fi->Read(&narrow_)) << "Bad CompactRowBlock format";
+    }
+    return true;
+  }
+
+ private:
+  /*! \brief whether the 64-bit storage is used */
+  bool wide_;
+  /*! \brief 32-bit storage */
+  std::vector<uint32_t> narrow_;
+  /*! \brief 64-bit storage */
+  std::vector<uint64_t> wide_data_;
+};
+
+/*!
+ * \brief append an unsigned integer in LEB128 varint encoding
+ * \param value the value
+ * \param out the output buffer
+ */
+inline void PutVarint(uint64_t value, std::vector<uint8_t> *out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+/*!
+ * \brief decode an unsigned integer in LEB128 varint encoding
+ * \param p the beginning of the encoded value
+ * \param end the end of the encoded data, a value running past it is an error
+ * \param out the decoded value
+ * \return the end of the encoded value
+ */
+inline const uint8_t *GetVarint(const uint8_t *p, const uint8_t *end, uint64_t *out) {
+  uint64_t value = 0;
+  int shift = 0;
+  for (;; shift += 7) {
+    CHECK(p != end && shift < 64) << "Bad CompactRowBlock format, truncated varint";
+    if ((*p & 0x80) == 0) {
+      break;
+    }
+    value |= static_cast<uint64_t>(*p++ & 0x7f) << shift;
+  }
+  *out = value | (static_cast<uint64_t>(*p++) << shift);
+  return p;
+}
+
+/*!
+ * \brief decode-on-iterate view of one row of CompactRowBlockContainer
+ * \tparam IndexType the type of index we are using
+ */
+template <typename IndexType, typename DType = real_t>
+class CompactRow {
+ public:
+  /*! \brief number of entries in the row */
+  size_t length;
+  /*! \brief label of the row */
+  DType label;
+  /*! \brief weight of the row */
+  real_t weight;
+  /*! \brief session-id of the row */
+  uint64_t qid;
+  /*!
+   * \brief constructor
+   * \param length number of entries
+   * \param index the encoded indices of the row
+   * \param index_end the end of the encoded indices of the row
+   * \param field the fields of the row, can be NULL
+   * \param value the values of the row, can be NULL
+   */
+  CompactRow(size_t length, const uint8_t *index, const uint8_t *index_end,
+      const IndexType *field, const DType *value)
+      : length(length), label(0), weight(1.0f), qid(0), index_(index), index_end_(index_end),
+        field_(field), value_(value), pos_(0), last_(0) {}
+  /*!
+   * \brief decode the next entry of the row
+   * \param index the feature index of the entry
+   * \param value the value of the entry, 1 if the block has no value
+   * \param field the field of the entry if not NULL, 0 if the block has no field
+   * \return false if all entries are decoded
+   */
+  inline bool Next(IndexType *index, DType *value, IndexType *field = NULL) {
+    if (pos_ == length) {
+      return false;
+    }
+    uint64_t zigzag;
+    index_ = GetVarint(index_, index_end_, &zigzag);
+    // undo the zigzag mapping, the delta wraps around as an unsigned value
+    last_ += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+    *index = static_cast<IndexType>(last_);
+    *value = value_ == NULL ? DType(1.0f) : value_[pos_];
+    if (field != NULL) {
+      *field = field_ == NULL ? 0 : field_[pos_];
+    }
+    ++pos_;
+    return true;
+  }
+
+ private:
+  /*! \brief position in the encoded indices */
+  const uint8_t *index_;
+  /*! \brief end of the encoded indices */
+  const uint8_t *index_end_;
+  /*! \brief fields of the row */
+  const IndexType *field_;
+  /*! \brief values of the row */
+  const DType *value_;
+  /*! \brief number of decoded entries */
+  size_t pos_;
+  /*! \brief last decoded index */
+  uint64_t last_;
+};
+
+/*!
+ * \brief row block container with compact encodings.
+ *  Offsets are stored in 32 bits while they fit, the feature indices
+ *  of each row are delta encoded and stored as zigzag varints.
+ *  Rows are accessed through the decode-on-iterate CompactRow view,
+ *  or decoded back into a RowBlockContainer.
+ * \tparam IndexType the type of index we are using
+ */
+template <typename IndexType, typename DType = real_t>
+struct CompactRowBlockContainer {
+  /*! \brief array[size+1], position of the first entry of each row */
+  CompactOffset offset;
+  /*! \brief array[size+1], position of the encoded indices of each row */
+  CompactOffset index_offset;
+  /*! \brief array[size] label of each instance */
+  std::vector<DType> label;
+  /*! \brief array[size] weight of each instance */
+  std::vector<real_t> weight;
+  /*! \brief array[size] session-id of each instance */
+  std::vector<uint64_t> qid;
+  /*! \brief field index */
+  std::vector<IndexType> field;
+  /*! \brief encoded feature index */
+  std::vector<uint8_t> index;
+  /*! \brief feature value */
+  std::vector<DType> value;
+  /*! \brief maximum value of field */
+  IndexType max_field;
+  /*! \brief maximum value of index */
+  IndexType max_index;
+  // constructor
+  CompactRowBlockContainer(void) {
+    this->Clear();
+  }
+  /*! \brief clear the container */
+  inline void Clear(void) {
+    offset.Clear();
+    offset.Push(0);
+    index_offset.Clear();
+    index_offset.Push(0);
+    label.clear();
+    weight.clear();
+    qid.clear();
+    field.clear();
+    index.clear();
+    value.clear();
+    max_field = 0;
+    max_index = 0;
+  }
+  /*! \brief size of the data */
+  inline size_t Size(void) const {
+    return offset.Size() - 1;
+  }
+  /*! \return memory cost of this container in bytes */
+  inline size_t MemCostBytes(void) const {
+    return offset.MemCostBytes() + index_offset.MemCostBytes() + label.size() * sizeof(DType)
+           + weight.size() * sizeof(real_t) + qid.size() * sizeof(uint64_t)
+           + field.size() * sizeof(IndexType) + index.size() + value.size() * sizeof(DType);
+  }
+  /*!
+   * \brief get the decode-on-iterate view of a row
+   * \param rowid the row id
+   */
+  inline CompactRow<IndexType, DType> operator[](size_t rowid) const {
+    size_t begin = offset[rowid];
+    CompactRow<IndexType, DType> row(offset[rowid + 1] - begin,
+        BeginPtr(index) + index_offset[rowid], BeginPtr(index) + index_offset[rowid + 1],
+        field.size() != 0 ? BeginPtr(field) + begin : NULL,
+        value.size() != 0 ? BeginPtr(value) + begin : NULL);
+    row.label = label[rowid];
+    if (weight.size() != 0) {
+      row.weight = weight[rowid];
+    }
+    if (qid.size() != 0) {
+      row.qid = qid[rowid];
+    }
+    return row;
+  }
+  /*!
+   * \brief encode the row block into the container
+   * \param batch the row block to push back
+   * \tparam I the index type of the row block
+   */
+  template <typename I>
+  inline void Push(RowBlock<I, DType> batch);
+  /*!
+   * \brief decode the container
+   * \param out the container receiving the decoded rows
+   */
+  inline void Decode(RowBlockContainer<IndexType, DType> *out) const;
+  /*!
+   * \brief write the container to a binary stream
+   * \param fo output stream
+   */
+  inline void Save(Stream *fo) const;
+  /*!
+   * \brief load the container from a binary stream
+   * \param fi input stream
+   * \return false if at end of file
+   */
+  inline bool Load(Stream *fi);
+};
+
+template <typename IndexType, typename DType>
+template <typename I>
+inline void CompactRowBlockContainer<IndexType, DType>::Push(RowBlock<I, DType> batch) {
+  label.insert(label.end(), batch.label, batch.label + batch.size);
+  if (batch.weight != NULL) {
+    weight.insert(weight.end(), batch.weight, batch.weight + batch.size);
+  }
+  if (batch.qid != NULL) {
+    qid.insert(qid.end(), batch.qid, batch.qid + batch.size);
+  }
+  const size_t ndata = batch.offset[batch.size] - batch.offset[0];
+  if (batch.field != NULL) {
+    const I *fhead = batch.field + batch.offset[0];
+    for (size_t i = 0; i < ndata; ++i) {
+      CHECK_LE(fhead[i], std::numeric_limits<IndexType>::max())
+          << "field exceed numeric bound of current type";
+      IndexType field_id = static_cast<IndexType>(fhead[i]);
+      field.push_back(field_id);
+      max_field = std::max(max_field, field_id);
+    }
+  }
+  if (batch.value != NULL) {
+    value.insert(value.end(), batch.value + batch.offset[0], batch.value + batch.offset[batch.size]);
+  }
+  offset.Reserve(offset.Size() + batch.size);
+  index_offset.Reserve(index_offset.Size() + batch.size);
+  // most deltas fit in one or two bytes
+  index.reserve(index.size() + ndata * 2);
+  const size_t shift = offset.Back() - batch.offset[0];
+  for (size_t i = 0; i < batch.size; ++i) {
+    uint64_t last = 0;
+    for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+      CHECK_LE(batch.index[j], std::numeric_limits<IndexType>::max())
+          << "index exceed numeric bound of current type";
+      IndexType findex = static_cast<IndexType>(batch.index[j]);
+      max_index = std::max(max_index, findex);
+      // zigzag keeps small negative deltas of unsorted rows small
+      int64_t delta = static_cast<int64_t>(static_cast<uint64_t>(findex) - last);
+      PutVarint((static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63), &index);
+      last = static_cast<uint64_t>(findex);
+    }
+    offset.Push(shift + batch.offset[i + 1]);
+    index_offset.Push(index.size());
+  }
+}
+
+template <typename IndexType, typename DType>
+inline void CompactRowBlockContainer<IndexType, DType>::Decode(
+    RowBlockContainer<IndexType, DType> *out) const {
+  const size_t nrow = this->Size();
+  const size_t ndata = offset.Back();
+  out->label = label;
+  out->weight = weight;
+  out->qid = qid;
+  out->field = field;
+  out->value = value;
+  out->max_field = max_field;
+  out->max_index = max_index;
+  out->offset.resize(nrow + 1);
+  for (size_t i = 0; i <= nrow; ++i) {
+    out->offset[i] = offset[i];
+  }
+  out->index.resize(ndata);
+  IndexType *ihead = BeginPtr(out->index);
+  const uint8_t *p = BeginPtr(index), *end = p + index.size();
+  for (size_t i = 0; i < nrow; ++i) {
+    uint64_t last = 0;
+    for (size_t j = offset[i]; j < offset[i + 1]; ++j) {
+      uint64_t zigzag;
+      p = GetVarint(p, end, &zigzag);
+      last += (zigzag >> 1) ^ (~(zigzag & 1) + 1);
+      ihead[j] = static_cast<IndexType>(last);
+    }
+  }
+}
+
+template <typename IndexType, typename DType>
+inline void CompactRowBlockContainer<IndexType, DType>::Save(Stream *fo) const {
+  offset.Save(fo);
+  index_offset.Save(fo);
+  fo->Write(label);
+  fo->Write(weight);
+  fo->Write(qid);
+  fo->Write(field);
+  fo->Write(index);
+  fo->Write(value);
+  fo->Write(&max_field, sizeof(IndexType));
+  fo->Write(&max_index, sizeof(IndexType));
+}
+
+template <typename IndexType, typename DType>
+inline bool CompactRowBlockContainer<IndexType, DType>::Load(Stream *fi) {
+  if (!offset.Load(fi)) {
+    return false;
+  }
+  CHECK(index_offset.Load(fi)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&label)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&weight)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&qid)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&field)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&index)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&value)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&max_field, sizeof(IndexType))) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&max_index, sizeof(IndexType))) << "Bad CompactRowBlock format";
+  CHECK(offset.Size() != 0 && index_offset.Size() == offset.Size()
+        && index_offset.Back() <= index.size() && label.size() == this->Size())
+      << "Bad CompactRowBlock format";
+  return true;
+}
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_COMPACT_ROW_BLOCK_H_
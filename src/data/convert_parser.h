@@ -0,0 +1,92 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file convert_parser.h
+ * \brief parser adapter converting the label and value type,
+ *  used to produce reduced precision row blocks from the text parsers
+ */
+#ifndef DMLC_DATA_CONVERT_PARSER_H_
+#define DMLC_DATA_CONVERT_PARSER_H_
+
+#include <utility>
+#include <vector>
+
+#include <dmlc/data.h>
+#include <dmlc/half.h>
+#include <dmlc/logging.h>
+
+#include "./parser.h"
+#include "./row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief convert a container to another label and value type,
+ *  the arrays that do not depend on the type are moved
+ * \param src the source container, left empty
+ * \param dst the converted container
+ */
+template <typename IndexType, typename SrcType, typename DType>
+inline void ConvertRowBlock(
+    RowBlockContainer<IndexType, SrcType> *src, RowBlockContainer<IndexType, DType> *dst) {
+  dst->offset.swap(src->offset);
+  dst->weight.swap(src->weight);
+  dst->qid.swap(src->qid);
+  dst->field.swap(src->field);
+  dst->index.swap(src->index);
+  dst->label.resize(src->label.size());
+  ConvertArray(BeginPtr(src->label), src->label.size(), BeginPtr(dst->label));
+  dst->value.resize(src->value.size());
+  ConvertArray(BeginPtr(src->value), src->value.size(), BeginPtr(dst->value));
+  dst->max_field = src->max_field;
+  dst->max_index = src->max_index;
+  src->Clear();
+}
+
+/*!
+ * \brief parser adapter that converts the blocks of the base parser
+ *  to DType in ParseNext, so the conversion runs in the parsing thread
+ *  when wrapped by ThreadedParser
+ * \tparam IndexType the type of index we are using
+ * \tparam DType the label and value type of the output
+ * \tparam SrcType the label and value type of the base parser
+ */
+template <typename IndexType, typename DType, typename SrcType = real_t>
+class ConvertParser : public ParserImpl<IndexType, DType> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the base parser, owned by this parser
+   */
+  explicit ConvertParser(ParserImpl<IndexType, SrcType> *base) : base_(base) {}
+  virtual ~ConvertParser(void) {
+    delete base_;
+  }
+  virtual void BeforeFirst(void) {
+    this->data_ptr_ = this->data_end_ = 0;
+    base_->BeforeFirst();
+  }
+  virtual size_t BytesRead(void) const {
+    return base_->BytesRead();
+  }
+
+ protected:
+  virtual bool ParseNext(std::vector<RowBlockContainer<IndexType, DType>> *data) {
+    if (!base_->NextChunk(&tmp_)) {
+      return false;
+    }
+    data->resize(tmp_.size());
+    for (size_t i = 0; i < tmp_.size(); ++i) {
+      ConvertRowBlock(&tmp_[i], &(*data)[i]);
+    }
+    return true;
+  }
+
+ private:
+  /*! \brief the base parser */
+  ParserImpl<IndexType, SrcType> *base_;
+  /*! \brief blocks of the base parser */
+  std::vector<RowBlockContainer<IndexType, SrcType>> tmp_;
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_CONVERT_PARSER_H_
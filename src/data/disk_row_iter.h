@@ -9,20 +9,41 @@
 #define DMLC_DATA_DISK_ROW_ITER_H_
 
 #include <algorithm>
+#include <memory>
 #include <string>
 
 #include <dmlc/data.h>
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <dmlc/threadediter.h>
 #include <dmlc/timer.h>
 
+#include "../io/cache_header.h"
+#include "./compact_row_block.h"
 #include "./libsvm_parser.h"
 #include "./row_block.h"
 
 #if DMLC_ENABLE_STD_THREAD
 namespace dmlc {
 namespace data {
+/*! \brief parameters of DiskRowIter, given as arguments of the uri */
+struct DiskRowIterParam : public Parameter<DiskRowIterParam> {
+  /*! \brief encoding of the pages in the cache file */
+  int page_format;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(DiskRowIterParam) {
+    DMLC_DECLARE_FIELD(page_format)
+        .set_default(0)
+        .add_enum("raw", 0)
+        .add_enum("compact", 1)
+        .describe(
+            "Encoding of the pages in the cache file. compact stores 32-bit offsets "
+            "and varint delta encoded indices, decoded in the prefetch thread, so it "
+            "saves disk space and read bandwidth but not memory.");
+  }
+};
+
 /*!
  * \brief basic set of row iterators that provides
  * \tparam IndexType the type of index we are using
@@ -35,10 +56,17 @@ class DiskRowIter : public RowBlockIter<IndexType, DType> {
   /*!
    * \brief disk row iterator constructor
    * \param parser parser used to generate this
-
+   * \param cache_file the path to cache file
+   * \param reuse_cache whether reuse existing cache file, if any
+   * \param header header identifying the source of the data, an existing
+   *  cache file is only reused when its header matches
+   * \param compact_page whether the pages are stored with CompactRowBlockContainer,
+   *  the header must tell the two formats apart
    */
-  explicit DiskRowIter(Parser<IndexType, DType> *parser, const char *cache_file, bool reuse_cache)
-      : cache_file_(cache_file), fi_(NULL) {
+  explicit DiskRowIter(Parser<IndexType, DType> *parser, const char *cache_file, bool reuse_cache,
+      const io::CacheHeader &header = io::CacheHeader(), bool compact_page = false)
+      : cache_file_(cache_file), fi_(NULL), header_(header), compact_page_(compact_page),
+        num_col_(0) {
     if (reuse_cache) {
       if (!TryLoadCache()) {
         this->BuildCache(parser);
@@ -77,6 +105,10 @@ class DiskRowIter : public RowBlockIter<IndexType, DType> {
   std::string cache_file_;
   // input stream
   SeekStream *fi_;
+  // header identifying the source of the cache
+  io::CacheHeader header_;
+  // whether pages are compact encoded
+  bool compact_page_;
   // maximum feature dimension
   size_t num_col_;
   // row block to store
@@ -87,6 +119,16 @@ class DiskRowIter : public RowBlockIter<IndexType, DType> {
   inline bool TryLoadCache(void);
   // build disk cache
   inline void BuildCache(Parser<IndexType, DType> *parser);
+  // write a page of the cache
+  inline void SavePage(const RowBlockContainer<IndexType, DType> &data, Stream *fo) const {
+    if (compact_page_) {
+      CompactRowBlockContainer<IndexType, DType> page;
+      page.Push(data.GetBlock());
+      page.Save(fo);
+    } else {
+      data.Save(fo);
+    }
+  }
 };
 
 // build disk cache
@@ -96,21 +138,40 @@ inline bool DiskRowIter<IndexType, DType>::TryLoadCache(void) {
   if (fi == NULL) {
     return false;
   }
+  if (!header_.Match(fi)) {
+    LOG(INFO) << "cache file " << cache_file_ << " does not match the source, rebuilding";
+    delete fi;
+    return false;
+  }
+  size_t data_begin = fi->Tell();
   this->fi_ = fi;
+  // only used by the prefetch thread
+  std::shared_ptr<CompactRowBlockContainer<IndexType, DType>> page;
+  if (compact_page_) {
+    page.reset(new CompactRowBlockContainer<IndexType, DType>());
+  }
   iter_.Init(
-      [fi](RowBlockContainer<IndexType, DType> **dptr) {
+      [fi, page](RowBlockContainer<IndexType, DType> **dptr) {
         if (*dptr == NULL) {
           *dptr = new RowBlockContainer<IndexType, DType>();
         }
+        if (page != nullptr) {
+          if (!page->Load(fi)) {
+            return false;
+          }
+          page->Decode(*dptr);
+          return true;
+        }
         return (*dptr)->Load(fi);
       },
-      [fi]() { fi->Seek(0); });
+      [fi, data_begin]() { fi->Seek(data_begin); });
   return true;
 }
 
 template <typename IndexType, typename DType>
 inline void DiskRowIter<IndexType, DType>::BuildCache(Parser<IndexType, DType> *parser) {
   Stream *fo = Stream::Create(cache_file_.c_str(), "w");
+  header_.Save(fo);
   // back end data
   RowBlockContainer<IndexType, DType> data;
   num_col_ = 0;
@@ -123,13 +184,13 @@ inline void DiskRowIter<IndexType, DType>::BuildCache(Parser<IndexType, DType> *
       bytes_read = bytes_read >> 20UL;
       LOG(INFO) << bytes_read << "MB read," << bytes_read / tdiff << " MB/sec";
       num_col_ = std::max(num_col_, static_cast<size_t>(data.max_index) + 1);
-      data.Save(fo);
+      this->SavePage(data, fo);
       data.Clear();
     }
   }
   if (data.Size() != 0) {
     num_col_ = std::max(num_col_, static_cast<size_t>(data.max_index) + 1);
-    data.Save(fo);
+    this->SavePage(data, fo);
   }
   delete fo;
   double tdiff = GetTime() - tstart;
@@ -7,10 +7,17 @@
 #ifndef DMLC_DATA_PARSER_H_
 #define DMLC_DATA_PARSER_H_
 
+#include <mutex>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <dmlc/base.h>
+#include <dmlc/common.h>
+#include <dmlc/feature_stats.h>
+#include <dmlc/io.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <dmlc/threadediter.h>
 
 #include "./row_block.h"
@@ -49,6 +56,24 @@ class ParserImpl : public Parser<IndexType, DType> {
   virtual const RowBlock<IndexType, DType> &Value(void) const {
     return block_;
   }
+  /*!
+   * \brief move the next chunk of parsed blocks out of the parser,
+   *  used instead of Next by consumers that keep the data, to avoid a copy.
+   *  Blocks that are not yet returned by Next come first.
+   * \param out the blocks of the chunk, some of them can be empty
+   * \return false if reach end
+   */
+  virtual bool NextChunk(std::vector<RowBlockContainer<IndexType, DType>> *out) {
+    if (data_ptr_ < data_end_) {
+      out->clear();
+      for (IndexType i = data_ptr_; i < data_end_; ++i) {
+        out->push_back(std::move(data_[i]));
+      }
+      data_ptr_ = data_end_;
+      return true;
+    }
+    return ParseNext(out);
+  }
   /*! \return size of bytes read so far */
   virtual size_t BytesRead(void) const = 0;
 
@@ -71,33 +96,150 @@ class ParserImpl : public Parser<IndexType, DType> {
 
 #if DMLC_ENABLE_STD_THREAD
 
+/*! \brief parameters of ThreadedParser, given as arguments of the uri */
+struct ThreadedParserParam : public Parameter<ThreadedParserParam> {
+  /*! \brief memory budget in MB of parsed blocks kept across epochs */
+  int epoch_cache_mb;
+  /*! \brief file receiving the parsed blocks beyond the memory budget */
+  std::string epoch_cache_spill;
+  /*! \brief whether to collect the statistics of the features */
+  bool feature_stats;
+  /*! \brief maximum size of the quantile summary of each feature */
+  int stats_sketch_size;
+  /*! \brief memory budget in MB of the blocks parsed ahead */
+  int prefetch_mb;
+  /*! \brief file of the BinQuantizer replacing the values by bin ids */
+  std::string bin_cuts;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ThreadedParserParam) {
+    DMLC_DECLARE_FIELD(epoch_cache_mb)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Memory budget in MB of the parsed blocks kept after the first pass, "
+            "later passes are served without parsing again. 0 disables the cache.");
+    DMLC_DECLARE_FIELD(epoch_cache_spill)
+        .set_default("")
+        .describe(
+            "File receiving the parsed blocks that do not fit in epoch_cache_mb. "
+            "If empty, the cache is dropped once the budget is exceeded.");
+    DMLC_DECLARE_FIELD(feature_stats)
+        .set_default(false)
+        .describe(
+            "Collect the count, weight, minimum, maximum and quantiles of the "
+            "values of each feature in the parsing thread.");
+    DMLC_DECLARE_FIELD(stats_sketch_size)
+        .set_default(256)
+        .set_lower_bound(0)
+        .describe(
+            "Maximum number of entries of the quantile summary of each feature, "
+            "the rank error is about log2(#chunks) / stats_sketch_size. "
+            "0 disables the quantile sketch.");
+    DMLC_DECLARE_FIELD(prefetch_mb)
+        .set_default(256)
+        .set_lower_bound(0)
+        .describe(
+            "Memory budget in MB of the blocks parsed ahead of the consumer, the number "
+            "of blocks parsed ahead grows while the consumer waits and shrinks when "
+            "the budget is exceeded. 0 always parses 8 blocks ahead.");
+    DMLC_DECLARE_FIELD(bin_cuts)
+        .set_default("")
+        .describe(
+            "File of a BinQuantizer saved with Save. If given, the values are "
+            "replaced by their bin ids in the parsing thread, see BinRowIter.");
+  }
+};
+
 template <typename IndexType, typename DType = real_t>
 class ThreadedParser : public ParserImpl<IndexType, DType> {
  public:
-  explicit ThreadedParser(ParserImpl<IndexType, DType> *base) : base_(base), tmp_(NULL) {
+  /*!
+   * \brief constructor
+   * \param base the parser doing the actual work, owned by this parser
+   * \param epoch_cache_bytes memory budget of the epoch cache, 0 disables it
+   * \param epoch_cache_spill file receiving the blocks beyond the budget,
+   *   empty to drop the cache when the budget is exceeded
+   * \param feature_stats whether to collect the statistics of the features
+   * \param stats_sketch_size maximum size of the quantile summary of each feature,
+   *   0 to not sketch the values
+   * \param prefetch_bytes memory budget of the blocks parsed ahead, 0 to always parse 8 ahead
+   */
+  explicit ThreadedParser(ParserImpl<IndexType, DType> *base, size_t epoch_cache_bytes = 0,
+      const std::string &epoch_cache_spill = "", bool feature_stats = false,
+      size_t stats_sketch_size = 0, size_t prefetch_bytes = 0)
+      : base_(base),
+        tmp_(NULL),
+        cache_budget_(epoch_cache_bytes),
+        cache_state_(epoch_cache_bytes != 0 ? kCacheFill : kCacheOff),
+        cache_bytes_(0),
+        cache_ptr_(0),
+        spill_file_(epoch_cache_spill),
+        spill_out_(NULL),
+        spill_in_(NULL),
+        spill_end_(true),
+        collect_stats_(feature_stats),
+        has_stats_(false),
+        stats_(stats_sketch_size),
+        pass_stats_(stats_sketch_size),
+        done_stats_(stats_sketch_size),
+        stats_ready_(false) {
     iter_.set_max_capacity(8);
+    iter_.set_max_bytes(prefetch_bytes, BlocksBytes);
     iter_.Init(
-        [base](std::vector<RowBlockContainer<IndexType, DType>> **dptr) {
+        [this, base](std::vector<RowBlockContainer<IndexType, DType>> **dptr) {
           if (*dptr == NULL) {
             *dptr = new std::vector<RowBlockContainer<IndexType, DType>>();
           }
-          return base->ParseNext(*dptr);
+          bool ret = base->ParseNext(*dptr);
+          if (collect_stats_) {
+            if (ret) {
+              this->CollectStats(**dptr);
+            } else {
+              this->FinishStats();
+            }
+          }
+          return ret;
         },
-        [base]() { base->BeforeFirst(); });
+        [this, base]() {
+          base->BeforeFirst();
+          pass_stats_.Clear();
+        });
   }
   virtual ~ThreadedParser(void) {
     // stop things before base is deleted
     iter_.Destroy();
+    spill_iter_.Destroy();
+    this->ClearCache();
+    delete spill_in_;
     delete base_;
     delete tmp_;
   }
   virtual void BeforeFirst() {
+    data_ptr_ = data_end_ = 0;
+    if (cache_state_ == kCacheReady) {
+      cache_ptr_ = 0;
+      if (spill_in_ != NULL) {
+        spill_iter_.BeforeFirst();
+        spill_end_ = false;
+      }
+      return;
+    }
+    if (tmp_ != NULL) {
+      iter_.Recycle(&tmp_);
+    }
+    // the pass was not completed, start over
+    if (cache_state_ == kCacheFill) {
+      this->ClearCache();
+    }
     iter_.BeforeFirst();
   }
   /*! \brief implement next */
   using ParserImpl<IndexType, DType>::data_ptr_;
   using ParserImpl<IndexType, DType>::data_end_;
   virtual bool Next(void) {
+    if (cache_state_ == kCacheReady) {
+      return this->NextCached();
+    }
     while (true) {
       while (data_ptr_ < data_end_) {
         data_ptr_ += 1;
@@ -107,9 +249,18 @@ class ThreadedParser : public ParserImpl<IndexType, DType> {
         }
       }
       if (tmp_ != NULL) {
-        iter_.Recycle(&tmp_);
+        if (cache_state_ == kCacheFill) {
+          this->CacheChunk();
+        }
+        if (tmp_ != NULL) {
+          iter_.Recycle(&tmp_);
+        }
       }
       if (!iter_.Next(&tmp_)) {
+        if (cache_state_ == kCacheFill) {
+          this->FinishCache();
+        }
+        this->TakeStats();
         break;
       }
       data_ptr_ = 0;
@@ -117,9 +268,47 @@ class ThreadedParser : public ParserImpl<IndexType, DType> {
     }
     return false;
   }
+  virtual bool NextChunk(std::vector<RowBlockContainer<IndexType, DType>> *out) {
+    if (cache_state_ != kCacheOff) {
+      // the blocks are shared with the epoch cache, hand out copies
+      if (!this->Next()) {
+        return false;
+      }
+      out->resize(1);
+      (*out)[0].Clear();
+      (*out)[0].Push(this->block_);
+      return true;
+    }
+    if (data_ptr_ < data_end_) {
+      out->clear();
+      for (IndexType i = data_ptr_; i < data_end_; ++i) {
+        out->push_back(std::move((*tmp_)[i]));
+      }
+      data_ptr_ = data_end_;
+      return true;
+    }
+    if (tmp_ != NULL) {
+      iter_.Recycle(&tmp_);
+    }
+    if (!iter_.Next(&tmp_)) {
+      this->TakeStats();
+      return false;
+    }
+    // take over the chunk, the producer gets the storage of out in exchange
+    std::swap(*out, *tmp_);
+    iter_.Recycle(&tmp_);
+    return true;
+  }
   virtual size_t BytesRead() const {
     return base_->BytesRead();
   }
+  virtual const FeatureStats *Stats(void) const {
+    return has_stats_ ? &stats_ : NULL;
+  }
+  virtual bool GetPrefetchStats(PrefetchStats *out) {
+    *out = iter_.GetStats();
+    return true;
+  }
 
  protected:
   virtual bool ParseNext(std::vector<RowBlockContainer<IndexType, DType>> * /*data*/) {
@@ -128,12 +317,183 @@ class ThreadedParser : public ParserImpl<IndexType, DType> {
   }
 
  private:
+  /*! \brief state of the epoch cache */
+  enum CacheState {
+    /*! \brief no caching */
+    kCacheOff,
+    /*! \brief first pass, chunks are being collected */
+    kCacheFill,
+    /*! \brief a full pass is cached, the base parser is no longer used */
+    kCacheReady
+  };
   /*! \brief the place where we get the data */
   Parser<IndexType, DType> *base_;
   /*! \brief backend threaded iterator */
   ThreadedIter<std::vector<RowBlockContainer<IndexType, DType>>> iter_;
   /*! \brief current chunk of data */
   std::vector<RowBlockContainer<IndexType, DType>> *tmp_;
+  /*! \brief memory budget of the epoch cache in bytes */
+  size_t cache_budget_;
+  /*! \brief state of the epoch cache */
+  CacheState cache_state_;
+  /*! \brief chunks kept in memory, in the order they were parsed */
+  std::vector<std::vector<RowBlockContainer<IndexType, DType>> *> cache_;
+  /*! \brief bytes used by the chunks in cache_ */
+  size_t cache_bytes_;
+  /*! \brief position of the next chunk in cache_ */
+  size_t cache_ptr_;
+  /*! \brief file receiving the blocks beyond the budget */
+  std::string spill_file_;
+  /*! \brief stream writing the spill file during the first pass */
+  Stream *spill_out_;
+  /*! \brief stream reading back the spill file */
+  SeekStream *spill_in_;
+  /*! \brief whether the spilled blocks of the current pass are exhausted */
+  bool spill_end_;
+  /*! \brief prefetcher of the spilled blocks */
+  ThreadedIter<RowBlockContainer<IndexType, DType>> spill_iter_;
+  /*! \brief whether to collect the statistics of the features */
+  bool collect_stats_;
+  /*! \brief whether stats_ holds the statistics of a complete pass */
+  bool has_stats_;
+  /*! \brief statistics of the last complete pass, seen by the consumer */
+  FeatureStats stats_;
+  /*! \brief statistics of the current pass, used by the parsing thread */
+  FeatureStats pass_stats_;
+  /*! \brief statistics of a pass completed by the parsing thread */
+  FeatureStats done_stats_;
+  /*! \brief whether done_stats_ is not taken yet */
+  bool stats_ready_;
+  /*! \brief protects done_stats_ and stats_ready_ */
+  std::mutex stats_mutex_;
+  // add the statistics of a chunk, one block per thread, in the parsing thread
+  inline void CollectStats(const std::vector<RowBlockContainer<IndexType, DType>> &chunk) {
+    if (chunk.size() == 0) {
+      return;
+    }
+    std::vector<FeatureStats> part(chunk.size(), FeatureStats(pass_stats_.SketchSize()));
+    ParallelFor(chunk.size(), static_cast<int>(chunk.size()),
+        [&](int /*tid*/, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            part[i].Add(chunk[i].GetBlock());
+          }
+        });
+    for (const FeatureStats &stats : part) {
+      pass_stats_.Merge(stats);
+    }
+  }
+  // hand the statistics of the pass to the consumer, in the parsing thread
+  inline void FinishStats(void) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    std::swap(done_stats_, pass_stats_);
+    pass_stats_.Clear();
+    stats_ready_ = true;
+  }
+  // take the statistics of the pass that just ended
+  inline void TakeStats(void) {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (stats_ready_) {
+      std::swap(stats_, done_stats_);
+      stats_ready_ = false;
+      has_stats_ = true;
+    }
+  }
+  // memory held by a chunk
+  inline static size_t BlocksBytes(const std::vector<RowBlockContainer<IndexType, DType>> &chunk) {
+    size_t nbytes = 0;
+    for (const RowBlockContainer<IndexType, DType> &blk : chunk) {
+      nbytes += blk.MemCostBytes();
+    }
+    return nbytes;
+  }
+  // keep tmp_ in the cache, or move it to the spill file
+  inline void CacheChunk(void) {
+    if (spill_out_ == NULL) {
+      const size_t nbytes = BlocksBytes(*tmp_);
+      if (cache_bytes_ + nbytes <= cache_budget_) {
+        cache_bytes_ += nbytes;
+        cache_.push_back(tmp_);
+        tmp_ = NULL;
+        return;
+      }
+      if (spill_file_.length() == 0) {
+        LOG(INFO) << "parsed data exceeds epoch_cache_mb, epoch cache disabled";
+        this->ClearCache();
+        cache_state_ = kCacheOff;
+        return;
+      }
+      spill_out_ = Stream::Create(spill_file_.c_str(), "w");
+    }
+    // keep the order of the chunks: once spilling starts, everything goes to the file
+    for (const RowBlockContainer<IndexType, DType> &blk : *tmp_) {
+      if (blk.Size() != 0) {
+        blk.Save(spill_out_);
+      }
+    }
+  }
+  // switch to the cached data after the first full pass
+  inline void FinishCache(void) {
+    cache_state_ = kCacheReady;
+    cache_ptr_ = cache_.size();
+    if (spill_out_ != NULL) {
+      delete spill_out_;
+      spill_out_ = NULL;
+      spill_in_ = SeekStream::CreateForRead(spill_file_.c_str());
+      SeekStream *fi = spill_in_;
+      spill_iter_.set_max_capacity(2);
+      spill_iter_.Init(
+          [fi](RowBlockContainer<IndexType, DType> **dptr) {
+            if (*dptr == NULL) {
+              *dptr = new RowBlockContainer<IndexType, DType>();
+            }
+            return (*dptr)->Load(fi);
+          },
+          [fi]() { fi->Seek(0); });
+    }
+    LOG(INFO) << "epoch cache ready, " << (cache_bytes_ >> 20UL) << " MB in memory"
+              << (spill_in_ != NULL ? ", rest spilled to " + spill_file_ : std::string());
+  }
+  // drop the collected chunks
+  inline void ClearCache(void) {
+    for (std::vector<RowBlockContainer<IndexType, DType>> *chunk : cache_) {
+      delete chunk;
+    }
+    cache_.clear();
+    cache_bytes_ = 0;
+    cache_ptr_ = 0;
+    if (spill_out_ != NULL) {
+      delete spill_out_;
+      spill_out_ = NULL;
+    }
+  }
+  // serve the next block from the cache
+  inline bool NextCached(void) {
+    while (true) {
+      while (data_ptr_ < data_end_) {
+        data_ptr_ += 1;
+        const RowBlockContainer<IndexType, DType> &blk = (*cache_[cache_ptr_ - 1])[data_ptr_ - 1];
+        if (blk.Size() != 0) {
+          this->block_ = blk.GetBlock();
+          return true;
+        }
+      }
+      if (cache_ptr_ == cache_.size()) {
+        break;
+      }
+      cache_ptr_ += 1;
+      data_ptr_ = 0;
+      data_end_ = static_cast<IndexType>(cache_[cache_ptr_ - 1]->size());
+    }
+    if (spill_end_) {
+      return false;
+    }
+    if (!spill_iter_.Next()) {
+      spill_end_ = true;
+      return false;
+    }
+    this->block_ = spill_iter_.Value().GetBlock();
+    return true;
+  }
 };
 #endif  // DMLC_USE_CXX11
 }  // namespace data
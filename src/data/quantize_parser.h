@@ -0,0 +1,80 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file quantize_parser.h
+ * \brief parser adapter replacing the values of a parser by their bin ids
+ */
+#ifndef DMLC_DATA_QUANTIZE_PARSER_H_
+#define DMLC_DATA_QUANTIZE_PARSER_H_
+
+#include <vector>
+
+#include <dmlc/common.h>
+#include <dmlc/data.h>
+#include <dmlc/logging.h>
+#include <dmlc/quantizer.h>
+
+#include "./parser.h"
+#include "./row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief parser adapter that replaces the values of the base parser by their
+ *  bin ids in ParseNext, so the quantization runs in the parsing thread when
+ *  wrapped by ThreadedParser. The blocks of a chunk are quantized in parallel.
+ *  Entries without value get the bin of the value 1.
+ * \tparam IndexType the index type
+ * \tparam DType the label and value type, must hold the bin ids exactly
+ */
+template <typename IndexType, typename DType = real_t>
+class QuantizeParser : public ParserImpl<IndexType, DType> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the base parser, owned by this parser
+   * \param quantizer the cut points of the features
+   */
+  QuantizeParser(ParserImpl<IndexType, DType> *base, const BinQuantizer &quantizer)
+      : base_(base), quantizer_(quantizer) {
+    const float max_bin = static_cast<float>(quantizer_.MaxBin() - 1);
+    CHECK_EQ(static_cast<float>(static_cast<DType>(max_bin)), max_bin)
+        << "the value type can not hold the bin ids";
+  }
+  virtual ~QuantizeParser(void) {
+    delete base_;
+  }
+  virtual void BeforeFirst(void) {
+    this->data_ptr_ = this->data_end_ = 0;
+    base_->BeforeFirst();
+  }
+  virtual size_t BytesRead(void) const {
+    return base_->BytesRead();
+  }
+
+ protected:
+  virtual bool ParseNext(std::vector<RowBlockContainer<IndexType, DType>> *data) {
+    if (!base_->NextChunk(data)) {
+      return false;
+    }
+    ParallelFor(data->size(), static_cast<int>(data->size()),
+        [&](int /*tid*/, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            RowBlockContainer<IndexType, DType> &blk = (*data)[i];
+            // the bins are written over the values they are searched for
+            blk.value.resize(blk.index.size(), DType(1.0f));
+            quantizer_.BinEntries(
+                BeginPtr(blk.index), BeginPtr(blk.value), blk.index.size(), BeginPtr(blk.value));
+          }
+        });
+    return true;
+  }
+
+ private:
+  /*! \brief the base parser */
+  ParserImpl<IndexType, DType> *base_;
+  /*! \brief the cut points of the features */
+  BinQuantizer quantizer_;
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_QUANTIZE_PARSER_H_
@@ -0,0 +1,250 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file remap_parser.h
+ * \brief parser adapter mapping the 64-bit feature ids of a parser
+ *  to dense 32-bit ids, dropping the features outside the dictionary
+ */
+#ifndef DMLC_DATA_REMAP_PARSER_H_
+#define DMLC_DATA_REMAP_PARSER_H_
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <dmlc/common.h>
+#include <dmlc/data.h>
+#include <dmlc/feature_map.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+
+#include "./parser.h"
+#include "./row_block.h"
+
+namespace dmlc {
+namespace data {
+/*! \brief parameters of RemapParser, given as arguments of the uri */
+struct RemapParserParam : public Parameter<RemapParserParam> {
+  /*! \brief file of the dictionary */
+  std::string feature_dict;
+  /*! \brief text file of the features to keep */
+  std::string feature_whitelist;
+  /*! \brief minimum number of occurrences of a kept feature */
+  int feature_min_count;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(RemapParserParam) {
+    DMLC_DECLARE_FIELD(feature_dict)
+        .set_default("")
+        .describe(
+            "Dictionary of the dense feature ids. If the file exists, it is loaded "
+            "and the features outside of it are dropped. Otherwise the dictionary "
+            "is learned in the first pass and saved to the file at its end.");
+    DMLC_DECLARE_FIELD(feature_whitelist)
+        .set_default("")
+        .describe(
+            "Text file with one raw feature id per line, only these features are kept "
+            "and numbered in the order of the file.");
+    DMLC_DECLARE_FIELD(feature_min_count)
+        .set_default(0)
+        .set_lower_bound(0)
+        .describe(
+            "Drop the features occurring less often, counted in an extra pass "
+            "over the data before parsing starts.");
+  }
+};
+
+/*!
+ * \brief map the feature ids of a container to dense ids, dropping the
+ *  entries of the features mapped to FeatureIdMap::kInvalid
+ * \param src the source container
+ * \param map the dictionary, new features are inserted unless it is frozen
+ * \param dst the converted container
+ */
+template <typename DType>
+inline void RemapRowBlock(const RowBlockContainer<uint64_t, DType> &src, FeatureIdMap *map,
+    RowBlockContainer<uint32_t, DType> *dst) {
+  dst->Clear();
+  dst->label = src.label;
+  dst->weight = src.weight;
+  dst->qid = src.qid;
+  dst->offset.resize(src.offset.size());
+  dst->index.reserve(src.index.size());
+  dst->value.reserve(src.value.size());
+  const bool has_field = src.field.size() != 0;
+  const bool has_value = src.value.size() != 0;
+  for (size_t i = 0; i < src.Size(); ++i) {
+    for (size_t j = src.offset[i]; j < src.offset[i + 1]; ++j) {
+      const uint32_t findex = map->Insert(src.index[j]);
+      if (findex == FeatureIdMap::kInvalid) {
+        continue;
+      }
+      dst->index.push_back(findex);
+      dst->max_index = std::max(dst->max_index, findex);
+      if (has_value) {
+        dst->value.push_back(src.value[j]);
+      }
+      if (has_field) {
+        const uint32_t field = static_cast<uint32_t>(src.field[j]);
+        dst->field.push_back(field);
+        dst->max_field = std::max(dst->max_field, field);
+      }
+    }
+    dst->offset[i + 1] = dst->index.size();
+  }
+}
+
+/*!
+ * \brief append the features of a container missing from the dictionary
+ *  in the order of their first occurrence, without duplicates
+ * \param src the container
+ * \param map the dictionary
+ * \param out the missing features
+ */
+template <typename DType>
+inline void MissingFeatures(const RowBlockContainer<uint64_t, DType> &src,
+    const FeatureIdMap &map, std::vector<uint64_t> *out) {
+  std::unordered_set<uint64_t> seen;
+  for (uint64_t findex : src.index) {
+    if (map.Find(findex) == FeatureIdMap::kInvalid && seen.insert(findex).second) {
+      out->push_back(findex);
+    }
+  }
+}
+
+/*!
+ * \brief parser adapter that maps the feature ids of the base parser to dense
+ *  ids in ParseNext, so the mapping runs in the parsing thread when wrapped
+ *  by ThreadedParser. The blocks of a chunk are mapped in parallel,
+ *  sharing the dictionary. New features are numbered in the order of their
+ *  first occurrence in the data, whatever the number of parsing threads.
+ * \tparam DType the label and value type
+ */
+template <typename DType = real_t>
+class RemapParser : public ParserImpl<uint32_t, DType> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the base parser, owned by this parser
+   * \param map the dictionary, new features are numbered unless it is frozen
+   * \param dict_file file the dictionary is saved to and frozen at the end
+   *   of the first pass if it is not frozen, empty to not save it
+   */
+  RemapParser(ParserImpl<uint64_t, DType> *base, std::shared_ptr<FeatureIdMap> map,
+      const std::string &dict_file = "")
+      : base_(base), map_(map), dict_file_(dict_file) {}
+  virtual ~RemapParser(void) {
+    delete base_;
+  }
+  virtual void BeforeFirst(void) {
+    this->data_ptr_ = this->data_end_ = 0;
+    base_->BeforeFirst();
+  }
+  virtual size_t BytesRead(void) const {
+    return base_->BytesRead();
+  }
+  /*!
+   * \brief keep only the frequent features, counted in a pass over the base parser
+   * \param base the parser, rewound afterwards
+   * \param min_count minimum number of occurrences of a kept feature
+   * \param map the dictionary receiving the kept features in increasing order
+   *   of raw id, frozen afterwards
+   */
+  static void CountFeatures(ParserImpl<uint64_t, DType> *base, size_t min_count,
+      FeatureIdMap *map) {
+    std::unordered_map<uint64_t, size_t> count;
+    std::vector<RowBlockContainer<uint64_t, DType>> chunk;
+    base->BeforeFirst();
+    while (base->NextChunk(&chunk)) {
+      std::vector<std::unordered_map<uint64_t, size_t>> part(chunk.size());
+      ParallelFor(chunk.size(), static_cast<int>(chunk.size()),
+          [&](int /*tid*/, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              for (uint64_t findex : chunk[i].index) {
+                ++part[i][findex];
+              }
+            }
+          });
+      for (const std::unordered_map<uint64_t, size_t> &p : part) {
+        for (const auto &kv : p) {
+          count[kv.first] += kv.second;
+        }
+      }
+    }
+    base->BeforeFirst();
+    std::vector<uint64_t> keep;
+    for (const auto &kv : count) {
+      if (kv.second >= min_count) {
+        keep.push_back(kv.first);
+      }
+    }
+    std::sort(keep.begin(), keep.end());
+    for (uint64_t id : keep) {
+      map->Insert(id);
+    }
+    map->Freeze();
+  }
+  /*!
+   * \brief map the blocks of a chunk in parallel. Unless the dictionary is
+   *  frozen, the new features are first numbered in block order, so the
+   *  numbering does not depend on the order the threads reach them.
+   * \param chunk the blocks of the base parser
+   * \param map the dictionary
+   * \param data the mapped blocks
+   */
+  static void RemapChunk(const std::vector<RowBlockContainer<uint64_t, DType>> &chunk,
+      FeatureIdMap *map, std::vector<RowBlockContainer<uint32_t, DType>> *data) {
+    if (!map->Frozen()) {
+      std::vector<std::vector<uint64_t>> missing(chunk.size());
+      ParallelFor(chunk.size(), static_cast<int>(chunk.size()),
+          [&](int /*tid*/, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+              MissingFeatures(chunk[i], *map, &missing[i]);
+            }
+          });
+      for (const std::vector<uint64_t> &ids : missing) {
+        for (uint64_t id : ids) {
+          map->Insert(id);
+        }
+      }
+    }
+    data->resize(chunk.size());
+    ParallelFor(chunk.size(), static_cast<int>(chunk.size()),
+        [&](int /*tid*/, size_t begin, size_t end) {
+          for (size_t i = begin; i < end; ++i) {
+            RemapRowBlock(chunk[i], map, &(*data)[i]);
+          }
+        });
+  }
+
+ protected:
+  virtual bool ParseNext(std::vector<RowBlockContainer<uint32_t, DType>> *data) {
+    if (!base_->NextChunk(&tmp_)) {
+      if (!map_->Frozen() && dict_file_.length() != 0) {
+        map_->Freeze();
+        std::unique_ptr<Stream> fo(Stream::Create(dict_file_.c_str(), "w"));
+        map_->Save(fo.get());
+        LOG(INFO) << "saved " << map_->Size() << " features to " << dict_file_;
+      }
+      return false;
+    }
+    RemapChunk(tmp_, map_.get(), data);
+    return true;
+  }
+
+ private:
+  /*! \brief the base parser */
+  ParserImpl<uint64_t, DType> *base_;
+  /*! \brief the dictionary */
+  std::shared_ptr<FeatureIdMap> map_;
+  /*! \brief file the learned dictionary is saved to */
+  std::string dict_file_;
+  /*! \brief blocks of the base parser */
+  std::vector<RowBlockContainer<uint64_t, DType>> tmp_;
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_REMAP_PARSER_H_
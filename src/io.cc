@@ -1,5 +1,6 @@
 // Copyright by Contributors
 
+#include <cstdlib>
 #include <cstring>
 
 #include <dmlc/base.h>
@@ -10,6 +11,7 @@
 #include "io/indexed_recordio_split.h"
 #include "io/line_split.h"
 #include "io/local_filesys.h"
+#include "io/record_shuffle_split.h"
 #include "io/recordio_split.h"
 #include "io/single_file_split.h"
 #include "io/threaded_input_split.h"
@@ -71,6 +73,20 @@ FileSystem *FileSystem::GetInstance(const URI &path) {
   LOG(FATAL) << "unknown filesystem protocol " + path.protocol;
   return NULL;
 }
+/*!
+ * \brief uri?shuffle_mb=n returns the records in random order from a reservoir of n MB,
+ *  seeded by uri?shuffle_seed=s, the rank of the partition and the epoch
+ */
+static InputSplit *ShuffleRecords(
+    const URISpec &spec, InputSplit *split, unsigned part, const char *type) {
+  if (spec.args.count("shuffle_mb") == 0) {
+    return split;
+  }
+  const size_t shuffle_mb = static_cast<size_t>(atol(spec.args.at("shuffle_mb").c_str()));
+  const int seed
+      = spec.args.count("shuffle_seed") != 0 ? atoi(spec.args.at("shuffle_seed").c_str()) : 0;
+  return new RecordShuffleSplit(split, !strcmp(type, "text"), shuffle_mb << 20UL, seed, part);
+}
 }  // namespace io
 
 InputSplit *InputSplit::Create(const char *uri_, unsigned part, unsigned nsplit, const char *type) {
@@ -89,32 +105,87 @@ InputSplit *InputSplit::Create(const char *uri_, const char *index_uri_, unsigne
   }
   CHECK(part < nsplit) << "invalid input parameter for InputSplit::Create";
   URI path(spec.uri.c_str());
+  // uri?manifest=file reads the listing of the files from the file, written on first use
+  const std::string manifest = spec.args.count("manifest") != 0 ? spec.args.at("manifest") : "";
+  // uri?whole_files=1 assigns whole files to the partitions, for many small files
+  const bool whole_files
+      = spec.args.count("whole_files") != 0 && atoi(spec.args.at("whole_files").c_str()) != 0;
+  if (whole_files) {
+    CHECK(strcmp(type, "indexed_recordio")) << "whole_files is not supported by indexed_recordio";
+    CHECK_EQ(spec.args.count("line_index"), 0U) << "whole_files can not be used with line_index";
+  }
   InputSplitBase *split = NULL;
   if (!strcmp(type, "text")) {
-    split = new LineSplitter(FileSystem::GetInstance(path), spec.uri.c_str(), part, nsplit);
+    // uri?line_index=file partitions by lines with a sidecar index of the line offsets
+    const std::string line_index
+        = spec.args.count("line_index") != 0 ? spec.args.at("line_index") : "";
+    split = new LineSplitter(FileSystem::GetInstance(path), spec.uri.c_str(), part, nsplit,
+        manifest, line_index, whole_files);
   } else if (!strcmp(type, "indexed_recordio")) {
     if (index_uri_ != nullptr) {
       io::URISpec index_spec(index_uri_, part, nsplit);
-      split = new IndexedRecordIOSplitter(FileSystem::GetInstance(path), spec.uri.c_str(),
-          index_spec.uri.c_str(), part, nsplit, batch_size, shuffle, seed);
+      IndexedRecordIOSplitter *indexed = new IndexedRecordIOSplitter(
+          FileSystem::GetInstance(path), spec.uri.c_str(), index_spec.uri.c_str(), part, nsplit,
+          batch_size, shuffle, seed, manifest);
+      // uri?readers=n reads the ranges of each shuffled batch with n threads
+      if (spec.args.count("readers") != 0) {
+        CHECK(shuffle) << "readers is only supported by indexed_recordio with shuffle";
+        indexed->SetReadThreads(atoi(spec.args.at("readers").c_str()));
+      }
+      split = indexed;
     } else {
       LOG(FATAL) << "need to pass index file to use IndexedRecordIO";
     }
   } else if (!strcmp(type, "recordio")) {
-    split = new RecordIOSplitter(
-        FileSystem::GetInstance(path), spec.uri.c_str(), part, nsplit, recurse_directories);
+    split = new RecordIOSplitter(FileSystem::GetInstance(path), spec.uri.c_str(), part, nsplit,
+        recurse_directories, manifest, whole_files);
   } else {
     LOG(FATAL) << "unknown input split type " << type;
   }
+  // uri?mmap=1 reads local files through memory maps, the kernel reads ahead
+  // so the chunks are not prefetched by a thread, which would copy them
+  if (spec.args.count("mmap") != 0 && atoi(spec.args.at("mmap").c_str()) != 0) {
+    CHECK(strcmp(type, "indexed_recordio")) << "mmap is not supported by indexed_recordio";
+    CHECK_EQ(spec.cache_file.length(), 0U) << "mmap can not be used with a cache file";
+    split->EnableMMap();
+    return ShuffleRecords(spec, split, part, type);
+  }
+  // uri?readers=n reads the next chunks with n threads of positioned reads,
+  // small files are opened and read 8 at a time by default
+  if (spec.args.count("readers") != 0) {
+    // indexed_recordio reads its shuffled batches with the readers, see above
+    if (strcmp(type, "indexed_recordio")) {
+      split->EnableParallelRead(atoi(spec.args.at("readers").c_str()));
+    }
+  } else if (whole_files && spec.args.count("aio") == 0) {
+#if DMLC_ENABLE_STD_THREAD
+    split->EnableParallelRead(8);
+#endif  // DMLC_ENABLE_STD_THREAD
+  }
+  // uri?aio=n keeps n blocks of the local files read ahead with io_uring,
+  // and uri?direct=1 reads them with O_DIRECT
+  if (spec.args.count("aio") != 0) {
+    CHECK(strcmp(type, "indexed_recordio")) << "aio is not supported by indexed_recordio";
+    const bool direct
+        = spec.args.count("direct") != 0 && atoi(spec.args.at("direct").c_str()) != 0;
+    split->EnableAsyncRead(static_cast<size_t>(atol(spec.args.at("aio").c_str())), direct);
+  }
 #if DMLC_ENABLE_STD_THREAD
+  // uri?prefetch_mb=n is the memory budget of the chunks read ahead (128 MB by default),
+  // 0 to always read two chunks ahead
+  const size_t prefetch_mb = spec.args.count("prefetch_mb") != 0
+      ? static_cast<size_t>(atol(spec.args.at("prefetch_mb").c_str())) : 128;
   if (spec.cache_file.length() == 0) {
-    return new ThreadedInputSplit(split, batch_size);
+    return ShuffleRecords(
+        spec, new ThreadedInputSplit(split, batch_size, prefetch_mb << 20UL), part, type);
   } else {
-    return new CachedInputSplit(split, spec.cache_file.c_str());
+    return ShuffleRecords(spec,
+        new CachedInputSplit(split, spec.cache_file.c_str(), true, prefetch_mb << 20UL), part,
+        type);
   }
 #else
   CHECK(spec.cache_file.length() == 0) << "to enable cached file, compile with c++11";
-  return split;
+  return ShuffleRecords(spec, split, part, type);
 #endif
 }
 
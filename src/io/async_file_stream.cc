@@ -0,0 +1,344 @@
+// Copyright by Contributors
+#include "./async_file_stream.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+
+#ifndef _WIN32
+extern "C" {
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <sys/syscall.h>
+  #include <sys/uio.h>
+  #include <unistd.h>
+}
+  #if defined(__linux__) && defined(__has_include)
+    #if __has_include(<linux/io_uring.h>) && defined(__NR_io_uring_setup)
+      #include <linux/io_uring.h>
+      #define DMLC_IO_URING_PRESENT 1
+    #endif
+  #endif
+
+namespace dmlc {
+namespace io {
+#ifdef DMLC_IO_URING_PRESENT
+/*!
+ * \brief the rings shared with the kernel, used through the raw system calls
+ *  so that liburing is not needed. Reads are submitted and reaped by one thread.
+ */
+class IoUring {
+ public:
+  /*!
+   * \brief set up a ring for the reads into nblock buffers of block_size bytes
+   * \return the ring, NULL if io_uring is not supported by the kernel
+   */
+  static IoUring *Create(char *buffer, size_t nblock, size_t block_size) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(nblock), &params));
+    if (fd < 0) {
+      return NULL;
+    }
+    IoUring *ring = new IoUring();
+    ring->fd_ = fd;
+    ring->sq_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_len_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    ring->sqes_len_ = params.sq_entries * sizeof(io_uring_sqe);
+    ring->sq_ptr_ = Map(fd, ring->sq_len_, IORING_OFF_SQ_RING);
+    ring->cq_ptr_ = Map(fd, ring->cq_len_, IORING_OFF_CQ_RING);
+    ring->sqes_ = static_cast<io_uring_sqe *>(Map(fd, ring->sqes_len_, IORING_OFF_SQES));
+    if (ring->sq_ptr_ == NULL || ring->cq_ptr_ == NULL || ring->sqes_ == NULL) {
+      delete ring;
+      return NULL;
+    }
+    char *sq = static_cast<char *>(ring->sq_ptr_);
+    ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    ring->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    char *cq = static_cast<char *>(ring->cq_ptr_);
+    ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    ring->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    ring->cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    ring->iovecs_.resize(nblock);
+    for (size_t i = 0; i < nblock; ++i) {
+      ring->iovecs_[i].iov_base = buffer + i * block_size;
+      ring->iovecs_[i].iov_len = block_size;
+    }
+    // registered buffers are not mapped again by every read, but count
+    // against the locked memory limit, use plain reads if they do not fit
+    ring->fixed_ = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS,
+                       ring->iovecs_.data(), static_cast<unsigned>(nblock))
+                   == 0;
+    return ring;
+  }
+  ~IoUring(void) {
+    if (sqes_ != NULL) {
+      munmap(sqes_, sqes_len_);
+    }
+    if (cq_ptr_ != NULL) {
+      munmap(cq_ptr_, cq_len_);
+    }
+    if (sq_ptr_ != NULL) {
+      munmap(sq_ptr_, sq_len_);
+    }
+    close(fd_);
+  }
+  /*!
+   * \brief submit the read of a block
+   * \param fd the file
+   * \param index index of the block, whose buffer is the destination
+   * \param offset offset in the file
+   */
+  inline void SubmitRead(int fd, size_t index, size_t offset) {
+    const unsigned tail = *sq_tail_;
+    const unsigned slot = tail & *sq_mask_;
+    io_uring_sqe *sqe = &sqes_[slot];
+    std::memset(sqe, 0, sizeof(*sqe));
+    if (fixed_) {
+      sqe->opcode = IORING_OP_READ_FIXED;
+      sqe->addr = reinterpret_cast<uint64_t>(iovecs_[index].iov_base);
+      sqe->len = static_cast<uint32_t>(iovecs_[index].iov_len);
+      sqe->buf_index = static_cast<uint16_t>(index);
+    } else {
+      sqe->opcode = IORING_OP_READV;
+      sqe->addr = reinterpret_cast<uint64_t>(&iovecs_[index]);
+      sqe->len = 1;
+    }
+    sqe->fd = fd;
+    sqe->off = offset;
+    sqe->user_data = index;
+    sq_array_[slot] = slot;
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    while (syscall(__NR_io_uring_enter, fd_, 1, 0, 0, NULL, 0) < 0) {
+      CHECK_EQ(errno, EINTR) << "io_uring_enter: " << strerror(errno);
+    }
+  }
+  /*!
+   * \brief wait for the completion of a read
+   * \param out_index index of the block read
+   * \param out_res number of bytes read, or minus the error number
+   */
+  inline void WaitCompletion(size_t *out_index, int *out_res) {
+    while (true) {
+      const unsigned head = *cq_head_;
+      if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        const io_uring_cqe &cqe = cqes_[head & *cq_mask_];
+        *out_index = static_cast<size_t>(cqe.user_data);
+        *out_res = cqe.res;
+        __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+        return;
+      }
+      if (syscall(__NR_io_uring_enter, fd_, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0) {
+        CHECK_EQ(errno, EINTR) << "io_uring_enter: " << strerror(errno);
+      }
+    }
+  }
+
+ private:
+  int fd_{-1};
+  void *sq_ptr_{NULL};
+  size_t sq_len_{0};
+  void *cq_ptr_{NULL};
+  size_t cq_len_{0};
+  io_uring_sqe *sqes_{NULL};
+  size_t sqes_len_{0};
+  unsigned *sq_tail_{NULL};
+  unsigned *sq_mask_{NULL};
+  unsigned *sq_array_{NULL};
+  unsigned *cq_head_{NULL};
+  unsigned *cq_tail_{NULL};
+  unsigned *cq_mask_{NULL};
+  io_uring_cqe *cqes_{NULL};
+  /*! \brief the buffers of the blocks */
+  std::vector<iovec> iovecs_;
+  /*! \brief whether the buffers are registered */
+  bool fixed_{false};
+  IoUring(void) {}
+  inline static void *Map(int fd, size_t size, off_t offset) {
+    void *ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return ptr == MAP_FAILED ? NULL : ptr;
+  }
+};
+#else
+/*! \brief io_uring is not available, the reads are done with pread */
+class IoUring {
+ public:
+  static IoUring *Create(char * /*buffer*/, size_t /*nblock*/, size_t /*block_size*/) {
+    return NULL;
+  }
+  inline void SubmitRead(int /*fd*/, size_t /*index*/, size_t /*offset*/) {}
+  inline void WaitCompletion(size_t * /*out_index*/, int * /*out_res*/) {}
+};
+#endif  // DMLC_IO_URING_PRESENT
+
+AsyncFileStream::AsyncFileStream(const std::string &path, size_t depth, bool direct)
+    : path_(path),
+      fd_(-1),
+      file_size_(0),
+      buffer_(NULL),
+      started_(false),
+      head_(0),
+      head_pos_(0),
+      next_offset_(0),
+      pos_(0) {
+#ifdef O_DIRECT
+  if (direct) {
+    fd_ = open(path.c_str(), O_RDONLY | O_DIRECT);
+    // e.g. tmpfs does not support direct I/O, read through the page cache
+    if (fd_ == -1 && errno == EINVAL) {
+      LOG(INFO) << "AsyncFileStream: O_DIRECT is not supported for " << path;
+    }
+  }
+#endif  // O_DIRECT
+  if (fd_ == -1) {
+    fd_ = open(path.c_str(), O_RDONLY);
+  }
+  CHECK(fd_ != -1) << "AsyncFileStream: fail to open " << path << ", error: " << strerror(errno);
+  struct stat sb;
+  CHECK_EQ(fstat(fd_, &sb), 0) << "AsyncFileStream: fail to stat " << path;
+  file_size_ = static_cast<size_t>(sb.st_size);
+  depth = std::max<size_t>(depth, 1);
+  // O_DIRECT needs buffers aligned to the logical block size of the device
+  void *buffer = NULL;
+  CHECK_EQ(posix_memalign(&buffer, 4096, depth * kBlockSize), 0)
+      << "AsyncFileStream: fail to allocate " << depth << " blocks";
+  buffer_ = static_cast<char *>(buffer);
+  blocks_.resize(depth);
+  for (size_t i = 0; i < depth; ++i) {
+    blocks_[i].data = buffer_ + i * kBlockSize;
+    blocks_[i].offset = blocks_[i].size = 0;
+    blocks_[i].pending = blocks_[i].submitted = false;
+  }
+  if (GetEnv("DMLC_IO_URING", true)) {
+    ring_.reset(IoUring::Create(buffer_, depth, kBlockSize));
+  }
+}
+
+AsyncFileStream::~AsyncFileStream(void) {
+  // the kernel may still write into the buffers
+  this->Drain();
+  ring_.reset();
+  close(fd_);
+  free(buffer_);
+}
+
+size_t AsyncFileStream::Read(void *ptr, size_t size) {
+  if (!started_) {
+    this->Start();
+  }
+  char *out = static_cast<char *>(ptr);
+  size_t nleft = size;
+  while (nleft != 0) {
+    this->Wait(head_);
+    const Block &b = blocks_[head_];
+    const size_t n = std::min(b.size - std::min(head_pos_, b.size), nleft);
+    if (n == 0) {
+      // end of file
+      break;
+    }
+    std::memcpy(out, b.data + head_pos_, n);
+    head_pos_ += n;
+    pos_ += n;
+    out += n;
+    nleft -= n;
+    if (head_pos_ == kBlockSize) {
+      // the block is consumed, read the one after the last block in flight
+      this->Issue(head_);
+      head_ = (head_ + 1) % blocks_.size();
+      head_pos_ = 0;
+    }
+  }
+  return size - nleft;
+}
+
+size_t AsyncFileStream::Write(const void * /*ptr*/, size_t /*size*/) {
+  LOG(FATAL) << "AsyncFileStream: " << path_ << " is opened for read only";
+  return 0;
+}
+
+void AsyncFileStream::Seek(size_t pos) {
+  if (started_ && pos == pos_) {
+    return;
+  }
+  this->Drain();
+  pos_ = pos;
+}
+
+size_t AsyncFileStream::Tell(void) {
+  return pos_;
+}
+
+void AsyncFileStream::Start(void) {
+  const size_t begin = pos_ / kBlockSize * kBlockSize;
+  next_offset_ = begin;
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    this->Issue(i);
+  }
+  head_ = 0;
+  head_pos_ = pos_ - begin;
+  started_ = true;
+}
+
+void AsyncFileStream::Issue(size_t index) {
+  Block &b = blocks_[index];
+  b.offset = next_offset_;
+  b.size = 0;
+  b.submitted = false;
+  next_offset_ += kBlockSize;
+  b.pending = b.offset < file_size_;
+  if (b.pending && ring_ != nullptr) {
+    ring_->SubmitRead(fd_, index, b.offset);
+    b.submitted = true;
+  }
+}
+
+void AsyncFileStream::Wait(size_t index) {
+  while (blocks_[index].pending) {
+    if (!blocks_[index].submitted) {
+      this->Complete(index, 0);
+      continue;
+    }
+    size_t done;
+    int res;
+    ring_->WaitCompletion(&done, &res);
+    CHECK_GE(res, 0) << "AsyncFileStream: fail to read " << path_ << ", error: " << strerror(-res);
+    this->Complete(done, static_cast<size_t>(res));
+  }
+}
+
+void AsyncFileStream::Complete(size_t index, size_t nread) {
+  Block &b = blocks_[index];
+  const size_t expect = std::min(kBlockSize, file_size_ - b.offset);
+  // finish short reads, reads of whole blocks also keep O_DIRECT aligned at the end of file
+  while (nread < expect) {
+    const ssize_t n = pread(fd_, b.data + nread, kBlockSize - nread, b.offset + nread);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    CHECK_GT(n, 0) << "AsyncFileStream: fail to read " << path_ << " at " << b.offset + nread
+                   << ", error: " << (n == 0 ? "unexpected end of file" : strerror(errno));
+    nread += static_cast<size_t>(n);
+  }
+  b.size = expect;
+  b.pending = b.submitted = false;
+}
+
+void AsyncFileStream::Drain(void) {
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    if (blocks_[i].submitted) {
+      this->Wait(i);
+    }
+    blocks_[i].pending = false;
+  }
+  started_ = false;
+}
+}  // namespace io
+}  // namespace dmlc
+#endif  // _WIN32
@@ -0,0 +1,97 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file async_file_stream.h
+ * \brief read-only stream of a local file with several reads in flight
+ */
+#ifndef DMLC_IO_ASYNC_FILE_STREAM_H_
+#define DMLC_IO_ASYNC_FILE_STREAM_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dmlc/io.h>
+
+namespace dmlc {
+namespace io {
+/*! \brief submission and completion queues of the kernel, defined in the .cc */
+class IoUring;
+/*!
+ * \brief read-only stream of a local file that keeps several aligned blocks
+ *  read ahead of the position. The reads are submitted through io_uring into
+ *  buffers registered to the kernel, and done with pread, one block at a time,
+ *  where io_uring is not available or DMLC_IO_URING=0. The file can be opened
+ *  with O_DIRECT to bypass the page cache, for files that are scanned once.
+ */
+class AsyncFileStream : public SeekStream {
+ public:
+  /*! \brief size of a block, a multiple of the alignment required by O_DIRECT */
+  static const size_t kBlockSize = 1UL << 20UL;
+  /*!
+   * \brief open a file
+   * \param path the local path of the file
+   * \param depth number of blocks read ahead
+   * \param direct whether to bypass the page cache, ignored if the
+   *   filesystem does not support it
+   */
+  AsyncFileStream(const std::string &path, size_t depth, bool direct);
+  virtual ~AsyncFileStream(void);
+  virtual size_t Read(void *ptr, size_t size);
+  virtual size_t Write(const void *ptr, size_t size);
+  virtual void Seek(size_t pos);
+  virtual size_t Tell(void);
+  /*! \return whether the reads go through io_uring */
+  inline bool use_uring(void) const {
+    return ring_ != nullptr;
+  }
+
+ private:
+  /*! \brief a block of the file */
+  struct Block {
+    /*! \brief the buffer, kBlockSize bytes */
+    char *data;
+    /*! \brief offset of the block in the file */
+    size_t offset;
+    /*! \brief number of bytes read */
+    size_t size;
+    /*! \brief whether the read is not done yet */
+    bool pending;
+    /*! \brief whether the read was submitted to the ring */
+    bool submitted;
+  };
+  /*! \brief the path of the file */
+  std::string path_;
+  /*! \brief the file descriptor */
+  int fd_;
+  /*! \brief size of the file */
+  size_t file_size_;
+  /*! \brief the buffers of all the blocks */
+  char *buffer_;
+  /*! \brief the blocks, consumed in circular order */
+  std::vector<Block> blocks_;
+  /*! \brief the ring, NULL if pread is used */
+  std::unique_ptr<IoUring> ring_;
+  /*! \brief whether the blocks are read for the current position */
+  bool started_;
+  /*! \brief index of the block being consumed */
+  size_t head_;
+  /*! \brief position in the block being consumed */
+  size_t head_pos_;
+  /*! \brief offset of the next block to read */
+  size_t next_offset_;
+  /*! \brief position of the stream */
+  size_t pos_;
+  // start reading the blocks from pos_
+  void Start(void);
+  // read the next block of the file into blocks_[index]
+  void Issue(size_t index);
+  // wait until the read of blocks_[index] is done
+  void Wait(size_t index);
+  // finish the read of a block of which nread bytes were read
+  void Complete(size_t index, size_t nread);
+  // wait for all the reads in flight
+  void Drain(void);
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_ASYNC_FILE_STREAM_H_
@@ -0,0 +1,119 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file cache_header.h
+ * \brief header of local cache files, records a fingerprint
+ *  of the source so that stale caches can be detected and rebuilt
+ */
+#ifndef DMLC_IO_CACHE_HEADER_H_
+#define DMLC_IO_CACHE_HEADER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+
+namespace dmlc {
+namespace io {
+/*!
+ * \brief header written at the beginning of a cache file.
+ *  The fingerprint is a 64-bit FNV-1a hash over the path, size,
+ *  modification time and ETag of every source file, plus any
+ *  argument that changes the content of the cache.
+ *  A cache is only reused when the stored fingerprint matches.
+ */
+class CacheHeader {
+ public:
+  /*! \brief magic number identifying the cache format */
+  static const uint64_t kMagic = 0x444d4c4343414331ULL;
+  CacheHeader(void) : fingerprint_(kOffsetBasis) {}
+  /*! \return the fingerprint accumulated so far */
+  inline uint64_t fingerprint(void) const {
+    return fingerprint_;
+  }
+  /*!
+   * \brief add a string to the fingerprint
+   * \param str the string to be added
+   */
+  inline void Add(const std::string &str) {
+    uint64_t len = str.length();
+    this->AddBytes(&len, sizeof(len));
+    this->AddBytes(str.c_str(), str.length());
+  }
+  /*!
+   * \brief add an integer to the fingerprint
+   * \param value the value to be added
+   */
+  inline void Add(uint64_t value) {
+    this->AddBytes(&value, sizeof(value));
+  }
+  /*!
+   * \brief add information of the source files to the fingerprint
+   * \param files the list of source files
+   */
+  inline void Add(const std::vector<FileInfo> &files) {
+    this->Add(static_cast<uint64_t>(files.size()));
+    for (const FileInfo &info : files) {
+      this->Add(info.path.str());
+      this->Add(static_cast<uint64_t>(info.size));
+      this->Add(info.mtime);
+      this->Add(info.etag);
+    }
+  }
+  /*!
+   * \brief add arguments to the fingerprint
+   * \param args the key-value arguments, ordered by key
+   */
+  inline void Add(const std::map<std::string, std::string> &args) {
+    this->Add(static_cast<uint64_t>(args.size()));
+    for (const auto &kv : args) {
+      this->Add(kv.first);
+      this->Add(kv.second);
+    }
+  }
+  /*!
+   * \brief write the header into the stream
+   * \param fo output stream
+   */
+  inline void Save(Stream *fo) const {
+    uint64_t magic = kMagic;
+    fo->Write(magic);
+    fo->Write(fingerprint_);
+  }
+  /*!
+   * \brief read a header from the stream and compare it with this one
+   * \param fi input stream, positioned at the beginning of the cache
+   * \return true if the stream carries the same fingerprint,
+   *   false if it is stale, truncated or of an older format
+   */
+  inline bool Match(Stream *fi) const {
+    uint64_t magic, fingerprint;
+    if (!fi->Read(&magic) || magic != kMagic) {
+      return false;
+    }
+    if (!fi->Read(&fingerprint)) {
+      return false;
+    }
+    return fingerprint == fingerprint_;
+  }
+
+ private:
+  /*! \brief FNV-1a offset basis */
+  static const uint64_t kOffsetBasis = 0xcbf29ce484222325ULL;
+  /*! \brief FNV-1a prime */
+  static const uint64_t kPrime = 0x100000001b3ULL;
+  /*! \brief current fingerprint */
+  uint64_t fingerprint_;
+  // hash raw bytes into the fingerprint
+  inline void AddBytes(const void *ptr, size_t size) {
+    const unsigned char *p = static_cast<const unsigned char *>(ptr);
+    for (size_t i = 0; i < size; ++i) {
+      fingerprint_ ^= p[i];
+      fingerprint_ *= kPrime;
+    }
+  }
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_CACHE_HEADER_H_
@@ -14,10 +14,12 @@
 
 #if DMLC_ENABLE_STD_THREAD
   #include <algorithm>
+  #include <cstring>
   #include <string>
 
   #include <dmlc/threadediter.h>
 
+  #include "./cache_header.h"
   #include "./input_split_base.h"
 
 namespace dmlc {
@@ -33,16 +35,24 @@ class CachedInputSplit : public InputSplit {
    * \brief constructor
    * \param base source input split
    * \param cache_file the path to cache file
-   * \param reuse_exist_cache whether reuse existing cache file, if any
+   * \param reuse_exist_cache whether reuse existing cache file, if any,
+   *  an existing cache is only reused when it was built from the same source files
+   * \param prefetch_bytes memory budget of the prefetched chunks,
+   *  0 for a fixed number of chunks read ahead
    */
-  CachedInputSplit(InputSplitBase *base, const char *cache_file, bool reuse_exist_cache = true)
+  CachedInputSplit(InputSplitBase *base, const char *cache_file, bool reuse_exist_cache = true,
+      size_t prefetch_bytes = 0)
       : buffer_size_(InputSplitBase::kBufferSize),
         cache_file_(cache_file),
         fo_(NULL),
         fi_(NULL),
         base_(base),
         tmp_chunk_(NULL),
-        iter_preproc_(NULL) {
+        iter_preproc_(NULL),
+        data_begin_(0),
+        prefetch_bytes_(prefetch_bytes) {
+    header_.Add(base->files());
+    header_.Add(static_cast<uint64_t>(base->IsTextParser()));
     if (reuse_exist_cache) {
       if (!this->InitCachedIter()) {
         this->InitPreprocIter();
@@ -94,6 +104,13 @@ class CachedInputSplit : public InputSplit {
   virtual size_t GetTotalSize(void) {
     return base_->GetTotalSize();
   }
+  virtual bool GetNumRecords(size_t *out_num_records) {
+    return base_->GetNumRecords(out_num_records);
+  }
+  virtual bool GetPrefetchStats(PrefetchStats *out) {
+    *out = iter_preproc_ != NULL ? iter_preproc_->GetStats() : iter_cached_.GetStats();
+    return true;
+  }
   // implement next record
   virtual bool NextRecord(Blob *out_rec) {
     auto *iter = iter_preproc_ != NULL ? iter_preproc_ : &iter_cached_;
@@ -144,6 +161,16 @@ class CachedInputSplit : public InputSplit {
   ThreadedIter<InputSplitBase::Chunk> *iter_preproc_;
   /*! \brief backend thread iterator for cache */
   ThreadedIter<InputSplitBase::Chunk> iter_cached_;
+  /*! \brief header identifying the source of the cache */
+  CacheHeader header_;
+  /*! \brief position of the first chunk in the cache file */
+  size_t data_begin_;
+  /*! \brief memory budget of the prefetched chunks */
+  size_t prefetch_bytes_;
+  /*! \return bytes held by a chunk */
+  inline static size_t ChunkBytes(const InputSplitBase::Chunk &chunk) {
+    return chunk.data.capacity();
+  }
   /*! \brief initialize the cached iterator */
   inline void InitPreprocIter(void);
   /*!
@@ -156,8 +183,10 @@ class CachedInputSplit : public InputSplit {
 
 inline void CachedInputSplit::InitPreprocIter(void) {
   fo_ = dmlc::Stream::Create(cache_file_.c_str(), "w");
+  header_.Save(fo_);
   iter_preproc_ = new ThreadedIter<InputSplitBase::Chunk>();
   iter_preproc_->set_max_capacity(16);
+  iter_preproc_->set_max_bytes(prefetch_bytes_, ChunkBytes);
   iter_preproc_->Init([this](InputSplitBase::Chunk **dptr) {
     if (*dptr == NULL) {
       *dptr = new InputSplitBase::Chunk(buffer_size_);
@@ -179,6 +208,14 @@ inline bool CachedInputSplit::InitCachedIter(void) {
   if (fi_ == NULL) {
     return false;
   }
+  if (!header_.Match(fi_)) {
+    LOG(INFO) << "cache file " << cache_file_ << " does not match the source, rebuilding";
+    delete fi_;
+    fi_ = NULL;
+    return false;
+  }
+  data_begin_ = fi_->Tell();
+  iter_cached_.set_max_bytes(prefetch_bytes_, ChunkBytes);
   iter_cached_.Init(
       [this](InputSplitBase::Chunk **dptr) {
         if (*dptr == NULL) {
@@ -192,13 +229,15 @@ inline bool CachedInputSplit::InitCachedIter(void) {
           return false;
         }
         CHECK(nread == sizeof(size)) << cache_file_ << " has invalid cache file format";
-        p->data.resize(size / sizeof(size_t) + 1);
-        p->begin = reinterpret_cast<char *>(BeginPtr(p->data));
+        p->data.Reserve(size + sizeof(uint32_t), 0);
+        p->begin = p->data.data();
         p->end = p->begin + size;
+        // set back to 0 for string safety
+        std::memset(p->end, 0, sizeof(uint32_t));
         CHECK(fi_->Read(p->begin, size) == size) << cache_file_ << " has invalid cache file format";
         return true;
       },
-      [this]() { fi_->Seek(0); });
+      [this]() { fi_->Seek(data_begin_); });
   return true;
 }
 }  // namespace io
@@ -0,0 +1,188 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file chunk_buffer.h
+ * \brief uninitialized, aligned and pooled storage of the chunks of input splits
+ */
+#ifndef DMLC_IO_CHUNK_BUFFER_H_
+#define DMLC_IO_CHUNK_BUFFER_H_
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+
+#ifndef _WIN32
+extern "C" {
+  #include <sys/mman.h>
+}
+#else  // _WIN32
+  #include <malloc.h>
+#endif  // _WIN32
+
+namespace dmlc {
+namespace io {
+/*!
+ * \brief process wide pool of the chunk buffers.
+ *  Freed buffers are kept to be reused by the next chunks, so the prefetch
+ *  threads of the input splits do not pay for fresh pages every chunk.
+ *  Buffers are 64 bytes aligned. With DMLC_IO_HUGEPAGE=1, the buffers of at
+ *  least 2 MB are aligned to 2 MB and backed by transparent huge pages.
+ */
+class ChunkBufferPool {
+ public:
+  /*! \brief alignment of the buffers */
+  static const size_t kAlign = 64;
+  /*! \brief size and alignment of a huge page */
+  static const size_t kHugePage = 2UL << 20UL;
+  /*! \brief maximum bytes of free buffers kept in the pool */
+  static const size_t kMaxFreeBytes = 128UL << 20UL;
+  /*!
+   * \brief get a buffer, the content is not initialized
+   * \param size the minimum size of the buffer in bytes
+   * \param out_capacity the actual size of the buffer
+   * \return the buffer
+   */
+  inline void *Allocate(size_t size, size_t *out_capacity) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      // reuse a free buffer unless it wastes more than half of it
+      auto it = free_.lower_bound(size);
+      if (it != free_.end() && it->first / 2 <= size) {
+        void *ret = it->second;
+        *out_capacity = it->first;
+        free_bytes_ -= it->first;
+        free_.erase(it);
+        return ret;
+      }
+    }
+    const bool huge = use_hugepage_ && size >= kHugePage;
+    const size_t align = huge ? kHugePage : kAlign;
+    size = (size + align - 1) / align * align;
+    void *ret = NULL;
+#ifndef _WIN32
+    CHECK_EQ(posix_memalign(&ret, align, size), 0) << "fail to allocate " << size << " bytes";
+  #ifdef MADV_HUGEPAGE
+    if (huge) {
+      madvise(ret, size, MADV_HUGEPAGE);
+    }
+  #endif  // MADV_HUGEPAGE
+#else
+    ret = _aligned_malloc(size, align);
+    CHECK(ret != NULL) << "fail to allocate " << size << " bytes";
+#endif  // _WIN32
+    *out_capacity = size;
+    return ret;
+  }
+  /*!
+   * \brief return a buffer to the pool
+   * \param ptr the buffer
+   * \param capacity the size of the buffer
+   */
+  inline void Release(void *ptr, size_t capacity) {
+    if (ptr == NULL) {
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (free_bytes_ + capacity <= kMaxFreeBytes) {
+        free_.insert(std::make_pair(capacity, ptr));
+        free_bytes_ += capacity;
+        return;
+      }
+    }
+    Free(ptr);
+  }
+  /*! \return the pool shared by all the input splits */
+  inline static ChunkBufferPool *Get(void) {
+    // never destructed, the chunks of static input splits can outlive it
+    static ChunkBufferPool *inst = new ChunkBufferPool();
+    return inst;
+  }
+
+ private:
+  /*! \brief whether the large buffers use huge pages */
+  bool use_hugepage_;
+  /*! \brief protects the free buffers */
+  std::mutex mutex_;
+  /*! \brief free buffers by capacity */
+  std::multimap<size_t, void *> free_;
+  /*! \brief total capacity of the free buffers */
+  size_t free_bytes_;
+  ChunkBufferPool(void) : use_hugepage_(GetEnv("DMLC_IO_HUGEPAGE", false)), free_bytes_(0) {}
+  inline static void Free(void *ptr) {
+#ifndef _WIN32
+    free(ptr);
+#else
+    _aligned_free(ptr);
+#endif  // _WIN32
+  }
+};
+
+/*!
+ * \brief growable byte buffer from ChunkBufferPool,
+ *  unlike std::vector it never initializes its content
+ */
+class ChunkBuffer {
+ public:
+  ChunkBuffer(void) : data_(NULL), capacity_(0) {}
+  /*!
+   * \brief constructor
+   * \param size initial size in bytes
+   */
+  explicit ChunkBuffer(size_t size) : data_(NULL), capacity_(0) {
+    this->Reserve(size, 0);
+  }
+  ~ChunkBuffer(void) {
+    ChunkBufferPool::Get()->Release(data_, capacity_);
+  }
+  /*!
+   * \brief make sure the buffer holds at least size bytes
+   * \param size the size in bytes
+   * \param keep number of bytes at the beginning whose content is kept
+   *   when the buffer grows, the rest is undefined
+   */
+  inline void Reserve(size_t size, size_t keep) {
+    if (size <= capacity_) {
+      return;
+    }
+    size_t capacity;
+    char *data = static_cast<char *>(ChunkBufferPool::Get()->Allocate(size, &capacity));
+    if (keep != 0) {
+      std::memcpy(data, data_, std::min(keep, capacity_));
+    }
+    ChunkBufferPool::Get()->Release(data_, capacity_);
+    data_ = data;
+    capacity_ = capacity;
+  }
+  /*! \brief return the memory to the pool */
+  inline void Clear(void) {
+    ChunkBufferPool::Get()->Release(data_, capacity_);
+    data_ = NULL;
+    capacity_ = 0;
+  }
+  /*! \return beginning of the buffer */
+  inline char *data(void) const {
+    return data_;
+  }
+  /*! \return size of the buffer in bytes */
+  inline size_t capacity(void) const {
+    return capacity_;
+  }
+
+ private:
+  /*! \brief beginning of the buffer */
+  char *data_;
+  /*! \brief size of the buffer */
+  size_t capacity_;
+  // the buffer can not be copied
+  ChunkBuffer(const ChunkBuffer &other);
+  ChunkBuffer &operator=(const ChunkBuffer &other);
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_CHUNK_BUFFER_H_
@@ -141,6 +141,7 @@ void HDFSFileSystem::ResetNamenode(const std::string &namenode) {
 inline FileInfo ConvertPathInfo(const URI &path, const hdfsFileInfo &info) {
   FileInfo ret;
   ret.size = info.mSize;
+  ret.mtime = static_cast<uint64_t>(info.mLastMod) * 1000000000ULL;
   switch (info.mKind) {
   case 'D':
     ret.type = kDirectory;
@@ -3,7 +3,9 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 
+#include <dmlc/common.h>
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
 #include <dmlc/recordio.h>
@@ -64,27 +66,19 @@ void IndexedRecordIOSplitter::ReadIndexFile(FileSystem *fs, const std::string &i
   }
 }
 
-// Inefficient, but not used anywhere and optimization
-// would require change of the API, so I leave it as is
-size_t IndexedRecordIOSplitter::SeekRecordBegin(Stream *fi) {
-  size_t nstep = 0;
-  uint32_t v, lrec;
-  while (true) {
-    if (fi->Read(&v, sizeof(v)) == 0) {
-      return nstep;
-    }
-    nstep += sizeof(v);
-    if (v == RecordIOWriter::kMagic) {
-      CHECK(fi->Read(&lrec, sizeof(lrec)) != 0) << "invalid record io format";
-      nstep += sizeof(lrec);
-      uint32_t cflag = RecordIOWriter::DecodeFlag(lrec);
+const char *IndexedRecordIOSplitter::FindFirstRecordBegin(const char *begin, const char *end) {
+  CHECK_EQ((reinterpret_cast<size_t>(begin) & 3UL), 0U);
+  const uint32_t *p = reinterpret_cast<const uint32_t *>(begin);
+  const uint32_t *pend = p + (end - begin) / sizeof(uint32_t);
+  for (; p + 1 < pend; ++p) {
+    if (p[0] == RecordIOWriter::kMagic) {
+      uint32_t cflag = RecordIOWriter::DecodeFlag(p[1]);
       if (cflag == 0 || cflag == 1) {
-        break;
+        return reinterpret_cast<const char *>(p);
       }
     }
   }
-  // should point at head of record
-  return nstep - 2 * sizeof(uint32_t);
+  return NULL;
 }
 
 // Inefficient, but not used anywhere and optimization
@@ -149,6 +143,23 @@ bool IndexedRecordIOSplitter::ExtractNextRecord(Blob *out_rec, Chunk *chunk) {
 }
 
 bool IndexedRecordIOSplitter::ReadChunk(void *buf, size_t *size) {
+  if (shuffle_) {
+    char *out = reinterpret_cast<char *>(buf);
+    size_t nread = 0;
+    for (; batch_next_ < batch_records_.size() && nread < *size; ++batch_next_) {
+      const std::pair<size_t, size_t> &rec = batch_records_[batch_next_];
+      const size_t n = std::min(rec.second - batch_pos_, *size - nread);
+      std::memcpy(out + nread, batch_data_.data() + rec.first + batch_pos_, n);
+      nread += n;
+      batch_pos_ += n;
+      if (batch_pos_ != rec.second) {
+        break;
+      }
+      batch_pos_ = 0;
+    }
+    *size = nread;
+    return nread != 0;
+  }
   size_t max_size = *size;
   size_t nread = this->Read(reinterpret_cast<char *>(buf), max_size);
   if (nread == 0) {
@@ -166,43 +177,20 @@ bool IndexedRecordIOSplitter::NextChunk(Blob *out_chunk) {
 
 bool IndexedRecordIOSplitter::NextBatchEx(Chunk *chunk, size_t n_records) {
   if (shuffle_) {
-    bool ret = true;
-    size_t n_read = 0;
-    size_t n = n_overflow_ == 0 ? n_records : n_overflow_;
-    while (n_read < n) {
-      if (current_index_ < permutation_.size()) {
-        offset_curr_ = index_[permutation_[current_index_]].first;
-        buffer_size_ = index_[permutation_[current_index_]].second / sizeof(uint32_t);
-        size_t new_file_ptr
-            = std::upper_bound(file_offset_.begin(), file_offset_.end(), offset_curr_)
-              - file_offset_.begin() - 1;
-        if (new_file_ptr != file_ptr_) {
-          delete fs_;
-          file_ptr_ = new_file_ptr;
-          fs_ = filesys_->OpenForRead(files_[file_ptr_].path);
-        }
-        fs_->Seek(offset_curr_ - file_offset_[file_ptr_]);
-        if (n_read == 0) {
-          ret = ret && chunk->Load(this, buffer_size_);
-        } else {
-          ret = ret && chunk->Append(this, buffer_size_);
-        }
-        if (ret) {
-          ++n_read;
-          ++current_index_;
-        } else {
-          break;
-        }
-      } else {
-        break;
-      }
-    }
-    if (n_read > 0) {
-      n_overflow_ = n - n_read;
-      return true;
-    } else {
+    const size_t n = n_overflow_ == 0 ? n_records : n_overflow_;
+    const size_t last = std::min(current_index_ + n, permutation_.size());
+    if (last == current_index_) {
       return false;
     }
+    n_overflow_ = n - (last - current_index_);
+    this->ReadBatch(current_index_, last);
+    current_index_ = last;
+    size_t nbytes = 0;
+    for (const std::pair<size_t, size_t> &rec : batch_records_) {
+      nbytes += rec.second;
+    }
+    // ReadChunk copies the records in the order of the permutation
+    return chunk->Load(this, nbytes / sizeof(uint32_t));
   } else {
     size_t last;
     if (n_overflow_ == 0) {
@@ -219,6 +207,83 @@ bool IndexedRecordIOSplitter::NextBatchEx(Chunk *chunk, size_t n_records) {
   return true;
 }
 
+void IndexedRecordIOSplitter::ReadBatch(size_t begin, size_t end) {
+  // the records of the batch by offset
+  std::vector<size_t> order;
+  for (size_t i = begin; i < end; ++i) {
+    order.push_back(permutation_[i]);
+  }
+  std::sort(order.begin(), order.end());
+  // merge the records into ranges of a file, with their position in batch_data_
+  struct Range {
+    size_t file;
+    size_t begin;
+    size_t end;
+    size_t pos;
+  };
+  std::vector<Range> ranges;
+  std::vector<size_t> record_pos(order.size());
+  size_t nbytes = 0;
+  for (size_t k = 0; k < order.size(); ++k) {
+    const size_t offset = index_[order[k]].first;
+    const size_t size = index_[order[k]].second;
+    const size_t file = std::upper_bound(file_offset_.begin(), file_offset_.end(), offset)
+                        - file_offset_.begin() - 1;
+    if (ranges.size() == 0 || ranges.back().file != file
+        || offset > ranges.back().end + kMaxGap) {
+      Range range;
+      range.file = file;
+      range.begin = offset;
+      range.end = offset;
+      range.pos = nbytes;
+      ranges.push_back(range);
+    }
+    Range &range = ranges.back();
+    record_pos[k] = range.pos + (offset - range.begin);
+    nbytes += std::max(range.end, offset + size) - range.end;
+    range.end = std::max(range.end, offset + size);
+  }
+  batch_data_.Reserve(nbytes, 0);
+  // read the ranges, a single thread reuses the stream of the split
+  auto read_range = [this](SeekStream *fi, const Range &range) {
+    fi->Seek(range.begin - file_offset_[range.file]);
+    size_t nread = 0;
+    while (nread < range.end - range.begin) {
+      const size_t n = fi->Read(batch_data_.data() + range.pos + nread,
+          range.end - range.begin - nread);
+      CHECK_NE(n, 0U) << "unexpected end of file " << files_[range.file].path.str();
+      nread += n;
+    }
+  };
+  if (read_threads_ <= 1) {
+    for (const Range &range : ranges) {
+      if (range.file != file_ptr_) {
+        delete fs_;
+        file_ptr_ = range.file;
+        fs_ = filesys_->OpenForRead(files_[file_ptr_].path);
+      }
+      read_range(fs_, range);
+    }
+  } else {
+    ParallelFor(ranges.size(), read_threads_, [&](int, size_t rbegin, size_t rend) {
+      std::unique_ptr<SeekStream> fi;
+      for (size_t i = rbegin; i < rend; ++i) {
+        if (i == rbegin || ranges[i].file != ranges[i - 1].file) {
+          fi.reset(filesys_->OpenForRead(files_[ranges[i].file].path));
+        }
+        read_range(fi.get(), ranges[i]);
+      }
+    });
+  }
+  // the records in the order of the permutation
+  batch_records_.clear();
+  for (size_t i = begin; i < end; ++i) {
+    const size_t k = std::lower_bound(order.begin(), order.end(), permutation_[i]) - order.begin();
+    batch_records_.push_back(std::make_pair(record_pos[k], index_[permutation_[i]].second));
+  }
+  batch_next_ = batch_pos_ = 0;
+}
+
 bool IndexedRecordIOSplitter::NextBatch(Blob *out_chunk, size_t batch_size) {
   while (!ExtractNextChunk(out_chunk, &tmp_chunk_)) {
     if (!NextBatchEx(&tmp_chunk_, batch_size)) {
@@ -25,13 +25,14 @@ const unsigned INDEXED_RECORDIO_ALIGN = 4;
 class IndexedRecordIOSplitter : public InputSplitBase {
  public:
   IndexedRecordIOSplitter(FileSystem *fs, const char *uri, const char *index_uri, unsigned rank,
-      unsigned nsplit, const size_t batch_size, const bool shuffle, const int seed = 0) {
+      unsigned nsplit, const size_t batch_size, const bool shuffle, const int seed = 0,
+      const std::string &manifest = "") {
     this->shuffle_ = shuffle;
     if (shuffle) {
       SetRandomSeed(seed);
     }
     this->batch_size_ = batch_size;
-    this->Init(fs, uri, INDEXED_RECORDIO_ALIGN);
+    this->Init(fs, uri, INDEXED_RECORDIO_ALIGN, false, manifest);
     this->ReadIndexFile(fs, index_uri);
     this->ResetPartition(rank, nsplit);
   }
@@ -46,6 +47,13 @@ class IndexedRecordIOSplitter : public InputSplitBase {
   bool NextBatch(Blob *out_chunk, size_t n_records) override;
   bool NextRecord(Blob *out_rec) override {
     while (!ExtractNextRecord(out_rec, &tmp_chunk_)) {
+      if (shuffle_) {
+        // the shuffled batches are only read by NextBatchEx
+        if (!NextBatchEx(&tmp_chunk_, batch_size_)) {
+          return false;
+        }
+        continue;
+      }
       if (!tmp_chunk_.Load(this, buffer_size_)) {
         return false;
       }
@@ -59,16 +67,32 @@ class IndexedRecordIOSplitter : public InputSplitBase {
   void SetBatchSize(int batch_size) {
     this->batch_size_ = batch_size;
   }
+  /*!
+   * \brief set the number of threads reading the ranges of a shuffled batch
+   * \param nthread number of threads, each opens its own streams
+   */
+  void SetReadThreads(int nthread) {
+    CHECK_GT(nthread, 0) << "number of reading threads must be positive";
+    this->read_threads_ = nthread;
+  }
   bool NextChunkEx(Chunk *out_chunk) override {
     return NextBatchEx(out_chunk, batch_size_);
   }
   bool NextBatchEx(Chunk *out_chunk, size_t n_records) override;
 
  protected:
-  size_t SeekRecordBegin(Stream *fi) override;
+  const char *FindFirstRecordBegin(const char *begin, const char *end) override;
   const char *FindLastRecordBegin(const char *begin, const char *end) override;
   virtual void ReadIndexFile(FileSystem *fs, const std::string &index_uri);
   void ResetPartition(unsigned rank, unsigned nsplit) override;
+  /*!
+   * \brief read the records of permutation_[begin, end) into batch_data_: the records
+   *  are sorted by offset, and the records less than kMaxGap bytes apart are read
+   *  together, by one positioned read per range, on read_threads_ threads
+   * \param begin the first index in permutation_
+   * \param end the end index in permutation_
+   */
+  void ReadBatch(size_t begin, size_t end);
 
   std::vector<std::pair<size_t, size_t>> index_;
   std::vector<size_t> permutation_;
@@ -80,6 +104,18 @@ class IndexedRecordIOSplitter : public InputSplitBase {
   size_t n_overflow_;
   const int kRandMagic = 111;
   std::mt19937 rnd_;
+  /*! \brief maximum distance between two records of a batch read together */
+  static const size_t kMaxGap = 64UL << 10UL;
+  /*! \brief number of threads reading a shuffled batch */
+  int read_threads_{1};
+  /*! \brief the ranges of the files holding the records of a shuffled batch */
+  ChunkBuffer batch_data_;
+  /*! \brief position in batch_data_ and size of the records, in the order of the batch */
+  std::vector<std::pair<size_t, size_t>> batch_records_;
+  /*! \brief the record of the batch copied next by ReadChunk */
+  size_t batch_next_{0};
+  /*! \brief bytes of that record already copied */
+  size_t batch_pos_{0};
 };
 }  // namespace io
 }  // namespace dmlc
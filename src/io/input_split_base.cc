@@ -1,9 +1,14 @@
 // Copyright by Contributors
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <sstream>
 
 #include <dmlc/common.h>
 #include <dmlc/logging.h>
 
+#include "./async_file_stream.h"
 #include "./line_split.h"
 
 #if DMLC_USE_REGEX
@@ -12,11 +17,12 @@
 
 namespace dmlc {
 namespace io {
-void InputSplitBase::Init(
-    FileSystem *filesys, const char *uri, size_t align_bytes, const bool recurse_directories) {
+void InputSplitBase::Init(FileSystem *filesys, const char *uri, size_t align_bytes,
+    const bool recurse_directories, const std::string &manifest, const bool whole_files) {
   this->filesys_ = filesys;
+  this->whole_files_ = whole_files;
   // initialize the path
-  this->InitInputFileInfo(uri, recurse_directories);
+  this->InitInputFileInfo(uri, recurse_directories, manifest);
   file_offset_.resize(files_.size() + 1);
   file_offset_[0] = 0;
   for (size_t i = 0; i < files_.size(); ++i) {
@@ -28,11 +34,24 @@ void InputSplitBase::Init(
 
 void InputSplitBase::ResetPartition(unsigned rank, unsigned nsplit) {
   size_t ntotal = file_offset_.back();
+  if (whole_files_) {
+    // the files beginning in the byte range of the partition, no record is split
+    const size_t begin = *std::lower_bound(
+        file_offset_.begin(), file_offset_.end(), ntotal * rank / nsplit);
+    const size_t end = *std::lower_bound(
+        file_offset_.begin(), file_offset_.end(), ntotal * (rank + 1) / nsplit);
+    this->SetPartition(begin, end, true);
+    return;
+  }
   size_t nstep = (ntotal + nsplit - 1) / nsplit;
   // align the nstep to 4 bytes
   nstep = ((nstep + align_bytes_ - 1) / align_bytes_) * align_bytes_;
-  offset_begin_ = std::min(nstep * rank, ntotal);
-  offset_end_ = std::min(nstep * (rank + 1), ntotal);
+  this->SetPartition(std::min(nstep * rank, ntotal), std::min(nstep * (rank + 1), ntotal), false);
+}
+
+void InputSplitBase::SetPartition(size_t begin, size_t end, bool exact) {
+  offset_begin_ = begin;
+  offset_end_ = end;
   offset_curr_ = offset_begin_;
   if (offset_begin_ == offset_end_) {
     return;
@@ -46,22 +65,55 @@ void InputSplitBase::ResetPartition(unsigned rank, unsigned nsplit) {
     fs_ = NULL;
   }
   // find the exact ending position
-  if (offset_end_ != file_offset_[file_ptr_end_]) {
+  if (!exact && offset_end_ != file_offset_[file_ptr_end_]) {
     CHECK(offset_end_ > file_offset_[file_ptr_end_]);
     CHECK(file_ptr_end_ < files_.size());
-    fs_ = filesys_->OpenForRead(files_[file_ptr_end_].path);
+    fs_ = this->OpenFile(file_ptr_end_);
     fs_->Seek(offset_end_ - file_offset_[file_ptr_end_]);
     offset_end_ += SeekRecordBegin(fs_);
-    delete fs_;
+    // the stream is reused for the beginning position when it is in the same file
+    if (file_ptr_end_ != file_ptr_) {
+      delete fs_;
+      fs_ = NULL;
+    }
   }
-  fs_ = filesys_->OpenForRead(files_[file_ptr_].path);
-  if (offset_begin_ != file_offset_[file_ptr_]) {
+  if (fs_ == NULL) {
+    fs_ = this->OpenFile(file_ptr_);
+  }
+  probe_.clear();
+  if (!exact && offset_begin_ != file_offset_[file_ptr_]) {
     fs_->Seek(offset_begin_ - file_offset_[file_ptr_]);
     offset_begin_ += SeekRecordBegin(fs_);
   }
   this->BeforeFirst();
 }
 
+void InputSplitBase::SeekOffset(size_t offset) {
+  CHECK(offset >= offset_begin_ && offset <= offset_end_) << "offset out of the partition";
+#if DMLC_ENABLE_STD_THREAD
+  CHECK(reader_ == NULL) << "seek is not supported with parallel read";
+#endif  // DMLC_ENABLE_STD_THREAD
+  this->BeforeFirst();
+  if (offset_begin_ >= offset_end_) {
+    return;
+  }
+  // the chunks of memory maps are found from offset_curr_
+  offset_curr_ = offset;
+  probe_pos_ = probe_.length();
+  size_t fp = std::upper_bound(file_offset_.begin(), file_offset_.end(), offset)
+              - file_offset_.begin() - 1;
+  if (fp >= files_.size()) {
+    // the end of the last file
+    fp = files_.size() - 1;
+  }
+  if (file_ptr_ != fp) {
+    delete fs_;
+    file_ptr_ = fp;
+    fs_ = this->OpenFile(file_ptr_);
+  }
+  fs_->Seek(offset - file_offset_[file_ptr_]);
+}
+
 void InputSplitBase::BeforeFirst(void) {
   if (offset_begin_ >= offset_end_) {
     return;
@@ -71,17 +123,134 @@ void InputSplitBase::BeforeFirst(void) {
   if (file_ptr_ != fp) {
     delete fs_;
     file_ptr_ = fp;
-    fs_ = filesys_->OpenForRead(files_[file_ptr_].path);
+    fs_ = this->OpenFile(file_ptr_);
   }
-  // seek to beginning of stream
-  fs_->Seek(offset_begin_ - file_offset_[file_ptr_]);
+  // seek to beginning of stream, the bytes read while looking for it are not read again
+  fs_->Seek(offset_begin_ + probe_.length() - file_offset_[file_ptr_]);
+  probe_pos_ = 0;
   offset_curr_ = offset_begin_;
   tmp_chunk_.begin = tmp_chunk_.end = NULL;
   // clear overflow buffer
   overflow_.clear();
+  tail_size_ = 0;
+  // the records were modified in place, map the files again
+  mmap_.reset();
+#if DMLC_ENABLE_STD_THREAD
+  if (reader_ != NULL) {
+    // the ranges of the partition, each within a file and of at most a chunk
+    const size_t nstep = buffer_size_ * sizeof(uint32_t);
+    std::vector<ParallelReader::Range> ranges;
+    for (size_t i = file_ptr_; i < files_.size() && file_offset_[i] < offset_end_; ++i) {
+      const size_t end = std::min(offset_end_, file_offset_[i + 1]) - file_offset_[i];
+      for (size_t begin = std::max(offset_begin_, file_offset_[i]) - file_offset_[i];
+           begin < end; begin += nstep) {
+        ParallelReader::Range range;
+        range.file = i;
+        range.begin = begin;
+        range.end = std::min(end, begin + nstep);
+        ranges.push_back(range);
+      }
+    }
+    reader_->Reset(ranges);
+  }
+#endif  // DMLC_ENABLE_STD_THREAD
+}
+
+void InputSplitBase::EnableParallelRead(int nthread) {
+#if DMLC_ENABLE_STD_THREAD
+  CHECK(!use_mmap_) << "parallel read can not be used with mmap";
+  CHECK_GT(nthread, 0) << "number of reading threads must be positive";
+  delete reader_;
+  // each thread can be a range ahead
+  reader_ = new ParallelReader(filesys_, files_, nthread, 2 * nthread);
+  this->BeforeFirst();
+#else
+  LOG(FATAL) << "to enable parallel read, compile with c++11";
+#endif  // DMLC_ENABLE_STD_THREAD
+}
+
+void InputSplitBase::EnableAsyncRead(size_t depth, bool direct) {
+#ifndef _WIN32
+  for (size_t i = 0; i < files_.size(); ++i) {
+    CHECK(files_[i].path.protocol == "file://" || files_[i].path.protocol.length() == 0)
+        << "async read is only supported by the local filesystem, got " << files_[i].path.str();
+  }
+  CHECK(!use_mmap_) << "async read can not be used with mmap";
+  CHECK_GT(depth, 0U) << "number of blocks read ahead must be positive";
+  async_depth_ = depth;
+  async_direct_ = direct;
+  if (fs_ != NULL) {
+    delete fs_;
+    fs_ = this->OpenFile(file_ptr_);
+  }
+  this->BeforeFirst();
+#else
+  LOG(FATAL) << "async read is not supported on Windows";
+#endif  // _WIN32
+}
+
+SeekStream *InputSplitBase::OpenFile(size_t index) {
+#ifndef _WIN32
+  if (async_depth_ != 0) {
+    return new AsyncFileStream(files_[index].path.name, async_depth_, async_direct_);
+  }
+#endif  // _WIN32
+  return filesys_->OpenForRead(files_[index].path);
+}
+
+void InputSplitBase::EnableMMap(void) {
+  for (size_t i = 0; i < files_.size(); ++i) {
+    CHECK(files_[i].path.protocol == "file://" || files_[i].path.protocol.length() == 0)
+        << "memory map is only supported by the local filesystem, got " << files_[i].path.str();
+  }
+  use_mmap_ = true;
+  // the chunks point into the mapping, the buffer is no longer used
+  tmp_chunk_.data.Clear();
+  this->BeforeFirst();
+}
+
+bool InputSplitBase::NextMappedChunk(Chunk *chunk) {
+  if (offset_curr_ >= offset_end_) {
+    return false;
+  }
+  size_t fp = std::upper_bound(file_offset_.begin(), file_offset_.end(), offset_curr_)
+              - file_offset_.begin() - 1;
+  if (mmap_ == nullptr || mmap_ptr_ != fp) {
+    mmap_.reset();
+    mmap_.reset(new MMapFile(files_[fp].path.name, files_[fp].size));
+    mmap_ptr_ = fp;
+    mmap_released_ = 0;
+  }
+  const size_t begin = offset_curr_ - file_offset_[fp];
+  const size_t end = std::min(offset_end_, file_offset_[fp + 1]) - file_offset_[fp];
+  // the previous chunks are no longer referenced
+  mmap_->DontNeed(mmap_released_, begin);
+  mmap_released_ = begin;
+  // cut at the last record beginning, the chunk grows until it holds a whole record
+  char *bptr = mmap_->data() + begin;
+  char *eptr = mmap_->data() + end;
+  size_t nstep = buffer_size_ * sizeof(uint32_t);
+  while (nstep < end - begin) {
+    const char *last = this->FindLastRecordBegin(bptr, bptr + nstep);
+    if (last != bptr) {
+      eptr = bptr + (last - bptr);
+      break;
+    }
+    nstep *= 2;
+  }
+  chunk->begin = bptr;
+  chunk->end = eptr;
+  offset_curr_ += eptr - bptr;
+  // read ahead the next chunk while this one is processed
+  const size_t next = eptr - mmap_->data();
+  mmap_->WillNeed(next, std::min(end, next + buffer_size_ * sizeof(uint32_t)));
+  return true;
 }
 
 InputSplitBase::~InputSplitBase(void) {
+#if DMLC_ENABLE_STD_THREAD
+  delete reader_;
+#endif  // DMLC_ENABLE_STD_THREAD
   delete fs_;
   // no need to delete filesystem, it was singleton
 }
@@ -94,12 +263,175 @@ std::string InputSplitBase::StripEnd(std::string str, char ch) {
 }
 
 std::vector<URI> InputSplitBase::ConvertToURIs(const std::string &uri) {
+  return ConvertToURIs(filesys_, uri);
+}
+
+bool InputSplitBase::HasGlob(const std::string &str) {
+  return str.find_first_of("*?[") != std::string::npos;
+}
+
+bool InputSplitBase::GlobMatch(const char *pattern, const char *name) {
+  // a leading '.' is only matched explicitly, as in the shell
+  if (name[0] == '.' && pattern[0] != '.') {
+    return false;
+  }
+  // position after the last '*' and the name position it was tried at
+  const char *star = NULL, *retry = NULL;
+  while (*name != '\0') {
+    bool match = false;
+    const char *next = pattern + 1;
+    if (*pattern == '*') {
+      star = ++pattern;
+      retry = name;
+      continue;
+    } else if (*pattern == '?') {
+      match = true;
+    } else if (*pattern == '[') {
+      // character class, [!...] or [^...] negates it, a ']' first is a literal
+      const char *p = pattern + 1;
+      const bool negate = *p == '!' || *p == '^';
+      if (negate) {
+        ++p;
+      }
+      bool in_class = false;
+      const char *begin = p;
+      while (*p != '\0' && (*p != ']' || p == begin)) {
+        if (p[1] == '-' && p[2] != '\0' && p[2] != ']') {
+          in_class = in_class || (*p <= *name && *name <= p[2]);
+          p += 3;
+        } else {
+          in_class = in_class || *p == *name;
+          ++p;
+        }
+      }
+      if (*p == ']') {
+        match = in_class != negate;
+        next = p + 1;
+      } else {
+        // no closing ']', the '[' is a literal
+        match = *name == '[';
+      }
+    } else {
+      match = *pattern == *name;
+    }
+    if (match) {
+      pattern = next;
+      ++name;
+    } else if (star != NULL) {
+      // let the last '*' absorb one more character
+      pattern = star;
+      name = ++retry;
+    } else {
+      return false;
+    }
+  }
+  while (*pattern == '*') {
+    ++pattern;
+  }
+  return *pattern == '\0';
+}
+
+std::vector<URI> InputSplitBase::GlobDirectories(FileSystem *filesys, const URI &path) {
+  std::vector<URI> dirs(1, path);
+  dirs[0].name.clear();
+  size_t begin = 0;
+  while (begin <= path.name.length()) {
+    size_t end = path.name.find('/', begin);
+    if (end == std::string::npos) {
+      end = path.name.length();
+    }
+    const std::string part = path.name.substr(begin, end - begin);
+    const std::string sep = end == path.name.length() ? "" : "/";
+    if (!HasGlob(part)) {
+      for (URI &dir : dirs) {
+        dir.name += part + sep;
+      }
+    } else {
+      std::vector<URI> matches;
+      for (const URI &dir : dirs) {
+        URI parent = dir;
+        if (parent.name.length() == 0) {
+          parent.name = ".";
+        }
+        std::vector<FileInfo> dfiles;
+        filesys->ListDirectory(parent, &dfiles);
+        for (const FileInfo &info : dfiles) {
+          const std::string name = StripEnd(info.path.name, '/');
+          if (info.type == kDirectory
+              && GlobMatch(part.c_str(), name.c_str() + name.rfind('/') + 1)) {
+            matches.push_back(info.path);
+            matches.back().name = name + sep;
+          }
+        }
+      }
+      std::sort(matches.begin(), matches.end(),
+          [](const URI &a, const URI &b) { return a.name < b.name; });
+      dirs.swap(matches);
+    }
+    begin = end + 1;
+  }
+  return dirs;
+}
+
+void InputSplitBase::ExpandPattern(
+    FileSystem *filesys, const URI &dir, const URI &path, std::vector<URI> *out_list) {
+  std::vector<FileInfo> dfiles;
+  filesys->ListDirectory(dir, &dfiles);
+  for (size_t i = 0; i < dfiles.size(); ++i) {
+    if (StripEnd(dfiles[i].path.name, '/') == StripEnd(path.name, '/')) {
+      out_list->push_back(dfiles[i].path);
+      return;
+    }
+  }
+  const size_t nmatch = out_list->size();
+  const std::string base = path.name.substr(path.name.rfind('/') + 1);
+#if DMLC_USE_REGEX
+  std::string spattern = path.name;
+  try {
+    std::regex pattern(spattern);
+    for (size_t i = 0; i < dfiles.size(); ++i) {
+      if (dfiles[i].type != kFile || dfiles[i].size == 0) {
+        continue;
+      }
+      std::string stripped = StripEnd(dfiles[i].path.name, '/');
+      std::smatch base_match;
+      if (std::regex_match(stripped, base_match, pattern)) {
+        for (size_t j = 0; j < base_match.size(); ++j) {
+          if (base_match[j].str() == stripped) {
+            out_list->push_back(dfiles[i].path);
+            break;
+          }
+        }
+      }
+    }
+  } catch (std::regex_error &e) {
+    // a glob pattern is not always a valid regex
+    if (!HasGlob(base)) {
+      LOG(FATAL) << e.what() << " bad regex " << spattern
+                 << "This could due to compiler version, g++-4.9 is needed";
+    }
+  }
+#endif  // DMLC_USE_REGEX
+  // the patterns that match nothing as a regex are glob patterns of the entries
+  if (out_list->size() == nmatch && HasGlob(base)) {
+    for (size_t i = 0; i < dfiles.size(); ++i) {
+      const std::string stripped = StripEnd(dfiles[i].path.name, '/');
+      if (GlobMatch(base.c_str(), stripped.c_str() + stripped.rfind('/') + 1)) {
+        out_list->push_back(dfiles[i].path);
+      }
+    }
+    std::sort(out_list->begin() + nmatch, out_list->end(),
+        [](const URI &a, const URI &b) { return a.name < b.name; });
+  }
+}
+
+std::vector<URI> InputSplitBase::ConvertToURIs(FileSystem *filesys, const std::string &uri) {
   // split by :
   const char dlm = ';';
   std::vector<std::string> file_list = Split(uri, dlm);
   std::vector<URI> expanded_list;
 
-  // expand by match regex pattern.
+  // expand by match regex or glob pattern.
   for (size_t i = 0; i < file_list.size(); ++i) {
     URI path(file_list[i].c_str());
     size_t pos = path.name.rfind('/');
@@ -108,70 +440,147 @@ std::vector<URI> InputSplitBase::ConvertToURIs(const std::string &uri) {
     } else {
       URI dir = path;
       dir.name = path.name.substr(0, pos);
-      std::vector<FileInfo> dfiles;
-      filesys_->ListDirectory(dir, &dfiles);
-      bool exact_match = false;
-      for (size_t i = 0; i < dfiles.size(); ++i) {
-        if (StripEnd(dfiles[i].path.name, '/') == StripEnd(path.name, '/')) {
-          expanded_list.push_back(dfiles[i].path);
-          exact_match = true;
-          break;
-        }
-      }
-#if DMLC_USE_REGEX
-      if (!exact_match) {
-        std::string spattern = path.name;
-        try {
-          std::regex pattern(spattern);
-          for (size_t i = 0; i < dfiles.size(); ++i) {
-            if (dfiles[i].type != kFile || dfiles[i].size == 0) {
-              continue;
-            }
-            std::string stripped = StripEnd(dfiles[i].path.name, '/');
-            std::smatch base_match;
-            if (std::regex_match(stripped, base_match, pattern)) {
-              for (size_t j = 0; j < base_match.size(); ++j) {
-                if (base_match[j].str() == stripped) {
-                  expanded_list.push_back(dfiles[i].path);
-                  break;
-                }
-              }
-            }
-          }
-        } catch (std::regex_error &e) {
-          LOG(FATAL) << e.what() << " bad regex " << spattern
-                     << "This could due to compiler version, g++-4.9 is needed";
+      if (!HasGlob(dir.name)) {
+        ExpandPattern(filesys, dir, path, &expanded_list);
+      } else {
+        // glob patterns in the directories, e.g. /data/2024-*/part-*
+        for (const URI &match : GlobDirectories(filesys, dir)) {
+          URI mpath = path;
+          mpath.name = match.name + path.name.substr(pos);
+          ExpandPattern(filesys, match, mpath, &expanded_list);
         }
       }
-#endif  // DMLC_USE_REGEX
     }
   }
   return expanded_list;
 }
 
-void InputSplitBase::InitInputFileInfo(const std::string &uri, const bool recurse_directories) {
-  std::vector<URI> expanded_list = this->ConvertToURIs(uri);
+std::vector<FileInfo> InputSplitBase::ListInputFiles(FileSystem *filesys, const std::string &uri,
+    const bool recurse_directories, const std::string &manifest) {
+  // the listing is bound to the uri, not to the content of the directories,
+  // remove the manifest to list the files again
+  CacheHeader header;
+  header.Add(uri);
+  header.Add(static_cast<uint64_t>(recurse_directories));
+  if (manifest.length() != 0) {
+    std::unique_ptr<Stream> fi(Stream::Create(manifest.c_str(), "r", true));
+    std::vector<FileInfo> files;
+    if (fi != nullptr && LoadManifest(fi.get(), header, &files)) {
+      // a cheap check that the files were not rewritten since they were listed
+      auto unchanged = [filesys](const FileInfo &info) {
+        try {
+          const FileInfo now = filesys->GetPathInfo(info.path);
+          return now.size == info.size && now.mtime == info.mtime && now.etag == info.etag;
+        } catch (const dmlc::Error &) {
+          return false;
+        }
+      };
+      if (unchanged(files.front()) && unchanged(files.back())) {
+        return files;
+      }
+      LOG(INFO) << "the files of manifest " << manifest << " changed, listing them again";
+    }
+  }
+  std::vector<FileInfo> files;
+  std::vector<URI> expanded_list = ConvertToURIs(filesys, uri);
   for (size_t i = 0; i < expanded_list.size(); ++i) {
     const URI &path = expanded_list[i];
-    FileInfo info = filesys_->GetPathInfo(path);
+    FileInfo info = filesys->GetPathInfo(path);
     if (info.type == kDirectory) {
       std::vector<FileInfo> dfiles;
       if (!recurse_directories) {
-        filesys_->ListDirectory(info.path, &dfiles);
+        filesys->ListDirectory(info.path, &dfiles);
       } else {
-        filesys_->ListDirectoryRecursive(info.path, &dfiles);
+        filesys->ListDirectoryRecursive(info.path, &dfiles);
       }
       for (size_t i = 0; i < dfiles.size(); ++i) {
         if (dfiles[i].size != 0 && dfiles[i].type == kFile) {
-          files_.push_back(dfiles[i]);
+          files.push_back(dfiles[i]);
         }
       }
     } else {
       if (info.size != 0) {
-        files_.push_back(info);
+        files.push_back(info);
       }
     }
   }
+  if (manifest.length() != 0) {
+    WriteFile(manifest, [&header, &files](Stream *fo) { SaveManifest(fo, header, files); });
+  }
+  return files;
+}
+
+void InputSplitBase::WriteFile(
+    const std::string &path, const std::function<void(Stream *)> &write) {
+  URI uri(path.c_str());
+  if (uri.protocol.length() != 0 && uri.protocol != "file://") {
+    // the objects of the remote filesystems are only visible once completely written
+    std::unique_ptr<Stream> fo(Stream::Create(path.c_str(), "w"));
+    write(fo.get());
+    return;
+  }
+  const std::string name = uri.host + uri.name;
+  std::ostringstream os;
+  os << name << ".tmp" << std::random_device()();
+  const std::string tmp = os.str();
+  try {
+    std::unique_ptr<Stream> fo(Stream::Create(tmp.c_str(), "w"));
+    write(fo.get());
+  } catch (...) {
+    std::remove(tmp.c_str());
+    throw;
+  }
+  // rename does not replace an existing file on Windows
+  if (std::rename(tmp.c_str(), name.c_str()) != 0) {
+    std::remove(name.c_str());
+    if (std::rename(tmp.c_str(), name.c_str()) != 0) {
+      std::remove(tmp.c_str());
+      LOG(FATAL) << "cannot rename " << tmp << " to " << name;
+    }
+  }
+}
+
+void InputSplitBase::SaveManifest(
+    Stream *fo, const CacheHeader &header, const std::vector<FileInfo> &files) {
+  std::vector<std::string> paths, etags;
+  std::vector<uint64_t> sizes, mtimes;
+  for (const FileInfo &info : files) {
+    paths.push_back(info.path.str());
+    sizes.push_back(info.size);
+    mtimes.push_back(info.mtime);
+    etags.push_back(info.etag);
+  }
+  header.Save(fo);
+  fo->Write(paths);
+  fo->Write(sizes);
+  fo->Write(mtimes);
+  fo->Write(etags);
+}
+
+bool InputSplitBase::LoadManifest(
+    Stream *fi, const CacheHeader &header, std::vector<FileInfo> *out_files) {
+  std::vector<std::string> paths, etags;
+  std::vector<uint64_t> sizes, mtimes;
+  if (!header.Match(fi) || !fi->Read(&paths) || !fi->Read(&sizes) || !fi->Read(&mtimes)
+      || !fi->Read(&etags) || sizes.size() != paths.size() || mtimes.size() != paths.size()
+      || etags.size() != paths.size() || paths.size() == 0) {
+    return false;
+  }
+  out_files->resize(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    FileInfo &info = (*out_files)[i];
+    info.path = URI(paths[i].c_str());
+    info.size = static_cast<size_t>(sizes[i]);
+    info.type = kFile;
+    info.mtime = mtimes[i];
+    info.etag = etags[i];
+  }
+  return true;
+}
+
+void InputSplitBase::InitInputFileInfo(
+    const std::string &uri, const bool recurse_directories, const std::string &manifest) {
+  files_ = ListInputFiles(filesys_, uri, recurse_directories, manifest);
   CHECK_NE(files_.size(), 0U) << "Cannot find any files that matches the URI pattern " << uri;
 }
 
@@ -190,8 +599,26 @@ size_t InputSplitBase::Read(void *ptr, size_t size) {
   if (size == 0) {
     return 0;
   }
+#if DMLC_ENABLE_STD_THREAD
+  if (reader_ != NULL) {
+    const size_t nread = reader_->Read(ptr, size, is_text_parser);
+    offset_curr_ = offset_begin_ + reader_->BytesConsumed();
+    return nread;
+  }
+#endif  // DMLC_ENABLE_STD_THREAD
   size_t nleft = size;
   char *buf = reinterpret_cast<char *>(ptr);
+  if (probe_pos_ != probe_.length()) {
+    const size_t n = std::min(nleft, probe_.length() - probe_pos_);
+    std::memcpy(buf, BeginPtr(probe_) + probe_pos_, n);
+    probe_pos_ += n;
+    offset_curr_ += n;
+    buf += n;
+    nleft -= n;
+    if (nleft == 0) {
+      return size;
+    }
+  }
   while (true) {
     size_t n = fs_->Read(buf, nleft);
     nleft -= n;
@@ -222,7 +649,7 @@ size_t InputSplitBase::Read(void *ptr, size_t size) {
       }
       file_ptr_ += 1;
       delete fs_;
-      fs_ = filesys_->OpenForRead(files_[file_ptr_].path);
+      fs_ = this->OpenFile(file_ptr_);
     }
   }
   return size - nleft;
@@ -230,16 +657,21 @@ size_t InputSplitBase::Read(void *ptr, size_t size) {
 
 bool InputSplitBase::ReadChunk(void *buf, size_t *size) {
   size_t max_size = *size;
-  if (max_size <= overflow_.length()) {
+  if (max_size <= tail_size_) {
+    // the buffer is to grow, hold the partial record until then
+    this->StashTail();
     *size = 0;
     return true;
   }
-  if (overflow_.length() != 0) {
-    std::memcpy(buf, BeginPtr(overflow_), overflow_.length());
+  char *bptr = reinterpret_cast<char *>(buf);
+  size_t olen = tail_size_;
+  if (olen != 0 && tail_ != bptr) {
+    // the only copy of a partial record, it can be in the same buffer
+    std::memmove(bptr, tail_, olen);
+    tail_bytes_copied_ += olen;
   }
-  size_t olen = overflow_.length();
-  overflow_.resize(0);
-  size_t nread = this->Read(reinterpret_cast<char *>(buf) + olen, max_size - olen);
+  tail_size_ = 0;
+  size_t nread = this->Read(bptr + olen, max_size - olen);
   nread += olen;
   if (nread == 0) {
     return false;
@@ -248,8 +680,7 @@ bool InputSplitBase::ReadChunk(void *buf, size_t *size) {
     if (nread == olen) {
       // Insert a newline between files to handle files with NOEOL.
       // See https://github.com/dmlc/dmlc-core/pull/452 for explanation.
-      char *bufptr = reinterpret_cast<char *>(buf);
-      bufptr[nread] = '\n';
+      bptr[nread] = '\n';
       nread++;
     }
   } else {
@@ -258,31 +689,68 @@ bool InputSplitBase::ReadChunk(void *buf, size_t *size) {
       return true;
     }
   }
-  const char *bptr = reinterpret_cast<const char *>(buf);
   // return the last position where a record starts
   const char *bend = this->FindLastRecordBegin(bptr, bptr + nread);
   *size = bend - bptr;
-  overflow_.resize(nread - *size);
-  if (overflow_.length() != 0) {
-    std::memcpy(BeginPtr(overflow_), bend, overflow_.length());
-  }
+  // the partial record is left in place after the chunk, the next read copies it once
+  tail_ = bend;
+  tail_size_ = nread - *size;
   return true;
 }
 
+size_t InputSplitBase::SeekRecordBegin(Stream *fi) {
+  // a few large reads instead of one per record header, each read of
+  // a remote stream can be a request
+  size_t nread = 0;
+  for (size_t size = kProbeSize;; size *= 2) {
+    probe_.resize(size);
+    bool eof = false;
+    while (nread != size) {
+      const size_t n = fi->Read(BeginPtr(probe_) + nread, size - nread);
+      if (n == 0) {
+        eof = true;
+        break;
+      }
+      nread += n;
+    }
+    const char *begin = BeginPtr(probe_);
+    const char *p = this->FindFirstRecordBegin(begin, begin + nread);
+    if (p != NULL || eof) {
+      const size_t nstep = p != NULL ? p - begin : nread;
+      probe_.resize(nread);
+      probe_.erase(0, nstep);
+      return nstep;
+    }
+  }
+}
+
+void InputSplitBase::StashTail(void) {
+  if (tail_size_ != 0 && tail_ != BeginPtr(overflow_)) {
+    overflow_.assign(tail_, tail_size_);
+    tail_ = BeginPtr(overflow_);
+    tail_bytes_copied_ += tail_size_;
+  }
+}
+
 bool InputSplitBase::Chunk::Load(InputSplitBase *split, size_t buffer_size) {
-  data.resize(buffer_size + 1);
+  const size_t nbytes = (buffer_size + 1) * sizeof(uint32_t);
+  if (nbytes > data.capacity()) {
+    // the partial record of the last read can be in the buffer to be replaced
+    split->StashTail();
+    data.Reserve(nbytes, 0);
+  }
   while (true) {
     // leave one tail chunk
-    size_t size = (data.size() - 1) * sizeof(uint32_t);
+    size_t size = data.capacity() - sizeof(uint32_t);
     // set back to 0 for string safety
-    data.back() = 0;
-    if (!split->ReadChunk(BeginPtr(data), &size)) {
+    std::memset(data.data() + size, 0, sizeof(uint32_t));
+    if (!split->ReadChunk(data.data(), &size)) {
       return false;
     }
     if (size == 0) {
-      data.resize(data.size() * 2);
+      data.Reserve(data.capacity() * 2, 0);
     } else {
-      begin = reinterpret_cast<char *>(BeginPtr(data));
+      begin = data.data();
       end = begin + size;
       break;
     }
@@ -292,19 +760,24 @@ bool InputSplitBase::Chunk::Load(InputSplitBase *split, size_t buffer_size) {
 
 bool InputSplitBase::Chunk::Append(InputSplitBase *split, size_t buffer_size) {
   size_t previous_size = end - begin;
-  data.resize(data.size() + buffer_size);
+  const size_t nbytes = previous_size + (buffer_size + 1) * sizeof(uint32_t);
+  if (nbytes > data.capacity()) {
+    split->StashTail();
+    // grow geometrically, so appending records one by one copies each of them O(1) times
+    data.Reserve(std::max(nbytes, data.capacity() * 2), previous_size);
+  }
   while (true) {
     // leave one tail chunk
-    size_t size = buffer_size * sizeof(uint32_t);
+    size_t size = data.capacity() - previous_size - sizeof(uint32_t);
     // set back to 0 for string safety
-    data.back() = 0;
-    if (!split->ReadChunk(reinterpret_cast<char *>(BeginPtr(data)) + previous_size, &size)) {
+    std::memset(data.data() + previous_size + size, 0, sizeof(uint32_t));
+    if (!split->ReadChunk(data.data() + previous_size, &size)) {
       return false;
     }
     if (size == 0) {
-      data.resize(data.size() * 2);
+      data.Reserve(data.capacity() * 2, previous_size);
     } else {
-      begin = reinterpret_cast<char *>(BeginPtr(data));
+      begin = data.data();
       end = begin + previous_size + size;
       break;
     }
@@ -10,12 +10,19 @@
 #include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <dmlc/filesystem.h>
 #include <dmlc/io.h>
 
+#include "./cache_header.h"
+#include "./chunk_buffer.h"
+#include "./mmap_file.h"
+#include "./parallel_reader.h"
+
 namespace dmlc {
 namespace io {
 /*! \brief class to construct input split from multiple files */
@@ -28,8 +35,10 @@ class InputSplitBase : public InputSplit {
   struct Chunk {
     char *begin;
     char *end;
-    std::vector<uint32_t> data;
-    explicit Chunk(size_t buffer_size) : begin(NULL), end(NULL), data(buffer_size + 1) {}
+    /*! \brief storage of the chunk, with room for a zero word after the data */
+    ChunkBuffer data;
+    explicit Chunk(size_t buffer_size)
+        : begin(NULL), end(NULL), data((buffer_size + 1) * sizeof(uint32_t)) {}
     // load chunk from split
     bool Load(InputSplitBase *split, size_t buffer_size);
     // append to chunk
@@ -37,6 +46,8 @@ class InputSplitBase : public InputSplit {
   };
   // 16 MB
   static const size_t kBufferSize = 2UL << 20UL;
+  /*! \brief size of the first read when looking for a record boundary */
+  static const size_t kProbeSize = 64UL << 10UL;
   // destructor
   virtual ~InputSplitBase(void);
   // implement BeforeFirst
@@ -50,7 +61,7 @@ class InputSplitBase : public InputSplit {
   // implement next record
   virtual bool NextRecord(Blob *out_rec) {
     while (!ExtractNextRecord(out_rec, &tmp_chunk_)) {
-      if (!NextChunkEx(&tmp_chunk_)) {
+      if (!this->NextChunkEx(&tmp_chunk_)) {
         return false;
       }
     }
@@ -59,7 +70,7 @@ class InputSplitBase : public InputSplit {
   // implement next chunk
   virtual bool NextChunk(Blob *out_chunk) {
     while (!ExtractNextChunk(out_chunk, &tmp_chunk_)) {
-      if (!NextChunkEx(&tmp_chunk_)) {
+      if (!this->NextChunkEx(&tmp_chunk_)) {
         return false;
       }
     }
@@ -76,6 +87,10 @@ class InputSplitBase : public InputSplit {
    *        should be properly aligned to 64 bits
    * \param size the maximum size of memory,
    *   after the function returns, it stores the size of the chunk
+   *   The partial record read after the chunk is left in buf and copied
+   *   to the next buffer by the next call, so buf must stay allocated and the
+   *   region after the chunk unmodified until then. ThreadedIter only frees
+   *   its cells after the next call to fill a cell, which meets this.
    * \return whether end of file was reached
    */
   virtual bool ReadChunk(void *buf, size_t *size);
@@ -107,6 +122,9 @@ class InputSplitBase : public InputSplit {
    *  temporary chunk
    */
   virtual bool NextChunkEx(Chunk *chunk) {
+    if (use_mmap_) {
+      return this->NextMappedChunk(chunk);
+    }
     if (!chunk->Load(this, buffer_size_)) {
       return false;
     }
@@ -120,6 +138,56 @@ class InputSplitBase : public InputSplit {
   virtual bool NextBatchEx(Chunk *chunk, size_t /*n_records*/) {
     return NextChunkEx(chunk);
   }
+  /*!
+   * \brief read the local files through private memory maps instead of streams,
+   *  the chunks then point into the mapping of the current file and are never copied.
+   *  A chunk does not span two files, and is only valid until the next chunk is read,
+   *  as the pages of the previous chunks are released.
+   */
+  void EnableMMap(void);
+  /*!
+   * \brief read the files with positioned reads of several threads, which read
+   *  the next ranges of the partition ahead, within a file and across the
+   *  next files, each with its own stream. Useful on high latency storage.
+   * \param nthread number of reading threads
+   */
+  void EnableParallelRead(int nthread);
+  /*!
+   * \brief read the local files with several reads in flight, see AsyncFileStream
+   * \param depth number of blocks read ahead of the position in the current file
+   * \param direct whether to bypass the page cache, for files that are read once
+   */
+  void EnableAsyncRead(size_t depth, bool direct);
+  /*! \return number of bytes of the partial records at the end of the reads copied so far */
+  size_t TailBytesCopied(void) const {
+    return tail_bytes_copied_;
+  }
+  /*! \brief information about the files covered by this split */
+  const std::vector<FileInfo> &files(void) const {
+    return files_;
+  }
+  /*!
+   * \brief list the files a uri expands to, in the order they are read
+   * \param fs the filesystem ptr
+   * \param uri the uri of the files, can be a list separated by ';'
+   *   and each entry can be a file, a directory, a regex pattern or a glob pattern,
+   *   the directories of an entry can be glob patterns
+   * \param recurse_directories recursively travese directories
+   * \param manifest if not empty, a file that holds the listing of the same uri,
+   *   which is then not listed again; written after listing the files otherwise.
+   *   The files are listed again if the size of the first or the last file of the
+   *   manifest changed, the files added to the directories are not detected.
+   * \return information about every non-empty file
+   */
+  static std::vector<FileInfo> ListInputFiles(FileSystem *fs, const std::string &uri,
+      const bool recurse_directories = false, const std::string &manifest = "");
+  /*!
+   * \brief write a file, a local file is written to a temporary file renamed at the end,
+   *  so the readers of the file never see it partially written
+   * \param path the path of the file
+   * \param write the function writing the content of the file
+   */
+  static void WriteFile(const std::string &path, const std::function<void(Stream *)> &write);
 
  protected:
   /*! \brief FileSystem */
@@ -146,7 +214,15 @@ class InputSplitBase : public InputSplit {
   size_t buffer_size_;
   // constructor
   InputSplitBase()
-      : fs_(NULL), tmp_chunk_(kBufferSize), buffer_size_(kBufferSize), align_bytes_(8) {}
+      : fs_(NULL),
+        tmp_chunk_(kBufferSize),
+        buffer_size_(kBufferSize),
+        align_bytes_(8),
+        tail_(NULL),
+        tail_size_(0),
+        use_mmap_(false),
+        mmap_ptr_(0),
+        mmap_released_(0) {}
   /*!
    * \brief intialize the base before doing anything
    * \param fs the filesystem ptr
@@ -156,16 +232,44 @@ class InputSplitBase : public InputSplit {
    * \param align_bytes the head split must be multiple of align_bytes
    *   this also checks if file size are multiple of align_bytes
    * \param recurse_directories recursively travese directories
+   * \param manifest the listing manifest of the uri, see ListInputFiles
+   * \param whole_files whether to assign whole files to the partitions, balanced by
+   *   bytes, instead of splitting the files at record boundaries, which costs a read
+   *   at each end of every partition. For datasets of many small files, used with
+   *   EnableParallelRead so that the next files are opened and read concurrently.
    */
-  void Init(
-      FileSystem *fs, const char *uri, size_t align_bytes, const bool recurse_directories = false);
-  // to be implemented by child class
+  void Init(FileSystem *fs, const char *uri, size_t align_bytes,
+      const bool recurse_directories = false, const std::string &manifest = "",
+      const bool whole_files = false);
+  /*!
+   * \brief set the byte range of the partition and open its first file
+   * \param begin the begin offset in the concatenated files
+   * \param end the end offset in the concatenated files
+   * \param exact whether begin and end are beginnings of records,
+   *   otherwise both move to the beginning of the next record
+   */
+  void SetPartition(size_t begin, size_t end, bool exact);
+  /*!
+   * \brief restart the pass at an offset in the partition
+   * \param offset the offset in the concatenated files, the beginning of a record
+   */
+  void SeekOffset(size_t offset);
   /*!
    * \brief seek to the beginning of the first record
-   *        in current file pointer
+   *        in current file pointer, the stream is read in large blocks
+   *        and the bytes read past the beginning of the record are kept in probe_
    * \return how many bytes we read past
    */
-  virtual size_t SeekRecordBegin(Stream *fi) = 0;
+  virtual size_t SeekRecordBegin(Stream *fi);
+  // to be implemented by child class
+  /*!
+   * \brief find the first occurance of record header
+   * \param begin beginning of the buffer, read at an arbitrary position
+   * \param end end of the buffer
+   * \return the pointer in [begin, end) where the first record begins,
+   *         NULL if the buffer does not contain one
+   */
+  virtual const char *FindFirstRecordBegin(const char *begin, const char *end) = 0;
   /*!
    * \brief find the last occurance of record header
    * \param begin beginning of the buffer
@@ -177,18 +281,81 @@ class InputSplitBase : public InputSplit {
 
   /*! \brief split string list of files into vector of URIs */
   std::vector<URI> ConvertToURIs(const std::string &uri);
+  /*! \brief split string list of files into vector of URIs using filesystem fs */
+  static std::vector<URI> ConvertToURIs(FileSystem *fs, const std::string &uri);
   /*! \brief same as stream.Read */
   size_t Read(void *ptr, size_t size);
 
  private:
   /*! \brief bytes to be aligned */
   size_t align_bytes_;
-  /*! \brief internal overflow buffer */
+  /*! \brief the partial record at the end of the last read, moved to the next buffer */
+  const char *tail_;
+  /*! \brief size of the partial record */
+  size_t tail_size_;
+  /*! \brief holds the partial record when the buffer it was read into is replaced */
   std::string overflow_;
+  /*! \brief number of bytes of partial records copied */
+  size_t tail_bytes_copied_{0};
+  /*! \brief whether the files are read through memory maps */
+  bool use_mmap_;
+  /*! \brief the mapping of the current file */
+  std::unique_ptr<MMapFile> mmap_;
+  /*! \brief index of the mapped file */
+  size_t mmap_ptr_;
+  /*! \brief offset in the mapped file up to which the pages are released */
+  size_t mmap_released_;
+  /*! \brief copy the partial record out of the buffer it was read into */
+  void StashTail(void);
+  /*! \brief bytes of the current file at offset_begin_, read while looking for it */
+  std::string probe_;
+  /*! \brief number of bytes of probe_ read by this pass */
+  size_t probe_pos_{0};
+  /*! \brief number of blocks read ahead by the local streams, 0 to use the filesystem */
+  size_t async_depth_{0};
+  /*! \brief whether the local streams bypass the page cache */
+  bool async_direct_{false};
+  /*! \brief whether the partitions are made of whole files */
+  bool whole_files_{false};
+  /*! \brief open the stream of a file */
+  SeekStream *OpenFile(size_t index);
+#if DMLC_ENABLE_STD_THREAD
+  /*! \brief the reader of the ranges of the partition, NULL if the stream is read */
+  ParallelReader *reader_{nullptr};
+#endif  // DMLC_ENABLE_STD_THREAD
+  /*! \brief fill the chunk with a view of the mapping of the current file */
+  bool NextMappedChunk(Chunk *chunk);
   /*! \brief initialize information in files */
-  void InitInputFileInfo(const std::string &uri, const bool recurse_directories);
+  void InitInputFileInfo(
+      const std::string &uri, const bool recurse_directories, const std::string &manifest);
   /*! \brief strip continous chars in the end of str */
-  std::string StripEnd(std::string str, char ch);
+  static std::string StripEnd(std::string str, char ch);
+  /*! \brief whether a path contains the special characters of glob patterns */
+  static bool HasGlob(const std::string &str);
+  /*!
+   * \brief match a name against a glob pattern, with '*', '?' and '[...]'
+   * \param pattern the pattern
+   * \param name the name, without '/'
+   */
+  static bool GlobMatch(const char *pattern, const char *name);
+  /*! \brief the directories matching a path whose components can be glob patterns, sorted */
+  static std::vector<URI> GlobDirectories(FileSystem *fs, const URI &path);
+  /*!
+   * \brief expand an entry of a uri within its directory: the entry itself if it exists,
+   *  else the files matching it as a regex, else the entries matching it as a glob
+   * \param fs the filesystem ptr
+   * \param dir the directory of the entry
+   * \param path the entry
+   * \param out_list the expanded uris are appended to it
+   */
+  static void ExpandPattern(
+      FileSystem *fs, const URI &dir, const URI &path, std::vector<URI> *out_list);
+  /*! \brief write the listing of files, bound to the uri by the header */
+  static void SaveManifest(
+      Stream *fo, const CacheHeader &header, const std::vector<FileInfo> &files);
+  /*! \brief read a listing of files, false if it is not bound to the header or truncated */
+  static bool LoadManifest(
+      Stream *fi, const CacheHeader &header, std::vector<FileInfo> *out_files);
 };
 }  // namespace io
 }  // namespace dmlc
@@ -0,0 +1,200 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file line_index.h
+ * \brief sidecar index of the line offsets of text files
+ */
+#ifndef DMLC_IO_LINE_INDEX_H_
+#define DMLC_IO_LINE_INDEX_H_
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <dmlc/common.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+
+#include "./cache_header.h"
+
+namespace dmlc {
+namespace io {
+/*!
+ * \brief offsets of the lines of text files, sampled every few lines.
+ *  A line is a record of LineSplitter: it begins after a run of '\n' or '\r',
+ *  or at the beginning of the files. The index stores the offset of at least one
+ *  line every kStride lines and the total number of lines, so a line is found by
+ *  reading less than kStride lines. Empty lines are not counted, except that
+ *  LineSplitter returns one empty record for the end of lines at the beginning of
+ *  the first file; the next files follow an end of line inserted between files.
+ */
+class LineIndex {
+ public:
+  /*! \brief maximum number of lines between two sampled lines */
+  static const size_t kStride = 1024;
+  /*! \brief size of the byte ranges scanned in parallel when building the index */
+  static const size_t kRangeSize = 64UL << 20UL;
+  /*! \brief size of the reads of the files */
+  static const size_t kReadSize = 1UL << 20UL;
+  /*!
+   * \brief build the index by scanning the files, ranges of the files are scanned in parallel
+   * \param filesys the filesystem
+   * \param files the files
+   * \param nthread number of threads, the number of cores if not positive
+   */
+  inline void Build(FileSystem *filesys, const std::vector<FileInfo> &files, int nthread) {
+    std::vector<Range> ranges;
+    size_t file_begin = 0;
+    for (size_t i = 0; i < files.size(); ++i) {
+      for (size_t begin = 0; begin < files[i].size; begin += kRangeSize) {
+        Range range;
+        range.file = i;
+        range.offset = file_begin;
+        range.begin = begin;
+        range.end = std::min(files[i].size, begin + kRangeSize);
+        ranges.push_back(range);
+      }
+      file_begin += files[i].size;
+    }
+    ParallelFor(ranges.size(), nthread, [&](int, size_t begin, size_t end) {
+      std::unique_ptr<SeekStream> fi;
+      for (size_t i = begin; i < end; ++i) {
+        if (i == begin || ranges[i].file != ranges[i - 1].file) {
+          fi.reset(filesys->OpenForRead(files[ranges[i].file].path));
+        }
+        ScanRange(fi.get(), &ranges[i]);
+      }
+    });
+    rows_.clear();
+    offsets_.clear();
+    num_rows_ = 0;
+    for (const Range &range : ranges) {
+      for (const std::pair<size_t, size_t> &line : range.lines) {
+        rows_.push_back(num_rows_ + line.first);
+        offsets_.push_back(line.second);
+      }
+      num_rows_ += range.num_lines;
+    }
+  }
+  /*!
+   * \brief save the index
+   * \param fo the output stream
+   * \param header the header identifying the indexed files
+   */
+  inline void Save(Stream *fo, const CacheHeader &header) const {
+    header.Save(fo);
+    fo->Write(num_rows_);
+    fo->Write(rows_);
+    fo->Write(offsets_);
+  }
+  /*!
+   * \brief load an index
+   * \param fi the input stream
+   * \param header the header identifying the indexed files
+   * \return false if the index was built from other files or is truncated
+   */
+  inline bool Load(Stream *fi, const CacheHeader &header) {
+    return header.Match(fi) && fi->Read(&num_rows_) && fi->Read(&rows_) && fi->Read(&offsets_)
+           && rows_.size() == offsets_.size();
+  }
+  /*! \return total number of lines of the files */
+  inline size_t num_rows(void) const {
+    return static_cast<size_t>(num_rows_);
+  }
+  /*!
+   * \brief find the last sampled line at or before a line
+   * \param row index of the line, less than num_rows()
+   * \return the index and the offset in the concatenated files of the sampled line
+   */
+  inline std::pair<size_t, size_t> Locate(size_t row) const {
+    CHECK_LT(row, num_rows());
+    const size_t i = std::upper_bound(rows_.begin(), rows_.end(), row) - rows_.begin();
+    CHECK_NE(i, 0U);
+    return std::make_pair(
+        static_cast<size_t>(rows_[i - 1]), static_cast<size_t>(offsets_[i - 1]));
+  }
+  /*!
+   * \brief count the beginnings of lines in a buffer
+   * \param begin beginning of the buffer
+   * \param end end of the buffer
+   * \param prev_eol whether the byte before the buffer ends a line, updated to the last byte
+   * \param fn called with the position of each beginning of line, returns false to stop
+   * \return the position where fn returned false, end otherwise
+   */
+  template <typename Function>
+  inline static const char *ForEachLine(
+      const char *begin, const char *end, bool *prev_eol, Function fn) {
+    bool eol = *prev_eol;
+    for (const char *p = begin; p != end; ++p) {
+      const bool prev = eol;
+      eol = *p == '\n' || *p == '\r';
+      if (prev && !eol && !fn(p)) {
+        *prev_eol = eol;
+        return p;
+      }
+    }
+    *prev_eol = eol;
+    return end;
+  }
+
+ private:
+  /*! \brief a byte range of a file, and its lines */
+  struct Range {
+    /*! \brief index of the file */
+    size_t file;
+    /*! \brief offset of the file in the concatenated files */
+    size_t offset;
+    /*! \brief begin offset in the file */
+    size_t begin;
+    /*! \brief end offset in the file */
+    size_t end;
+    /*! \brief number of lines beginning in the range */
+    size_t num_lines{0};
+    /*! \brief the sampled lines, index in the range and offset in the concatenated files */
+    std::vector<std::pair<size_t, size_t>> lines;
+  };
+  /*! \brief total number of lines */
+  uint64_t num_rows_{0};
+  /*! \brief index of the sampled lines */
+  std::vector<uint64_t> rows_;
+  /*! \brief offset of the sampled lines in the concatenated files */
+  std::vector<uint64_t> offsets_;
+  // find the lines beginning in a range
+  inline static void ScanRange(SeekStream *fi, Range *range) {
+    std::vector<char> buf(kReadSize);
+    // a line begins at the beginning of the file or after an end of line
+    bool eol = true;
+    size_t pos = range->begin;
+    if (pos != 0) {
+      fi->Seek(pos - 1);
+      CHECK_EQ(fi->Read(buf.data(), 1), 1U) << "LineIndex: unexpected end of file";
+      eol = buf[0] == '\n' || buf[0] == '\r';
+    } else {
+      fi->Seek(0);
+      if (range->file == 0 && range->end != 0) {
+        // the first line of the files, even if it is only ends of line
+        range->lines.push_back(std::make_pair(size_t(0), range->offset));
+        range->num_lines = 1;
+        eol = false;
+      }
+    }
+    while (pos < range->end) {
+      const size_t size = fi->Read(buf.data(), std::min(buf.size(), range->end - pos));
+      CHECK_NE(size, 0U) << "LineIndex: unexpected end of file";
+      const char *begin = buf.data();
+      ForEachLine(begin, begin + size, &eol, [&](const char *p) {
+        if (range->num_lines % kStride == 0) {
+          range->lines.push_back(
+              std::make_pair(range->num_lines, range->offset + pos + (p - begin)));
+        }
+        ++range->num_lines;
+        return true;
+      });
+      pos += size;
+    }
+  }
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_LINE_INDEX_H_
@@ -2,37 +2,26 @@
 #include "./line_split.h"
 
 #include <algorithm>
+#include <memory>
+#include <vector>
 
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
 
 namespace dmlc {
 namespace io {
-size_t LineSplitter::SeekRecordBegin(Stream *fi) {
-  char c = '\0';
-  size_t nstep = 0;
+const char *LineSplitter::FindFirstRecordBegin(const char *begin, const char *end) {
+  const char *p = begin;
   // search till fist end-of-line
-  while (true) {
-    if (fi->Read(&c, sizeof(c)) == 0) {
-      return nstep;
-    }
-    nstep += 1;
-    if (c == '\n' || c == '\r') {
-      break;
-    }
+  while (p != end && *p != '\n' && *p != '\r') {
+    ++p;
   }
   // search until first non-endofline
-  while (true) {
-    if (fi->Read(&c, sizeof(c)) == 0) {
-      return nstep;
-    }
-    if (c != '\n' && c != '\r') {
-      break;
-    }
-    // non-end-of-line should not count
-    nstep += 1;
+  while (p != end && (*p == '\n' || *p == '\r')) {
+    ++p;
   }
-  return nstep;
+  // the end of line can continue in the next bytes
+  return p != end ? p : NULL;
 }
 const char *LineSplitter::FindLastRecordBegin(const char *begin, const char *end) {
   CHECK(begin != end);
@@ -44,6 +33,82 @@ const char *LineSplitter::FindLastRecordBegin(const char *begin, const char *end
   return begin;
 }
 
+void LineSplitter::LoadLineIndex(const std::string &index_file) {
+  CacheHeader header;
+  header.Add(files_);
+  header.Add(std::string("line_index"));
+  header.Add(static_cast<uint64_t>(LineIndex::kStride));
+  index_.reset(new LineIndex());
+  std::unique_ptr<Stream> fi(Stream::Create(index_file.c_str(), "r", true));
+  if (fi == nullptr || !index_->Load(fi.get(), header)) {
+    if (fi != nullptr) {
+      LOG(INFO) << "line index " << index_file << " does not match the files, rebuilding";
+    }
+    index_->Build(filesys_, files_, 0);
+    WriteFile(index_file, [this, &header](Stream *fo) { index_->Save(fo, header); });
+  }
+}
+
+void LineSplitter::ResetPartition(unsigned rank, unsigned nsplit) {
+  if (index_ == nullptr) {
+    InputSplitBase::ResetPartition(rank, nsplit);
+    return;
+  }
+  // the same number of lines in each partition, instead of bytes
+  const size_t nrow = index_->num_rows();
+  row_begin_ = nrow * rank / nsplit;
+  row_end_ = nrow * (rank + 1) / nsplit;
+  this->SetPartition(this->RowOffset(row_begin_), this->RowOffset(row_end_), true);
+}
+
+bool LineSplitter::GetNumRecords(size_t *out_num_records) {
+  if (index_ == nullptr) {
+    return false;
+  }
+  *out_num_records = row_end_ - row_begin_;
+  return true;
+}
+
+bool LineSplitter::SeekRecord(size_t index) {
+  if (index_ == nullptr) {
+    return false;
+  }
+  CHECK_LE(index, row_end_ - row_begin_) << "record index out of the partition";
+  this->SeekOffset(this->RowOffset(row_begin_ + index));
+  return true;
+}
+
+size_t LineSplitter::RowOffset(size_t row) {
+  if (row >= index_->num_rows()) {
+    return file_offset_.back();
+  }
+  std::pair<size_t, size_t> line = index_->Locate(row);
+  size_t offset = line.second;
+  if (line.first == row) {
+    return offset;
+  }
+  // a sampled line is in the same file as the next lines up to the next sampled line
+  const size_t file = std::upper_bound(file_offset_.begin(), file_offset_.end(), offset)
+                      - file_offset_.begin() - 1;
+  std::unique_ptr<SeekStream> fi(filesys_->OpenForRead(files_[file].path));
+  fi->Seek(offset - file_offset_[file]);
+  std::vector<char> buf(LineIndex::kReadSize);
+  size_t nleft = row - line.first;
+  // the sampled line begins at offset, its first byte is not an end of line
+  bool eol = false;
+  while (true) {
+    const size_t size = fi->Read(buf.data(), buf.size());
+    CHECK_NE(size, 0U) << "line index does not match " << files_[file].path.str();
+    const char *begin = buf.data();
+    const char *p = LineIndex::ForEachLine(
+        begin, begin + size, &eol, [&nleft](const char *) { return --nleft != 0; });
+    if (p != begin + size) {
+      return offset + (p - begin);
+    }
+    offset += size;
+  }
+}
+
 bool LineSplitter::ExtractNextRecord(Blob *out_rec, Chunk *chunk) {
   if (chunk->begin == chunk->end) {
     return false;
@@ -59,11 +124,12 @@ bool LineSplitter::ExtractNextRecord(Blob *out_rec, Chunk *chunk) {
       break;
     }
   }
-  // set the string end sign for safety
-  if (p == chunk->end) {
-    *p = '\0';
-  } else {
+  // set the string end sign for safety, over the end of line if there is one,
+  // so a chunk that is a view of a larger buffer never writes past its end
+  if (*(p - 1) == '\n' || *(p - 1) == '\r') {
     *(p - 1) = '\0';
+  } else {
+    *p = '\0';
   }
   out_rec->dptr = chunk->begin;
   out_rec->size = p - chunk->begin;
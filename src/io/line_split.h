@@ -9,20 +9,40 @@
 
 #include <cstdio>
 #include <cstring>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include <dmlc/io.h>
 
 #include "./input_split_base.h"
+#include "./line_index.h"
 
 namespace dmlc {
 namespace io {
 /*! \brief class that split the files by line */
 class LineSplitter : public InputSplitBase {
  public:
-  LineSplitter(FileSystem *fs, const char *uri, unsigned rank, unsigned nsplit) {
-    this->Init(fs, uri, 1);
+  /*!
+   * \brief constructor
+   * \param fs the filesystem
+   * \param uri the uri of the files
+   * \param rank the rank of the partition
+   * \param nsplit number of partitions
+   * \param manifest the listing manifest of the uri, see ListInputFiles
+   * \param index_file if not empty, a sidecar index of the line offsets, built by
+   *  scanning the files in parallel unless the index file was built from the same
+   *  files. The partitions then have the same number of lines, and the lines can
+   *  be accessed by index.
+   * \param whole_files whether the partitions are made of whole files, see Init
+   */
+  LineSplitter(FileSystem *fs, const char *uri, unsigned rank, unsigned nsplit,
+      const std::string &manifest = "", const std::string &index_file = "",
+      const bool whole_files = false) {
+    this->Init(fs, uri, 1, false, manifest, whole_files);
+    if (index_file.length() != 0) {
+      this->LoadLineIndex(index_file);
+    }
     this->ResetPartition(rank, nsplit);
   }
 
@@ -30,10 +50,25 @@ class LineSplitter : public InputSplitBase {
     return true;
   }
   virtual bool ExtractNextRecord(Blob *out_rec, Chunk *chunk);
+  virtual void ResetPartition(unsigned rank, unsigned nsplit);
+  virtual bool GetNumRecords(size_t *out_num_records);
+  virtual bool SeekRecord(size_t index);
 
  protected:
-  virtual size_t SeekRecordBegin(Stream *fi);
+  virtual const char *FindFirstRecordBegin(const char *begin, const char *end);
   virtual const char *FindLastRecordBegin(const char *begin, const char *end);
+
+ private:
+  /*! \brief the line index, NULL if not used */
+  std::unique_ptr<LineIndex> index_;
+  /*! \brief index of the first line of the partition */
+  size_t row_begin_{0};
+  /*! \brief index of the line after the partition */
+  size_t row_end_{0};
+  /*! \brief offset of a line in the concatenated files, read from the closest sampled line */
+  size_t RowOffset(size_t row);
+  /*! \brief read the line index if it is valid, build and write it otherwise */
+  void LoadLineIndex(const std::string &index_file);
 };
 }  // namespace io
 }  // namespace dmlc
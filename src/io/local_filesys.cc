@@ -1,6 +1,12 @@
 // Copyright by Contributors
 
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <dmlc/base.h>
+#include <dmlc/common.h>
 #include <dmlc/logging.h>
 
 #include <errno.h>
@@ -10,6 +16,7 @@ extern "C" {
 #ifndef _WIN32
 extern "C" {
   #include <dirent.h>
+  #include <fcntl.h>
   #include <sys/types.h>
 }
   #define stat_struct stat
@@ -38,17 +45,22 @@ class FileStream : public SeekStream {
     return 0;
   }
   virtual void Seek(size_t pos) override {
-#ifndef _MSC_VER
-    CHECK(!std::fseek(fp_, static_cast<long>(pos), SEEK_SET));  // NOLINT(*)
-#else  // _MSC_VER
+#if defined(_MSC_VER)
     CHECK(!_fseeki64(fp_, pos, SEEK_SET));
+#elif defined(_WIN32)
+    CHECK(!std::fseek(fp_, static_cast<long>(pos), SEEK_SET));  // NOLINT(*)
+#else
+    // fseek takes a long, which is 32 bits on some platforms
+    CHECK(!fseeko(fp_, static_cast<off_t>(pos), SEEK_SET));
 #endif  // _MSC_VER
   }
   virtual size_t Tell(void) override {
-#ifndef _MSC_VER
-    return std::ftell(fp_);
-#else  // _MSC_VER
+#if defined(_MSC_VER)
     return _ftelli64(fp_);
+#elif defined(_WIN32)
+    return std::ftell(fp_);
+#else
+    return static_cast<size_t>(ftello(fp_));
 #endif  // _MSC_VER
   }
   virtual bool AtEnd(void) const {
@@ -66,6 +78,30 @@ class FileStream : public SeekStream {
   bool use_stdio_;
 };
 
+const size_t LocalFileSystem::kListThreads;
+const size_t LocalFileSystem::kStatBatch;
+
+// fill the size, modification time and type of a file from its status
+static void SetFileInfo(const struct stat_struct &sb, FileInfo *info) {
+  info->size = sb.st_size;
+  // in nanoseconds where the platform has them, so a rewrite within the same
+  // second still changes the modification time
+#if defined(__APPLE__)
+  info->mtime = static_cast<uint64_t>(sb.st_mtimespec.tv_sec) * 1000000000ULL
+                + static_cast<uint64_t>(sb.st_mtimespec.tv_nsec);
+#elif !defined(_WIN32)
+  info->mtime = static_cast<uint64_t>(sb.st_mtim.tv_sec) * 1000000000ULL
+                + static_cast<uint64_t>(sb.st_mtim.tv_nsec);
+#else
+  info->mtime = static_cast<uint64_t>(sb.st_mtime) * 1000000000ULL;
+#endif  // defined(__APPLE__)
+  if ((sb.st_mode & S_IFMT) == S_IFDIR) {
+    info->type = kDirectory;
+  } else {
+    info->type = kFile;
+  }
+}
+
 FileInfo LocalFileSystem::GetPathInfo(const URI &path) {
   struct stat_struct sb;
   FileInfo ret;
@@ -85,17 +121,41 @@ FileInfo LocalFileSystem::GetPathInfo(const URI &path) {
 #endif  // _WIN32
     LOG(FATAL) << "LocalFileSystem.GetPathInfo: " << path.name << " error: " << strerror(errsv);
   }
-  ret.size = sb.st_size;
-
-  if ((sb.st_mode & S_IFMT) == S_IFDIR) {
-    ret.type = kDirectory;
-  } else {
-    ret.type = kFile;
-  }
+  SetFileInfo(sb, &ret);
   return ret;
 }
 
 void LocalFileSystem::ListDirectory(const URI &path, std::vector<FileInfo> *out_list) {
+  this->ListEntries(path, out_list, kListThreads);
+}
+
+void LocalFileSystem::ListDirectoryRecursive(const URI &path, std::vector<FileInfo> *out_list) {
+  // breadth first, the directories of a level are listed in parallel,
+  // the files are in the same order as with FileSystem::ListDirectoryRecursive
+  std::vector<URI> level(1, path);
+  while (level.size() != 0) {
+    std::vector<std::vector<FileInfo>> dfiles(level.size());
+    const int nthread = static_cast<int>(std::min(level.size(), kListThreads));
+    ParallelFor(level.size(), nthread, [&](int, size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+        this->ListEntries(level[i], &dfiles[i], level.size() == 1 ? kListThreads : 1);
+      }
+    });
+    level.clear();
+    for (const std::vector<FileInfo> &files : dfiles) {
+      for (const FileInfo &info : files) {
+        if (info.type == kDirectory) {
+          level.push_back(info.path);
+        } else {
+          out_list->push_back(info);
+        }
+      }
+    }
+  }
+}
+
+void LocalFileSystem::ListEntries(const URI &path, std::vector<FileInfo> *out_list,
+    size_t nthread) {
 #ifndef _WIN32
   DIR *dir = opendir(path.name.c_str());
   if (dir == NULL) {
@@ -103,8 +163,9 @@ void LocalFileSystem::ListDirectory(const URI &path, std::vector<FileInfo> *out_
     LOG(FATAL) << "LocalFileSystem.ListDirectory " << path.str() << " error: " << strerror(errsv);
   }
   out_list->clear();
+  // the names and types of the entries, the directories need no stat
+  std::vector<std::pair<std::string, bool>> entries;
   struct dirent *ent;
-  /* print all the files and directories within directory */
   while ((ent = readdir(dir)) != NULL) {
     if (!strcmp(ent->d_name, ".")) {
       continue;
@@ -112,13 +173,45 @@ void LocalFileSystem::ListDirectory(const URI &path, std::vector<FileInfo> *out_
     if (!strcmp(ent->d_name, "..")) {
       continue;
     }
-    URI pp = path;
-    if (pp.name[pp.name.length() - 1] != '/') {
-      pp.name += '/';
-    }
-    pp.name += ent->d_name;
-    out_list->push_back(GetPathInfo(pp));
+  #ifdef DT_DIR
+    entries.push_back(std::make_pair(std::string(ent->d_name), ent->d_type == DT_DIR));
+  #else
+    entries.push_back(std::make_pair(std::string(ent->d_name), false));
+  #endif  // DT_DIR
+  }
+  std::string prefix = path.name;
+  if (prefix[prefix.length() - 1] != '/') {
+    prefix += '/';
   }
+  out_list->resize(entries.size());
+  // stat the entries relative to the directory, in parallel for large directories
+  const int fd = dirfd(dir);
+  nthread = std::min(nthread, (entries.size() + kStatBatch - 1) / kStatBatch);
+  ParallelFor(entries.size(), static_cast<int>(std::max<size_t>(nthread, 1)),
+      [&](int, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+          FileInfo &info = (*out_list)[i];
+          info.path = path;
+          info.path.name = prefix + entries[i].first;
+          if (entries[i].second) {
+            info.type = kDirectory;
+            continue;
+          }
+          struct stat_struct sb;
+          if (fstatat(fd, entries[i].first.c_str(), &sb, 0) == -1) {
+            int errsv = errno;
+            // same as GetPathInfo, a symlink that can not be followed is a 0-length file
+            CHECK_EQ(fstatat(fd, entries[i].first.c_str(), &sb, AT_SYMLINK_NOFOLLOW), 0)
+                << "LocalFileSystem.ListDirectory: " << info.path.name
+                << " error: " << strerror(errsv);
+            LOG(INFO) << "LocalFileSystem.ListDirectory: detected symlink " << info.path.name
+                      << " error: " << strerror(errsv);
+            info.type = kFile;
+            continue;
+          }
+          SetFileInfo(sb, &info);
+        }
+      });
   closedir(dir);
 #else  // _WIN32
   WIN32_FIND_DATA fd;
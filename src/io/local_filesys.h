@@ -30,6 +30,13 @@ class LocalFileSystem : public FileSystem {
    * \param out_list the output information about the files
    */
   virtual void ListDirectory(const URI &path, std::vector<FileInfo> *out_list);
+  /*!
+   * \brief list files in a directory recursively,
+   *  the directories of each level of the tree are listed in parallel
+   * \param path to the directory
+   * \param out_list the output information about the files
+   */
+  virtual void ListDirectoryRecursive(const URI &path, std::vector<FileInfo> *out_list);
   /*!
    * \brief open a stream, will report error and exit if bad thing happens
    * NOTE: the IStream can continue to work even when filesystem was destructed
@@ -56,7 +63,19 @@ class LocalFileSystem : public FileSystem {
   }
 
  private:
+  /*! \brief maximum number of threads listing directories, the calls to stat mostly wait */
+  static const size_t kListThreads = 16;
+  /*! \brief minimum number of entries of a directory per thread calling stat */
+  static const size_t kStatBatch = 1024;
   LocalFileSystem() {}
+  /*!
+   * \brief list the entries of a directory, the entries that readdir reports
+   *  as directories are not passed to stat, the others are by up to nthread threads
+   * \param path to the directory
+   * \param out_list the output information about the entries
+   * \param nthread maximum number of threads
+   */
+  void ListEntries(const URI &path, std::vector<FileInfo> *out_list, size_t nthread);
 };
 }  // namespace io
 }  // namespace dmlc
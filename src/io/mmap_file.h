@@ -0,0 +1,121 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file mmap_file.h
+ * \brief private read-write memory map of a local file
+ */
+#ifndef DMLC_IO_MMAP_FILE_H_
+#define DMLC_IO_MMAP_FILE_H_
+
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <dmlc/logging.h>
+
+#ifndef _WIN32
+extern "C" {
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <unistd.h>
+}
+#endif  // _WIN32
+
+namespace dmlc {
+namespace io {
+/*!
+ * \brief private memory map of a whole local file.
+ *  The mapping is copy on write, so the readers may modify it in place,
+ *  e.g. to terminate a record, without touching the file.
+ *  It is followed by at least one zero byte, so the byte at data() + size()
+ *  can be read and written like the tail of an InputSplitBase::Chunk.
+ */
+class MMapFile {
+ public:
+  /*!
+   * \brief map a file
+   * \param path the local path of the file
+   * \param size the size of the file
+   */
+  MMapFile(const std::string &path, size_t size) : data_(NULL), size_(size), length_(0) {
+#ifndef _WIN32
+    const size_t page = PageSize();
+    // one page past the last full page of the file, zero filled
+    length_ = (size / page + 1) * page;
+    void *addr = mmap(NULL, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    CHECK(addr != MAP_FAILED) << "MMapFile: fail to reserve " << length_
+                              << " bytes, error: " << strerror(errno);
+    data_ = static_cast<char *>(addr);
+    int fd = open(path.c_str(), O_RDONLY);
+    CHECK(fd != -1) << "MMapFile: fail to open " << path << ", error: " << strerror(errno);
+    addr = mmap(data_, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+    const int err = errno;
+    close(fd);
+    CHECK(addr != MAP_FAILED) << "MMapFile: fail to map " << path << ", error: " << strerror(err);
+    madvise(data_, size_, MADV_SEQUENTIAL);
+#else
+    LOG(FATAL) << "MMapFile: memory map is not supported on Windows";
+#endif  // _WIN32
+  }
+  ~MMapFile(void) {
+#ifndef _WIN32
+    if (data_ != NULL) {
+      munmap(data_, length_);
+    }
+#endif  // _WIN32
+  }
+  /*! \return beginning of the file content */
+  inline char *data(void) const {
+    return data_;
+  }
+  /*! \return size of the file */
+  inline size_t size(void) const {
+    return size_;
+  }
+  /*!
+   * \brief hint that [begin, end) of the file will be read soon
+   * \param begin the begin offset in the file
+   * \param end the end offset in the file
+   */
+  inline void WillNeed(size_t begin, size_t end) {
+#ifndef _WIN32
+    begin = begin / PageSize() * PageSize();
+    if (begin < end) {
+      madvise(data_ + begin, end - begin, MADV_WILLNEED);
+    }
+#endif  // _WIN32
+  }
+  /*!
+   * \brief drop the pages in [begin, end) of the file that were read,
+   *  only the pages fully inside the range are dropped. The content is read
+   *  again from the file if it is accessed later, local changes are lost.
+   * \param begin the begin offset in the file
+   * \param end the end offset in the file
+   */
+  inline void DontNeed(size_t begin, size_t end) {
+#ifndef _WIN32
+    const size_t page = PageSize();
+    begin = (begin + page - 1) / page * page;
+    end = end / page * page;
+    if (begin < end) {
+      madvise(data_ + begin, end - begin, MADV_DONTNEED);
+    }
+#endif  // _WIN32
+  }
+
+ private:
+  /*! \brief beginning of the mapping */
+  char *data_;
+  /*! \brief size of the file */
+  size_t size_;
+  /*! \brief length of the mapping */
+  size_t length_;
+#ifndef _WIN32
+  inline static size_t PageSize(void) {
+    static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return page;
+  }
+#endif  // _WIN32
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_MMAP_FILE_H_
@@ -0,0 +1,273 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file parallel_reader.h
+ * \brief positioned reads of the ranges of files by several threads,
+ *  delivered in order, to hide the latency of remote storage
+ */
+#ifndef DMLC_IO_PARALLEL_READER_H_
+#define DMLC_IO_PARALLEL_READER_H_
+
+#include <dmlc/base.h>
+// this code depends on c++11
+#if DMLC_ENABLE_STD_THREAD
+  #include <algorithm>
+  #include <condition_variable>
+  #include <cstring>
+  #include <exception>
+  #include <map>
+  #include <memory>
+  #include <mutex>
+  #include <thread>
+  #include <utility>
+  #include <vector>
+
+  #include <dmlc/filesystem.h>
+  #include <dmlc/io.h>
+  #include <dmlc/logging.h>
+
+  #include "./chunk_buffer.h"
+
+namespace dmlc {
+namespace io {
+/*!
+ * \brief reads a list of byte ranges of files with several threads,
+ *  each thread opens its own streams and reads the ranges ahead of the
+ *  consumer, which receives the ranges in the order of the list.
+ */
+class ParallelReader {
+ public:
+  /*! \brief a byte range of a file */
+  struct Range {
+    /*! \brief index of the file */
+    size_t file;
+    /*! \brief begin offset in the file */
+    size_t begin;
+    /*! \brief end offset in the file */
+    size_t end;
+  };
+  /*! \brief the content of a range */
+  struct Buffer {
+    /*! \brief the range */
+    Range range;
+    /*! \brief the bytes of the range */
+    ChunkBuffer data;
+  };
+  /*!
+   * \brief constructor, starts the threads
+   * \param filesys the filesystem
+   * \param files the files the ranges refer to
+   * \param nthread number of reading threads
+   * \param depth maximum number of ranges read ahead of the consumer
+   */
+  ParallelReader(FileSystem *filesys, const std::vector<FileInfo> &files, size_t nthread,
+      size_t depth)
+      : filesys_(filesys),
+        files_(files),
+        depth_(std::max<size_t>(depth, 1)),
+        generation_(0),
+        next_issue_(0),
+        next_deliver_(0),
+        shutdown_(false),
+        cur_pos_(0),
+        consumed_(0),
+        newline_pending_(false) {
+    for (size_t i = 0; i < std::max<size_t>(nthread, 1); ++i) {
+      workers_.emplace_back([this]() { this->RunWorker(); });
+    }
+  }
+  ~ParallelReader(void) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      shutdown_ = true;
+    }
+    cond_.notify_all();
+    for (std::thread &t : workers_) {
+      t.join();
+    }
+  }
+  /*!
+   * \brief restart reading from a new list of ranges,
+   *  the ranges of the previous list that are being read are dropped
+   * \param ranges the ranges to read, in delivery order
+   */
+  inline void Reset(const std::vector<Range> &ranges) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++generation_;
+      ranges_ = ranges;
+      next_issue_ = next_deliver_ = 0;
+      done_.clear();
+      error_ = nullptr;
+    }
+    cond_.notify_all();
+    cur_.reset();
+    cur_pos_ = consumed_ = 0;
+    newline_pending_ = false;
+  }
+  /*!
+   * \brief read the next bytes of the ranges, in order, as if they were one stream
+   * \param ptr the output buffer
+   * \param size the maximum number of bytes to read
+   * \param newline_between_files whether a '\\n' is inserted between the ranges
+   *   of two files, to handle text files without end of line at their end
+   * \return number of bytes written to ptr, 0 if all the ranges were read
+   */
+  inline size_t Read(void *ptr, size_t size, bool newline_between_files) {
+    char *out = reinterpret_cast<char *>(ptr);
+    size_t nleft = size;
+    while (nleft != 0) {
+      if (newline_pending_) {
+        *out++ = '\n';
+        --nleft;
+        newline_pending_ = false;
+        continue;
+      }
+      const size_t avail = cur_ == nullptr ? 0 : cur_->range.end - cur_->range.begin - cur_pos_;
+      if (avail == 0) {
+        const bool file_end
+            = cur_ != nullptr && cur_->range.end == files_[cur_->range.file].size;
+        if (!this->Next(&cur_)) {
+          break;
+        }
+        cur_pos_ = 0;
+        newline_pending_ = file_end && newline_between_files;
+        continue;
+      }
+      const size_t n = std::min(avail, nleft);
+      std::memcpy(out, cur_->data.data() + cur_pos_, n);
+      cur_pos_ += n;
+      consumed_ += n;
+      out += n;
+      nleft -= n;
+    }
+    return size - nleft;
+  }
+  /*! \return number of bytes of the ranges read since the last Reset */
+  inline size_t BytesConsumed(void) const {
+    return consumed_;
+  }
+
+ private:
+  /*! \brief the filesystem */
+  FileSystem *filesys_;
+  /*! \brief the files */
+  std::vector<FileInfo> files_;
+  /*! \brief maximum number of ranges read ahead */
+  size_t depth_;
+  /*! \brief the reading threads */
+  std::vector<std::thread> workers_;
+  /*! \brief protects the fields below */
+  std::mutex mutex_;
+  /*! \brief signals new ranges to read and read ranges */
+  std::condition_variable cond_;
+  /*! \brief incremented by Reset, the reads of older lists are dropped */
+  size_t generation_;
+  /*! \brief the ranges to read */
+  std::vector<Range> ranges_;
+  /*! \brief index of the next range to read */
+  size_t next_issue_;
+  /*! \brief index of the next range to deliver */
+  size_t next_deliver_;
+  /*! \brief the ranges read but not delivered, by index */
+  std::map<size_t, std::unique_ptr<Buffer>> done_;
+  /*! \brief the buffers delivered and given back */
+  std::vector<std::unique_ptr<Buffer>> free_;
+  /*! \brief the first error of a read */
+  std::exception_ptr error_;
+  /*! \brief whether the threads must exit */
+  bool shutdown_;
+  /*! \brief the range being consumed */
+  std::unique_ptr<Buffer> cur_;
+  /*! \brief position in the range being consumed */
+  size_t cur_pos_;
+  /*! \brief bytes of the ranges consumed */
+  size_t consumed_;
+  /*! \brief whether a '\\n' is to be inserted before the next range */
+  bool newline_pending_;
+  // get the next range, blocks until it is read, the previous buffer is reused
+  inline bool Next(std::unique_ptr<Buffer> *out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (*out != nullptr) {
+      free_.push_back(std::move(*out));
+    }
+    if (next_deliver_ == ranges_.size()) {
+      return false;
+    }
+    cond_.wait(lock, [this]() { return done_.count(next_deliver_) != 0 || error_ != nullptr; });
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+    auto it = done_.find(next_deliver_);
+    *out = std::move(it->second);
+    done_.erase(it);
+    ++next_deliver_;
+    lock.unlock();
+    // a slot of the read ahead window is free
+    cond_.notify_all();
+    return true;
+  }
+  // loop of a reading thread
+  inline void RunWorker(void) {
+    std::unique_ptr<SeekStream> fi;
+    size_t file = 0;
+    while (true) {
+      std::unique_ptr<Buffer> buf;
+      size_t index, generation;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this]() {
+          return shutdown_ || (next_issue_ < ranges_.size() && error_ == nullptr
+                                  && next_issue_ < next_deliver_ + depth_);
+        });
+        if (shutdown_) {
+          return;
+        }
+        index = next_issue_++;
+        generation = generation_;
+        if (free_.size() != 0) {
+          buf = std::move(free_.back());
+          free_.pop_back();
+        } else {
+          buf.reset(new Buffer());
+        }
+        buf->range = ranges_[index];
+      }
+      try {
+        const Range &range = buf->range;
+        if (fi == nullptr || file != range.file) {
+          fi.reset(filesys_->OpenForRead(files_[range.file].path));
+          file = range.file;
+        }
+        const size_t size = range.end - range.begin;
+        buf->data.Reserve(size, 0);
+        fi->Seek(range.begin);
+        size_t nread = 0;
+        while (nread < size) {
+          const size_t n = fi->Read(buf->data.data() + nread, size - nread);
+          CHECK_NE(n, 0U) << "unexpected end of file " << files_[range.file].path.str();
+          nread += n;
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation == generation_ && error_ == nullptr) {
+          error_ = std::current_exception();
+        }
+        cond_.notify_all();
+        continue;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (generation == generation_) {
+          done_[index] = std::move(buf);
+        } else {
+          free_.push_back(std::move(buf));
+        }
+      }
+      cond_.notify_all();
+    }
+  }
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_ENABLE_STD_THREAD
+#endif  // DMLC_IO_PARALLEL_READER_H_
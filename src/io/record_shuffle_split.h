@@ -0,0 +1,172 @@
+/*!
+ *  Copyright (c) 2026 by Contributors
+ * \file record_shuffle_split.h
+ * \brief input split that returns the records of another one in random order
+ */
+#ifndef DMLC_IO_RECORD_SHUFFLE_SPLIT_H_
+#define DMLC_IO_RECORD_SHUFFLE_SPLIT_H_
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/memory_io.h>
+#include <dmlc/recordio.h>
+
+namespace dmlc {
+namespace io {
+/*!
+ * \brief returns the records of an input split in random order.
+ *  The records of the source, read in large sequential chunks, fill a reservoir
+ *  of a bounded number of bytes. Each record returned is drawn at random from the
+ *  reservoir, and replaced by the next record of the source. The order depends on
+ *  the seed, the rank of the partition and the epoch, incremented by BeforeFirst.
+ *  The chunks are made of shuffled records, joined by '\\n' for "text" inputs and
+ *  encoded as RecordIO otherwise, so the parsers of the chunks see shuffled rows.
+ */
+class RecordShuffleSplit : public InputSplit {
+ public:
+  /*! \brief minimum size of the chunks in bytes */
+  static const size_t kChunkSize = 1UL << 20UL;
+  /*!
+   * \brief constructor
+   * \param source the input split to shuffle, owned by this object
+   * \param is_text whether the records are lines of text
+   * \param capacity size of the reservoir in bytes
+   * \param seed the seed of the shuffle
+   * \param rank the rank of the partition
+   */
+  RecordShuffleSplit(InputSplit *source, bool is_text, size_t capacity, int seed, unsigned rank)
+      : source_(source),
+        is_text_(is_text),
+        capacity_(capacity),
+        chunk_size_(kChunkSize),
+        seed_(seed),
+        rank_(rank),
+        epoch_(0) {
+    this->Reset();
+  }
+  virtual void HintChunkSize(size_t chunk_size) {
+    source_->HintChunkSize(chunk_size);
+    chunk_size_ = std::max(chunk_size, chunk_size_);
+  }
+  virtual size_t GetTotalSize(void) {
+    return source_->GetTotalSize();
+  }
+  virtual bool GetPrefetchStats(PrefetchStats *out_stats) {
+    return source_->GetPrefetchStats(out_stats);
+  }
+  virtual void ResetPartition(unsigned part_index, unsigned num_parts) {
+    source_->ResetPartition(part_index, num_parts);
+    rank_ = part_index;
+    epoch_ = 0;
+    this->Reset();
+  }
+  virtual void BeforeFirst(void) {
+    source_->BeforeFirst();
+    ++epoch_;
+    this->Reset();
+  }
+  virtual bool NextRecord(Blob *out_rec) {
+    if (!this->Draw(&record_)) {
+      return false;
+    }
+    out_rec->dptr = BeginPtr(record_);
+    out_rec->size = record_.length();
+    return true;
+  }
+  virtual bool NextChunk(Blob *out_chunk) {
+    chunk_.clear();
+    MemoryStringStream fo(&chunk_);
+    RecordIOWriter writer(&fo);
+    while (chunk_.length() < chunk_size_ && this->Draw(&record_)) {
+      if (is_text_) {
+        // a line ends with its end of line, the last byte of which is set to '\0'
+        chunk_ += record_;
+        if (chunk_[chunk_.length() - 1] == '\0') {
+          chunk_[chunk_.length() - 1] = '\n';
+        } else {
+          chunk_ += '\n';
+        }
+      } else {
+        writer.WriteRecord(record_);
+      }
+    }
+    if (chunk_.length() == 0) {
+      return false;
+    }
+    out_chunk->dptr = BeginPtr(chunk_);
+    out_chunk->size = chunk_.length();
+    return true;
+  }
+
+ private:
+  /*! \brief bytes accounted for each record in the reservoir, besides its content */
+  static const size_t kRecordOverhead = sizeof(std::string);
+  /*! \brief the source of the records */
+  std::unique_ptr<InputSplit> source_;
+  /*! \brief whether the records are lines of text */
+  bool is_text_;
+  /*! \brief size of the reservoir in bytes */
+  size_t capacity_;
+  /*! \brief minimum size of the chunks */
+  size_t chunk_size_;
+  /*! \brief the seed of the shuffle */
+  int seed_;
+  /*! \brief rank of the partition */
+  unsigned rank_;
+  /*! \brief number of passes started by BeforeFirst */
+  unsigned epoch_;
+  /*! \brief random engine, seeded at the beginning of each pass */
+  std::mt19937 rnd_;
+  /*! \brief the reservoir, the first size_ strings are records, the others spare buffers */
+  std::vector<std::string> records_;
+  /*! \brief number of records in the reservoir */
+  size_t size_;
+  /*! \brief bytes of the records in the reservoir */
+  size_t bytes_;
+  /*! \brief whether all the records of the source are read */
+  bool eof_;
+  /*! \brief the record returned by NextRecord */
+  std::string record_;
+  /*! \brief the chunk returned by NextChunk */
+  std::string chunk_;
+  // empty the reservoir and seed the random engine for a new pass
+  inline void Reset(void) {
+    std::seed_seq seq({static_cast<uint32_t>(seed_), rank_, epoch_});
+    rnd_.seed(seq);
+    size_ = bytes_ = 0;
+    eof_ = false;
+  }
+  // draw a record from the reservoir after filling it, false at the end of the pass
+  inline bool Draw(std::string *out) {
+    Blob rec;
+    while (!eof_ && (bytes_ < capacity_ || size_ == 0)) {
+      if (!source_->NextRecord(&rec)) {
+        eof_ = true;
+        break;
+      }
+      if (size_ == records_.size()) {
+        records_.emplace_back();
+      }
+      records_[size_++].assign(static_cast<const char *>(rec.dptr), rec.size);
+      bytes_ += rec.size + kRecordOverhead;
+    }
+    if (size_ == 0) {
+      return false;
+    }
+    const size_t i = std::uniform_int_distribution<size_t>(0, size_ - 1)(rnd_);
+    bytes_ -= records_[i].length() + kRecordOverhead;
+    // the buffer of the previous record becomes a spare buffer
+    out->swap(records_[i]);
+    records_[i].swap(records_[--size_]);
+    return true;
+  }
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_RECORD_SHUFFLE_SPLIT_H_
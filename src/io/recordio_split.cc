@@ -8,25 +8,19 @@
 
 namespace dmlc {
 namespace io {
-size_t RecordIOSplitter::SeekRecordBegin(Stream *fi) {
-  size_t nstep = 0;
-  uint32_t v, lrec;
-  while (true) {
-    if (fi->Read(&v, sizeof(v)) == 0) {
-      return nstep;
-    }
-    nstep += sizeof(v);
-    if (v == RecordIOWriter::kMagic) {
-      CHECK(fi->Read(&lrec, sizeof(lrec)) != 0) << "invalid record io format";
-      nstep += sizeof(lrec);
-      uint32_t cflag = RecordIOWriter::DecodeFlag(lrec);
+const char *RecordIOSplitter::FindFirstRecordBegin(const char *begin, const char *end) {
+  CHECK_EQ((reinterpret_cast<size_t>(begin) & 3UL), 0U);
+  const uint32_t *p = reinterpret_cast<const uint32_t *>(begin);
+  const uint32_t *pend = p + (end - begin) / sizeof(uint32_t);
+  for (; p + 1 < pend; ++p) {
+    if (p[0] == RecordIOWriter::kMagic) {
+      uint32_t cflag = RecordIOWriter::DecodeFlag(p[1]);
       if (cflag == 0 || cflag == 1) {
-        break;
+        return reinterpret_cast<const char *>(p);
       }
     }
   }
-  // should point at head of record
-  return nstep - 2 * sizeof(uint32_t);
+  return NULL;
 }
 const char *RecordIOSplitter::FindLastRecordBegin(const char *begin, const char *end) {
   CHECK_EQ((reinterpret_cast<size_t>(begin) & 3UL), 0U);
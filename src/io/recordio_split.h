@@ -23,8 +23,9 @@ namespace io {
 class RecordIOSplitter : public InputSplitBase {
  public:
   RecordIOSplitter(FileSystem *fs, const char *uri, unsigned rank, unsigned nsplit,
-      const bool recurse_directories) {
-    this->Init(fs, uri, 4, recurse_directories);
+      const bool recurse_directories, const std::string &manifest = "",
+      const bool whole_files = false) {
+    this->Init(fs, uri, 4, recurse_directories, manifest, whole_files);
     this->ResetPartition(rank, nsplit);
   }
 
@@ -34,7 +35,7 @@ class RecordIOSplitter : public InputSplitBase {
   virtual bool ExtractNextRecord(Blob *out_rec, Chunk *chunk);
 
  protected:
-  virtual size_t SeekRecordBegin(Stream *fi);
+  virtual const char *FindFirstRecordBegin(const char *begin, const char *end);
   virtual const char *FindLastRecordBegin(const char *begin, const char *end);
 };
 }  // namespace io
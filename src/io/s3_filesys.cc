@@ -1095,6 +1095,13 @@ void S3FileSystem::ListObjects(const URI &path, std::vector<FileInfo> *out_list)
         CHECK(data.GetNext("Key", &value));
         // add root path to be consistent with other filesys convention
         info.path.name = '/' + value.str();
+        {
+          // ETag is optional in some S3 compatible stores, look it up on a copy
+          XMLIter etag = data;
+          if (etag.GetNext("ETag", &value)) {
+            info.etag = value.str();
+          }
+        }
         CHECK(data.GetNext("Size", &value));
         info.size = static_cast<size_t>(atol(value.str().c_str()));
         info.type = kFile;
@@ -27,13 +27,18 @@ class ThreadedInputSplit : public InputSplit {
   /*!
    * \brief constructor
    * \param base an base object to define how to read data
+   * \param batch_size number of records of a batch, see InputSplit::Create
+   * \param prefetch_bytes memory budget of the prefetched chunks, the number of
+   *   chunks read ahead then adapts to the rate of the consumer, 0 to read two ahead
    */
-  explicit ThreadedInputSplit(InputSplitBase *base, const size_t batch_size)
+  ThreadedInputSplit(InputSplitBase *base, const size_t batch_size, size_t prefetch_bytes = 0)
       : buffer_size_(InputSplitBase::kBufferSize),
         batch_size_(batch_size),
         base_(base),
         tmp_chunk_(NULL) {
     iter_.set_max_capacity(2);
+    iter_.set_max_bytes(
+        prefetch_bytes, [](const InputSplitBase::Chunk &chunk) { return chunk.data.capacity(); });
     // initalize the iterator
     iter_.Init(
         [this](InputSplitBase::Chunk **dptr) {
@@ -42,7 +47,12 @@ class ThreadedInputSplit : public InputSplit {
           }
           return base_->NextBatchEx(*dptr, batch_size_);
         },
-        [base]() { base->BeforeFirst(); });
+        [this]() {
+          base_->BeforeFirst();
+          if (seek_record_ != 0) {
+            base_->SeekRecord(seek_record_);
+          }
+        });
   }
   // destructor
   virtual ~ThreadedInputSplit(void) {
@@ -51,6 +61,7 @@ class ThreadedInputSplit : public InputSplit {
     delete base_;
   }
   virtual void BeforeFirst() {
+    seek_record_ = 0;
     iter_.BeforeFirst();
     if (tmp_chunk_ != NULL) {
       iter_.Recycle(&tmp_chunk_);
@@ -94,6 +105,30 @@ class ThreadedInputSplit : public InputSplit {
     return base_->GetTotalSize();
   }
 
+  virtual bool GetPrefetchStats(PrefetchStats *out) {
+    *out = iter_.GetStats();
+    return true;
+  }
+
+  virtual bool GetNumRecords(size_t *out_num_records) {
+    return base_->GetNumRecords(out_num_records);
+  }
+
+  virtual bool SeekRecord(size_t index) {
+    size_t num_records;
+    if (!base_->GetNumRecords(&num_records)) {
+      return false;
+    }
+    CHECK_LE(index, num_records) << "record index out of the partition";
+    // the producer seeks after restarting the pass
+    seek_record_ = index;
+    iter_.BeforeFirst();
+    if (tmp_chunk_ != NULL) {
+      iter_.Recycle(&tmp_chunk_);
+    }
+    return true;
+  }
+
   virtual void ResetPartition(unsigned part_index, unsigned num_parts) {
     base_->ResetPartition(part_index, num_parts);
     this->BeforeFirst();
@@ -106,6 +141,8 @@ class ThreadedInputSplit : public InputSplit {
   size_t batch_size_;
   /*! \brief the place where we get the data */
   InputSplitBase *base_;
+  /*! \brief the record where the producer starts the pass */
+  size_t seek_record_{0};
   /*! \brief backend thread iterator */
   ThreadedIter<InputSplitBase::Chunk> iter_;
   /*! \brief current chunk of data */
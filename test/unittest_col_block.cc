@@ -0,0 +1,131 @@
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dmlc/col_block.h>
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/data/row_block.h"
+
+namespace {
+
+dmlc::data::RowBlockContainer<uint32_t> MakeRandomRowBlock(size_t nrow, uint32_t ncol) {
+  std::mt19937 rng(0);
+  dmlc::data::RowBlockContainer<uint32_t> data;
+  for (size_t i = 0; i < nrow; ++i) {
+    size_t length = rng() % 20;
+    for (size_t j = 0; j < length; ++j) {
+      // skewed towards the first columns
+      uint32_t findex = static_cast<uint32_t>(rng() % (1 + rng() % ncol));
+      data.index.push_back(findex);
+      data.value.push_back(static_cast<dmlc::real_t>(i * 100 + j));
+    }
+    data.label.push_back(0.0f);
+    data.offset.push_back(data.index.size());
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(ColBlock, test_transpose) {
+  dmlc::data::RowBlockContainer<uint32_t> data = MakeRandomRowBlock(3000, 500);
+  // a slice that does not start at the first entry
+  dmlc::RowBlock<uint32_t> batch = data.GetBlock().Slice(100, 3000);
+  // reference transpose
+  std::vector<std::vector<std::pair<uint32_t, dmlc::real_t>>> expected(600);
+  for (size_t i = 0; i < batch.size; ++i) {
+    dmlc::Row<uint32_t> row = batch[i];
+    for (size_t j = 0; j < row.length; ++j) {
+      expected[row.index[j]].emplace_back(static_cast<uint32_t>(i), row.value[j]);
+    }
+  }
+  for (int nthread : {1, 3, 8}) {
+    dmlc::ColBlockContainer<uint32_t> out;
+    dmlc::Transpose(batch, &out, 600, nthread);
+    dmlc::ColBlock<uint32_t> cols = out.GetBlock();
+    ASSERT_EQ(cols.size, 600U);
+    for (size_t c = 0; c < cols.size; ++c) {
+      dmlc::Col<uint32_t> col = cols[c];
+      ASSERT_EQ(col.length, expected[c].size());
+      for (size_t k = 0; k < col.length; ++k) {
+        ASSERT_EQ(col.row[k], expected[c][k].first);
+        ASSERT_EQ(col.get_value(k), expected[c][k].second);
+      }
+    }
+  }
+  // number of columns from the data
+  dmlc::ColBlockContainer<uint32_t> out;
+  dmlc::Transpose(batch, &out);
+  ASSERT_LE(out.Size(), 500U);
+  ASSERT_EQ(out.row.size(), batch.offset[batch.size] - batch.offset[0]);
+}
+
+TEST(ColBlock, test_partition_columns) {
+  dmlc::data::RowBlockContainer<uint32_t> data = MakeRandomRowBlock(5000, 1000);
+  dmlc::ColBlockContainer<uint32_t> out;
+  dmlc::Transpose(data.GetBlock(), &out, 0, 2);
+  dmlc::ColBlock<uint32_t> cols = out.GetBlock();
+  const size_t ndata = out.row.size();
+  for (size_t num_parts : {1, 4, 7}) {
+    std::vector<size_t> parts = dmlc::PartitionColumns(cols, num_parts);
+    ASSERT_EQ(parts.size(), num_parts + 1);
+    ASSERT_EQ(parts[0], 0U);
+    ASSERT_EQ(parts[num_parts], cols.size);
+    size_t total = 0;
+    for (size_t k = 0; k < num_parts; ++k) {
+      ASSERT_LE(parts[k], parts[k + 1]);
+      dmlc::ColBlock<uint32_t> part = cols.Slice(parts[k], parts[k + 1]);
+      size_t nnz = part.offset[part.size] - part.offset[0];
+      // balanced up to the largest column
+      ASSERT_LE(nnz, ndata / num_parts + cols[0].length);
+      total += nnz;
+    }
+    ASSERT_EQ(total, ndata);
+  }
+}
+
+TEST(ColBlock, test_col_block_iter) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < 500; ++i) {
+      of << "1 " << i % 3 << ":" << i << " " << 3 + i % 5 << ":1\n";
+    }
+  }
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t>> iter(dmlc::RowBlockIter<uint32_t>::Create(
+      (data_path + "#" + tempdir.path + "/cache").c_str(), 0, 1, "libsvm"));
+  dmlc::ColBlockIter<uint32_t> col_iter(iter.get(), 2);
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    size_t nnz = 0;
+    col_iter.BeforeFirst();
+    while (col_iter.Next()) {
+      const dmlc::ColBlock<uint32_t> &cols = col_iter.Value();
+      const dmlc::RowBlock<uint32_t> &rows = iter->Value();
+      ASSERT_EQ(cols.size, 8U);
+      for (size_t c = 0; c < cols.size; ++c) {
+        dmlc::Col<uint32_t> col = cols[c];
+        for (size_t k = 0; k < col.length; ++k) {
+          ASSERT_EQ(rows[col.row[k]].get_label(), 1.0f);
+          if (c < 3) {
+            ASSERT_EQ(col.row[k] % 3, c);
+          }
+        }
+        nnz += col.length;
+      }
+    }
+    ASSERT_EQ(nnz, 1000U);
+  }
+  // a minimal width pads the blocks with empty columns
+  dmlc::ColBlockIter<uint32_t> wide_iter(iter.get(), 2, 20);
+  wide_iter.BeforeFirst();
+  ASSERT_TRUE(wide_iter.Next());
+  ASSERT_EQ(wide_iter.Value().size, 20U);
+  ASSERT_EQ(wide_iter.Value()[19].length, 0U);
+}
@@ -0,0 +1,173 @@
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <dmlc/data.h>
+#include <dmlc/feature_map.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/memory_io.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/data/remap_parser.h"
+
+TEST(FeatureIdMap, test_concurrent_insert) {
+  dmlc::FeatureIdMap map(8);
+  const uint64_t kBase = 1ULL << 40;
+  std::vector<std::vector<uint32_t>> dense(4, std::vector<uint32_t>(1000));
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&, tid]() {
+      // the threads insert overlapping ids
+      for (uint64_t i = 0; i < 1000; ++i) {
+        dense[tid][i] = map.Insert(kBase + (i + tid * 250) * 7919);
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  EXPECT_EQ(map.Size(), 1750U);
+  std::set<uint32_t> seen;
+  for (int tid = 0; tid < 4; ++tid) {
+    for (uint64_t i = 0; i < 1000; ++i) {
+      const uint64_t id = kBase + (i + tid * 250) * 7919;
+      EXPECT_EQ(map.Find(id), dense[tid][i]);
+      EXPECT_LT(dense[tid][i], 1750U);
+      seen.insert(dense[tid][i]);
+    }
+  }
+  EXPECT_EQ(seen.size(), 1750U);
+  EXPECT_TRUE(map.Find(3) == dmlc::FeatureIdMap::kInvalid);
+  map.Freeze();
+  EXPECT_TRUE(map.Insert(3) == dmlc::FeatureIdMap::kInvalid);
+  EXPECT_EQ(map.Size(), 1750U);
+  // save and load
+  std::string buffer;
+  dmlc::MemoryStringStream fs(&buffer);
+  map.Save(&fs);
+  fs.Seek(0);
+  dmlc::FeatureIdMap loaded;
+  ASSERT_TRUE(loaded.Load(&fs));
+  EXPECT_TRUE(loaded.Frozen());
+  EXPECT_EQ(loaded.RawIds(), map.RawIds());
+  EXPECT_EQ(loaded.Find(kBase + 7919), map.Find(kBase + 7919));
+}
+
+TEST(FeatureIdMap, test_remap_parser) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  const std::string dict_path = tempdir.path + "/train.dict";
+  const std::string white_path = tempdir.path + "/white.txt";
+  const uint64_t kHash = 0xFEDCBA9876543210ULL;
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < 100; ++i) {
+      // a frequent hashed feature, a rare one (the same as the frequent one
+      // in the first row) and one seen in every other row
+      of << i % 2 << " " << kHash << ":1 " << kHash - i << ":2";
+      if (i % 2 == 0) {
+        of << " 12345678901:3";
+      }
+      of << "\n";
+    }
+  }
+  auto read_all = [](dmlc::Parser<uint32_t> *parser, size_t *num_entry) {
+    std::set<uint32_t> features;
+    size_t num_row = 0;
+    *num_entry = 0;
+    parser->BeforeFirst();
+    while (parser->Next()) {
+      const dmlc::RowBlock<uint32_t> &batch = parser->Value();
+      for (size_t i = 0; i < batch.size; ++i) {
+        for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+          features.insert(batch.index[j]);
+          ++*num_entry;
+        }
+      }
+      num_row += batch.size;
+    }
+    EXPECT_EQ(num_row, 100U);
+    return features;
+  };
+  size_t num_entry;
+  // learn the dictionary, saved at the end of the first pass
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?feature_dict=" + dict_path).c_str(), 0, 1, "libsvm_remap"));
+  std::set<uint32_t> features = read_all(parser.get(), &num_entry);
+  EXPECT_EQ(features.size(), 101U);
+  EXPECT_EQ(*features.rbegin(), 100U);
+  EXPECT_EQ(num_entry, 250U);
+  EXPECT_EQ(read_all(parser.get(), &num_entry), features);
+  // reuse the dictionary, unseen features are dropped
+  dmlc::FeatureIdMap dict;
+  {
+    std::unique_ptr<dmlc::Stream> fi(dmlc::Stream::Create(dict_path.c_str(), "r"));
+    ASSERT_TRUE(dict.Load(fi.get()));
+  }
+  EXPECT_EQ(dict.Size(), 101U);
+  // numbered in the order of first occurrence
+  std::vector<uint64_t> first{kHash, 12345678901ULL};
+  for (uint64_t i = 1; i < 100; ++i) {
+    first.push_back(kHash - i);
+  }
+  EXPECT_EQ(dict.RawIds(), first);
+  parser.reset(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?format=libsvm_remap&feature_dict=" + dict_path).c_str(), 0, 1, "auto"));
+  EXPECT_EQ(read_all(parser.get(), &num_entry), features);
+  EXPECT_EQ(num_entry, 250U);
+  // a loaded dictionary is consistent across parts
+  parser.reset(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?feature_dict=" + dict_path).c_str(), 1, 2, "libsvm_remap"));
+  // frequency threshold
+  parser.reset(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?feature_min_count=50").c_str(), 0, 1, "libsvm_remap"));
+  EXPECT_EQ(read_all(parser.get(), &num_entry), std::set<uint32_t>({0, 1}));
+  EXPECT_EQ(num_entry, 151U);
+  // whitelist
+  {
+    std::ofstream of(white_path);
+    of << "12345678901\n" << kHash - 3 << "\n";
+  }
+  parser.reset(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?feature_whitelist=" + white_path).c_str(), 0, 1, "libsvm_remap"));
+  EXPECT_EQ(read_all(parser.get(), &num_entry), std::set<uint32_t>({0, 1}));
+  EXPECT_EQ(num_entry, 51U);
+  // learning needs the whole data
+  EXPECT_THROW(dmlc::Parser<uint32_t>::Create(data_path.c_str(), 0, 2, "libsvm_remap"),
+      dmlc::Error);
+}
+
+TEST(FeatureIdMap, test_remap_chunk_order) {
+  // new features shared by the blocks of a chunk are numbered in block order
+  std::vector<dmlc::data::RowBlockContainer<uint64_t>> chunk(8);
+  std::vector<uint64_t> first;
+  std::set<uint64_t> seen;
+  for (size_t i = 0; i < chunk.size(); ++i) {
+    for (uint64_t r = 0; r < 50; ++r) {
+      for (uint64_t j = 0; j < 4; ++j) {
+        const uint64_t id = ((r * 7 + j * 13 + i * 29) % 97) << 33;
+        chunk[i].index.push_back(id);
+        if (seen.insert(id).second) {
+          first.push_back(id);
+        }
+      }
+      chunk[i].label.push_back(0.0f);
+      chunk[i].offset.push_back(chunk[i].index.size());
+    }
+  }
+  dmlc::FeatureIdMap map;
+  std::vector<dmlc::data::RowBlockContainer<uint32_t>> data;
+  dmlc::data::RemapParser<dmlc::real_t>::RemapChunk(chunk, &map, &data);
+  EXPECT_EQ(map.RawIds(), first);
+  ASSERT_EQ(data.size(), chunk.size());
+  for (size_t i = 0; i < chunk.size(); ++i) {
+    ASSERT_EQ(data[i].index.size(), chunk[i].index.size());
+    for (size_t k = 0; k < chunk[i].index.size(); ++k) {
+      EXPECT_EQ(first[data[i].index[k]], chunk[i].index[k]);
+    }
+  }
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <dmlc/feature_stats.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/data/row_block.h"
+
+namespace {
+// rank of v among the values, counting half of the ties
+double ExactRank(const std::vector<float> &sorted, float v) {
+  auto lo = std::lower_bound(sorted.begin(), sorted.end(), v);
+  auto hi = std::upper_bound(sorted.begin(), sorted.end(), v);
+  return static_cast<double>((lo - sorted.begin()) + (hi - sorted.begin())) / 2;
+}
+}  // namespace
+
+TEST(WQSketch, test_query) {
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist(0.0f, 10.0f);
+  const size_t n = 100000, max_size = 128;
+  std::vector<float> values(n);
+  dmlc::WQSketch sketch(max_size);
+  std::vector<std::pair<float, double>> part;
+  dmlc::WQSummary summary;
+  for (size_t i = 0; i < n; ++i) {
+    values[i] = dist(rng);
+    part.emplace_back(values[i], 1.0);
+    if (part.size() == 1000) {
+      std::sort(part.begin(), part.end());
+      summary.Build(part.data(), part.size());
+      summary.Prune(max_size);
+      sketch.Push(summary);
+      part.clear();
+    }
+  }
+  summary = sketch.GetSummary();
+  EXPECT_LE(summary.data.size(), max_size);
+  EXPECT_DOUBLE_EQ(summary.TotalWeight(), static_cast<double>(n));
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(summary.data.front().value, values.front());
+  EXPECT_EQ(summary.data.back().value, values.back());
+  // error bound of log2(#pushes) prunes
+  const double eps = 8.0 / (max_size - 1);
+  for (double q : {0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99}) {
+    const float v = summary.Query(q * n);
+    EXPECT_LE(std::fabs(ExactRank(values, v) - q * n), eps * n) << "quantile " << q;
+  }
+  const std::vector<float> cuts = summary.GetCuts(16);
+  EXPECT_EQ(cuts.size(), 15U);
+  EXPECT_TRUE(std::is_sorted(cuts.begin(), cuts.end()));
+}
+
+TEST(FeatureStats, test_add_merge) {
+  dmlc::data::RowBlockContainer<uint32_t> a, b;
+  dmlc::data::RowBlockContainer<uint32_t> *blk[2] = {&a, &b};
+  std::vector<std::vector<float>> expected(3);
+  for (int i = 0; i < 1000; ++i) {
+    dmlc::data::RowBlockContainer<uint32_t> *out = blk[i % 2];
+    out->label.push_back(0.0f);
+    out->weight.push_back(i < 500 ? 1.0f : 3.0f);
+    // feature 0 in every row, feature 2 with a few repeated values
+    out->index.push_back(0);
+    out->value.push_back(static_cast<float>(i));
+    if (i % 10 == 0) {
+      out->index.push_back(2);
+      out->value.push_back(static_cast<float>(i % 3));
+    }
+    out->offset.push_back(out->index.size());
+  }
+  dmlc::FeatureStats sa(64), sb(64), all(64);
+  sa.Add(a.GetBlock());
+  sb.Add(b.GetBlock());
+  all.Add(b.GetBlock());
+  all.Merge(sa);
+  sa.Merge(sb);
+  for (const dmlc::FeatureStats *stats : {&sa, &all}) {
+    ASSERT_EQ(stats->Size(), 3U);
+    EXPECT_EQ(stats->NumRow(), 1000U);
+    EXPECT_DOUBLE_EQ(stats->SumWeight(), 2000.0);
+    EXPECT_EQ((*stats)[0].count, 1000U);
+    EXPECT_EQ((*stats)[0].min_value, 0.0f);
+    EXPECT_EQ((*stats)[0].max_value, 999.0f);
+    EXPECT_EQ((*stats)[1].count, 0U);
+    EXPECT_EQ((*stats)[2].count, 100U);
+    EXPECT_DOUBLE_EQ((*stats)[2].sum_weight, 200.0);
+    EXPECT_EQ((*stats)[2].min_value, 0.0f);
+    EXPECT_EQ((*stats)[2].max_value, 2.0f);
+    // rows 500 to 999 weigh three times more, the weighted median is at 666
+    const dmlc::WQSummary summary = stats->Summary(0);
+    EXPECT_DOUBLE_EQ(summary.TotalWeight(), 2000.0);
+    EXPECT_NEAR(summary.Query(1000.0), 666.0f, 2000.0 / 63 / 3);
+    // few distinct values are kept exactly
+    EXPECT_EQ(stats->Cuts(2, 256), std::vector<float>({1.0f, 2.0f}));
+  }
+}
+
+TEST(FeatureStats, test_sparse_ids) {
+  dmlc::data::RowBlockContainer<uint64_t> blk;
+  blk.label.push_back(0.0f);
+  blk.index.push_back(1);
+  blk.index.push_back(uint64_t(1) << 40);
+  blk.offset.push_back(blk.index.size());
+  // hashed ids only cost the features they use
+  dmlc::FeatureStats stats(16), other(16);
+  stats.Add(blk.GetBlock());
+  blk.index[0] = 7;
+  other.Add(blk.GetBlock());
+  stats.Merge(other);
+  EXPECT_EQ(stats.Size(), (uint64_t(1) << 40) + 1);
+  EXPECT_EQ(stats.FeatureIds(), std::vector<uint64_t>({1, 7, uint64_t(1) << 40}));
+  EXPECT_EQ(stats[uint64_t(1) << 40].count, 2U);
+  EXPECT_EQ(stats[1].count, 1U);
+  EXPECT_EQ(stats[2].count, 0U);
+  EXPECT_EQ(stats.Summary(uint64_t(1) << 40).TotalWeight(), 2.0);
+  EXPECT_EQ(stats.Summary(2).data.size(), 0U);
+}
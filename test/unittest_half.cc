@@ -0,0 +1,111 @@
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/half.h>
+
+#include <gtest/gtest.h>
+
+TEST(Half, test_conversion) {
+  using dmlc::half_t;
+  const float exact[] = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 0.099975586f,
+      std::ldexp(1.0f, -14), std::ldexp(1.0f, -24), std::ldexp(3.0f, -24)};
+  for (float v : exact) {
+    ASSERT_EQ(static_cast<float>(half_t(v)), v);
+    ASSERT_EQ(std::signbit(static_cast<float>(half_t(v))), std::signbit(v));
+  }
+  // ties round to even
+  ASSERT_EQ(static_cast<float>(half_t(1.0f + std::ldexp(1.0f, -11))), 1.0f);
+  ASSERT_EQ(static_cast<float>(half_t(1.0f + std::ldexp(3.0f, -11))), 1.0f + std::ldexp(1.0f, -9));
+  ASSERT_EQ(static_cast<float>(half_t(std::ldexp(1.0f, -25))), 0.0f);
+  // overflow and special values
+  ASSERT_TRUE(std::isinf(static_cast<float>(half_t(65520.0f))));
+  ASSERT_TRUE(std::isinf(static_cast<float>(half_t(std::numeric_limits<float>::infinity()))));
+  ASSERT_TRUE(std::isnan(static_cast<float>(half_t(std::numeric_limits<float>::quiet_NaN()))));
+  ASSERT_EQ(half_t(65504.0f).bits, 0x7bffU);
+  ASSERT_EQ(half_t(-2.0f).bits, 0xc000U);
+}
+
+TEST(Half, test_bfloat16_conversion) {
+  using dmlc::bfloat16_t;
+  const float exact[] = {0.0f, 1.0f, -2.5f, 3.0e38f, std::ldexp(1.0f, -130)};
+  for (float v : exact) {
+    float r = static_cast<float>(bfloat16_t(v));
+    ASSERT_LE(std::fabs(r - v), std::fabs(v) * std::ldexp(1.0f, -8));
+  }
+  ASSERT_EQ(static_cast<float>(bfloat16_t(1.0f + std::ldexp(1.0f, -8))), 1.0f);
+  ASSERT_EQ(static_cast<float>(bfloat16_t(1.0f + std::ldexp(3.0f, -8))), 1.0f + std::ldexp(1.0f, -6));
+  ASSERT_TRUE(std::isnan(static_cast<float>(bfloat16_t(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(Half, test_convert_array) {
+  std::vector<float> src;
+  for (int i = -3000; i < 3000; ++i) {
+    src.push_back(std::ldexp(static_cast<float>(i) + 0.37f, i % 20));
+  }
+  std::vector<dmlc::half_t> half(src.size());
+  std::vector<dmlc::bfloat16_t> bf16(src.size());
+  dmlc::ConvertArray(src.data(), src.size(), half.data());
+  dmlc::ConvertArray(src.data(), src.size(), bf16.data());
+  std::vector<float> half_back(src.size()), bf16_back(src.size());
+  dmlc::ConvertArray(half.data(), half.size(), half_back.data());
+  dmlc::ConvertArray(bf16.data(), bf16.size(), bf16_back.data());
+  for (size_t i = 0; i < src.size(); ++i) {
+    // the batch conversion matches the scalar one
+    ASSERT_EQ(half[i].bits, dmlc::FloatToHalfBits(src[i]));
+    ASSERT_EQ(bf16[i].bits, dmlc::FloatToBFloat16Bits(src[i]));
+    ASSERT_EQ(half_back[i], dmlc::HalfBitsToFloat(half[i].bits));
+    ASSERT_EQ(bf16_back[i], static_cast<float>(bf16[i]));
+  }
+}
+
+namespace {
+
+template <typename DType>
+void CheckReducedPrecisionParser(const std::string &data_path, const std::string &cache) {
+  std::unique_ptr<dmlc::Parser<uint32_t, DType>> parser(
+      dmlc::Parser<uint32_t, DType>::Create(data_path.c_str(), 0, 1, "libsvm"));
+  size_t num_row = 0;
+  while (parser->Next()) {
+    const dmlc::RowBlock<uint32_t, DType> &batch = parser->Value();
+    for (size_t i = 0; i < batch.size; ++i, ++num_row) {
+      ASSERT_EQ(static_cast<float>(batch[i].get_label()), static_cast<float>(num_row % 3));
+      ASSERT_EQ(static_cast<float>(batch[i].get_value(0)), 0.5f * num_row);
+    }
+  }
+  ASSERT_EQ(num_row, 200U);
+  // build and reuse the cache
+  for (int round = 0; round < 2; ++round) {
+    std::unique_ptr<dmlc::RowBlockIter<uint32_t, DType>> iter(
+        dmlc::RowBlockIter<uint32_t, DType>::Create((data_path + "#" + cache).c_str(), 0, 1,
+            "libsvm"));
+    num_row = 0;
+    while (iter->Next()) {
+      const dmlc::RowBlock<uint32_t, DType> &batch = iter->Value();
+      for (size_t i = 0; i < batch.size; ++i, ++num_row) {
+        ASSERT_EQ(static_cast<float>(batch[i].get_value(0)), 0.5f * num_row);
+      }
+    }
+    ASSERT_EQ(num_row, 200U);
+  }
+}
+
+}  // namespace
+
+TEST(Half, test_parser) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < 200; ++i) {
+      of << i % 3 << " " << i << ":" << 0.5f * i << "\n";
+    }
+  }
+  CheckReducedPrecisionParser<dmlc::half_t>(data_path, tempdir.path + "/half.cache");
+  CheckReducedPrecisionParser<dmlc::bfloat16_t>(data_path, tempdir.path + "/bf16.cache");
+}
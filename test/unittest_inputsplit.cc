@@ -1,16 +1,28 @@
 #include <algorithm>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <future>
 #include <iostream>
+#include <memory>
 #include <random>
 #include <string>
 #include <vector>
 
 #include <dmlc/data.h>
 #include <dmlc/filesystem.h>
+#include <dmlc/recordio.h>
 
+#include <fcntl.h>
 #include <gtest/gtest.h>
+#include <sys/stat.h>
+#include <utime.h>
+
+#include "../src/io/async_file_stream.h"
+#include "../src/io/chunk_buffer.h"
+#include "../src/io/line_split.h"
+#include "../src/io/local_filesys.h"
+#include "../src/io/threaded_input_split.h"
 
 namespace {
 
@@ -146,6 +158,586 @@ TEST(InputSplit, test_split_libsvm_distributed) {
   }
 }
 
+TEST(InputSplit, test_read_modes) {
+  dmlc::TemporaryDirectory tempdir;
+  {
+    // a file of exactly one page, without end of line
+    std::ofstream of(tempdir.path + "/data_0.txt", std::ios::binary);
+    of << std::string(4094, 'a') << "\n" << "b";
+  }
+  {
+    std::ofstream of(tempdir.path + "/data_1.txt", std::ios::binary);
+    // larger than a chunk
+    for (int i = 0; i < 600000; ++i) {
+      of << i << "," << std::string(i % 17 + 1, '1') << (i % 3 == 0 ? "\r\n" : "\n");
+    }
+    of << "1,1";
+  }
+  const size_t nsplit = 3;
+  for (size_t part = 0; part < nsplit; ++part) {
+    std::vector<std::string> expected, records;
+    std::unique_ptr<dmlc::InputSplit> split(
+        dmlc::InputSplit::Create(tempdir.path.c_str(), part, nsplit, "text"));
+    dmlc::InputSplit::Blob rec;
+    while (split->NextRecord(&rec)) {
+      expected.push_back(std::string(static_cast<char *>(rec.dptr)));
+    }
+    for (const char *mode : {"?mmap=1", "?readers=3", "?aio=2", "?aio=3&direct=1"}) {
+      split.reset(dmlc::InputSplit::Create((tempdir.path + mode).c_str(), part, nsplit, "text"));
+      for (int epoch = 0; epoch < 2; ++epoch) {
+        records.clear();
+        split->BeforeFirst();
+        while (split->NextRecord(&rec)) {
+          records.push_back(std::string(static_cast<char *>(rec.dptr)));
+        }
+        ASSERT_EQ(records, expected) << mode;
+      }
+    }
+  }
+  for (const char *mode : {"?mmap=1", "?readers=2", "?aio=4"}) {
+    std::unique_ptr<dmlc::Parser<uint32_t>> parser(dmlc::Parser<uint32_t>::Create(
+        (tempdir.path + "/data_1.txt" + mode + "&label_column=0").c_str(), 0, 1, "csv"));
+    size_t num_row, num_col;
+    CountDimensions(parser.get(), &num_row, &num_col);
+    ASSERT_EQ(num_row, 600001U) << mode;
+  }
+}
+
+#ifndef _WIN32
+TEST(InputSplit, test_async_file_stream) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/data.bin";
+  const size_t block = dmlc::io::AsyncFileStream::kBlockSize;
+  std::string content(2 * block + block / 2 + 3, '\0');
+  for (size_t i = 0; i < content.size(); ++i) {
+    content[i] = static_cast<char>(i * 7 % 251);
+  }
+  {
+    std::ofstream of(path, std::ios::binary);
+    of << content;
+  }
+  for (bool direct : {false, true}) {
+    dmlc::io::AsyncFileStream fi(path, 2, direct);
+    std::string out(content.size() + 10, '\0');
+    // reads that do not match the blocks
+    size_t nread = 0;
+    while (size_t n = fi.Read(&out[nread], std::min<size_t>(333333, out.size() - nread))) {
+      nread += n;
+    }
+    ASSERT_EQ(nread, content.size());
+    ASSERT_EQ(out.substr(0, nread), content);
+    ASSERT_EQ(fi.Tell(), content.size());
+    for (size_t pos : {block + 5, size_t(17), content.size() - 2}) {
+      fi.Seek(pos);
+      ASSERT_EQ(fi.Read(&out[0], 100), std::min<size_t>(100, content.size() - pos));
+      ASSERT_EQ(out.substr(0, std::min<size_t>(100, content.size() - pos)),
+          content.substr(pos, 100));
+    }
+  }
+}
+#endif  // _WIN32
+
+TEST(InputSplit, test_partition_boundaries) {
+  dmlc::TemporaryDirectory tempdir;
+  std::vector<std::string> lines, records;
+  for (int i = 0; i < 300; ++i) {
+    // some records are longer than the first read looking for a boundary
+    lines.push_back(std::to_string(i) + std::string(i % 50 == 7 ? 200000 : i * 31 % 97, 'x'));
+    records.push_back(lines.back() + std::string(i % 4, 'y'));
+  }
+  {
+    std::ofstream of(tempdir.path + "/data.txt", std::ios::binary);
+    for (size_t i = 0; i < lines.size(); ++i) {
+      of << lines[i] << (i % 5 == 0 ? "\r\n" : "\n");
+    }
+    std::unique_ptr<dmlc::Stream> fo(
+        dmlc::Stream::Create((tempdir.path + "/data.rec").c_str(), "w"));
+    dmlc::RecordIOWriter writer(fo.get());
+    for (const std::string &rec : records) {
+      writer.WriteRecord(rec);
+    }
+  }
+  for (unsigned nsplit : {1, 3, 7, 16}) {
+    for (const char *type : {"text", "recordio"}) {
+      const bool text = !strcmp(type, "text");
+      std::vector<std::string> out;
+      for (unsigned part = 0; part < nsplit; ++part) {
+        std::unique_ptr<dmlc::InputSplit> split(dmlc::InputSplit::Create(
+            (tempdir.path + (text ? "/data.txt" : "/data.rec")).c_str(), part, nsplit, type));
+        for (int epoch = 0; epoch < 2; ++epoch) {
+          split->BeforeFirst();
+          dmlc::InputSplit::Blob rec;
+          while (split->NextRecord(&rec)) {
+            if (epoch == 0 && text) {
+              std::string line(static_cast<char *>(rec.dptr));
+              out.push_back(line.substr(0, line.find_first_of("\r\n")));
+            } else if (epoch == 0) {
+              out.push_back(std::string(static_cast<char *>(rec.dptr), rec.size));
+            }
+          }
+        }
+      }
+      ASSERT_EQ(out, text ? lines : records) << type << " " << nsplit;
+    }
+  }
+}
+
+TEST(InputSplit, test_line_index) {
+  dmlc::TemporaryDirectory tempdir;
+  std::vector<std::string> lines;
+  for (int f = 0; f < 3; ++f) {
+    std::ofstream of(tempdir.path + "/data_" + std::to_string(f) + ".txt", std::ios::binary);
+    if (f != 1) {
+      // ends of line at the beginning of the first file are returned as an empty record,
+      // those of the next files follow the end of line inserted between files
+      of << "\n\r\n";
+      if (f == 0) {
+        lines.push_back("");
+      }
+    }
+    for (int i = 0; i < 2000 * (f + 1); ++i) {
+      // skewed line lengths, the byte ranges have very different numbers of lines
+      lines.push_back(std::to_string(f) + "," + std::string(i < 1000 ? 200 : 2, 'a' + i % 26));
+      of << lines.back() << (i % 7 == 0 ? "\r\n\n" : "\n");
+    }
+  }
+  dmlc::TemporaryDirectory indexdir;
+  const std::string uri = tempdir.path + "?line_index=" + indexdir.path + "/lines.idx";
+  const unsigned nsplit = 4;
+  for (int pass = 0; pass < 2; ++pass) {
+    // the index is built by the first pass and loaded by the second one
+    std::vector<std::string> out;
+    for (unsigned part = 0; part < nsplit; ++part) {
+      std::unique_ptr<dmlc::InputSplit> split(
+          dmlc::InputSplit::Create(uri.c_str(), part, nsplit, "text"));
+      size_t num_records = 0;
+      ASSERT_TRUE(split->GetNumRecords(&num_records));
+      ASSERT_EQ(num_records, lines.size() * (part + 1) / nsplit - lines.size() * part / nsplit);
+      dmlc::InputSplit::Blob rec;
+      size_t n = 0;
+      while (split->NextRecord(&rec)) {
+        std::string line(static_cast<char *>(rec.dptr));
+        out.push_back(line.substr(0, line.find_first_of("\r\n")));
+        ++n;
+      }
+      ASSERT_EQ(n, num_records);
+      for (size_t k : {num_records - 1, size_t(0), size_t(1500), num_records / 2}) {
+        ASSERT_TRUE(split->SeekRecord(k));
+        ASSERT_TRUE(split->NextRecord(&rec));
+        std::string line(static_cast<char *>(rec.dptr));
+        ASSERT_EQ(line.substr(0, line.find_first_of("\r\n")), out[out.size() - n + k]);
+      }
+    }
+    ASSERT_EQ(out, lines);
+  }
+  // the index is renamed into place, no temporary file is left
+  std::vector<dmlc::io::FileInfo> index_files;
+  dmlc::io::LocalFileSystem::GetInstance()->ListDirectory(
+      dmlc::io::URI(indexdir.path.c_str()), &index_files);
+  ASSERT_EQ(index_files.size(), 1U);
+  std::unique_ptr<dmlc::InputSplit> split(
+      dmlc::InputSplit::Create(tempdir.path.c_str(), 0, 1, "text"));
+  size_t num_records;
+  ASSERT_FALSE(split->GetNumRecords(&num_records));
+}
+
+TEST(InputSplit, test_whole_files) {
+  dmlc::TemporaryDirectory tempdir;
+  std::vector<std::string> lines;
+  for (int f = 0; f < 200; ++f) {
+    std::ofstream of(tempdir.path + "/log_" + std::to_string(1000 + f) + ".txt");
+    for (int i = 0; i < f % 13 + 1; ++i) {
+      lines.push_back(std::to_string(f) + "," + std::to_string(i) + std::string(f % 50, 'e'));
+      // the last line of some files has no end of line
+      of << lines.back() << (i == f % 13 && f % 3 == 0 ? "" : "\n");
+    }
+  }
+  const unsigned nsplit = 3;
+  for (const char *mode : {"?whole_files=1", "?whole_files=1&readers=2", "?whole_files=1&mmap=1"}) {
+    std::vector<std::string> out;
+    std::vector<unsigned> file_part(200, nsplit);
+    for (unsigned part = 0; part < nsplit; ++part) {
+      std::unique_ptr<dmlc::InputSplit> split(
+          dmlc::InputSplit::Create((tempdir.path + mode).c_str(), part, nsplit, "text"));
+      dmlc::InputSplit::Blob rec;
+      while (split->NextRecord(&rec)) {
+        std::string line(static_cast<char *>(rec.dptr));
+        out.push_back(line.substr(0, line.find_first_of("\r\n")));
+        // every file is read by a single partition
+        const int f = atoi(out.back().c_str());
+        ASSERT_TRUE(file_part[f] == nsplit || file_part[f] == part) << mode;
+        file_part[f] = part;
+      }
+    }
+    // the files of a directory are listed in no particular order
+    std::vector<std::string> expected = lines;
+    std::sort(out.begin(), out.end());
+    std::sort(expected.begin(), expected.end());
+    ASSERT_EQ(out, expected) << mode;
+  }
+}
+
+TEST(InputSplit, test_list_input_files) {
+  dmlc::TemporaryDirectory tempdir;
+  // 2024-01/part-0 ... 2025-01/part-2, plus files and directories the globs exclude
+  std::vector<std::string> expected;
+  for (const char *dir : {"2024-01", "2024-02", "2025-01"}) {
+    const std::string path = tempdir.path + "/" + dir;
+    mkdir(path.c_str(), 0777);
+    mkdir((path + "/nested").c_str(), 0777);
+    std::ofstream(path + "/nested/part-9") << "x\n";
+    std::ofstream(path + "/other") << "x\n";
+    std::ofstream(path + "/.part-hidden") << "x\n";
+    for (int i = 0; i < 3; ++i) {
+      std::ofstream(path + "/part-" + std::to_string(i)) << dir << i << "\n";
+      if (std::string(dir).find("2024") == 0) {
+        expected.push_back(path + "/part-" + std::to_string(i));
+      }
+    }
+  }
+  dmlc::io::FileSystem *fs = dmlc::io::LocalFileSystem::GetInstance();
+  auto paths = [](const std::vector<dmlc::io::FileInfo> &files) {
+    std::vector<std::string> ret;
+    for (const dmlc::io::FileInfo &info : files) {
+      ret.push_back(info.path.name);
+    }
+    return ret;
+  };
+  const std::string pattern = tempdir.path + "/202[4]-*/part-?";
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, pattern)), expected);
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, tempdir.path + "/2025-01/*")),
+      std::vector<std::string>({tempdir.path + "/2025-01/nested/part-9",
+          tempdir.path + "/2025-01/other", tempdir.path + "/2025-01/part-0",
+          tempdir.path + "/2025-01/part-1", tempdir.path + "/2025-01/part-2"}));
+  // the recursive listing matches the listing of the directories one by one
+  std::vector<dmlc::io::FileInfo> files;
+  fs->ListDirectoryRecursive(dmlc::io::URI(tempdir.path.c_str()), &files);
+  ASSERT_EQ(files.size(), 18U);
+  fs->dmlc::io::FileSystem::ListDirectoryRecursive(dmlc::io::URI(tempdir.path.c_str()), &files);
+  ASSERT_EQ(files.size(), 36U);
+  for (size_t i = 0; i < 18; ++i) {
+    ASSERT_EQ(files[i].path.name, files[i + 18].path.name);
+    ASSERT_EQ(files[i].size, files[i + 18].size);
+    ASSERT_EQ(files[i].mtime, files[i + 18].mtime);
+  }
+  // the manifest is written by the first listing and read by the next ones
+  dmlc::TemporaryDirectory manifestdir;
+  const std::string manifest = manifestdir.path + "/listing";
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, pattern, false, manifest)),
+      expected);
+  // only the first and the last files are checked
+  std::remove(expected[1].c_str());
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, pattern, false, manifest)),
+      expected);
+  // a file rewritten with the same size is caught by its modification time
+  struct utimbuf times;
+  times.actime = times.modtime = 1000000000;
+  ASSERT_EQ(utime(expected.front().c_str(), &times), 0);
+  expected.erase(expected.begin() + 1);
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, pattern, false, manifest)),
+      expected);
+  // and within the same second
+  struct timespec mtime[2];
+  mtime[0].tv_sec = mtime[1].tv_sec = 1000000000;
+  mtime[0].tv_nsec = mtime[1].tv_nsec = 500000;
+  ASSERT_EQ(utimensat(AT_FDCWD, expected.front().c_str(), mtime, 0), 0);
+  EXPECT_EQ(fs->GetPathInfo(dmlc::io::URI(expected.front().c_str())).mtime,
+      1000000000ULL * 1000000000ULL + 500000ULL);
+  std::remove(expected.back().c_str());
+  expected.pop_back();
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, pattern, false, manifest)),
+      expected);
+  ASSERT_EQ(paths(dmlc::io::InputSplitBase::ListInputFiles(fs, pattern)), expected);
+  // the manifest is renamed into place, no temporary file is left
+  std::vector<dmlc::io::FileInfo> manifest_files;
+  fs->ListDirectory(dmlc::io::URI(manifestdir.path.c_str()), &manifest_files);
+  ASSERT_EQ(manifest_files.size(), 1U);
+  // a manifest of another uri is replaced
+  ASSERT_EQ(dmlc::io::InputSplitBase::ListInputFiles(fs, tempdir.path + "/2025-01/part-[01]",
+                false, manifest).size(), 2U);
+  std::unique_ptr<dmlc::InputSplit> split(dmlc::InputSplit::Create(
+      (tempdir.path + "/2025-01/part-[01]?manifest=" + manifest).c_str(), 0, 1, "text"));
+  std::vector<std::string> out;
+  dmlc::InputSplit::Blob rec;
+  while (split->NextRecord(&rec)) {
+    std::string line(static_cast<char *>(rec.dptr));
+    out.push_back(line.substr(0, line.find_first_of("\r\n")));
+  }
+  ASSERT_EQ(out, std::vector<std::string>({"2025-010", "2025-011"}));
+}
+
+TEST(InputSplit, test_shuffle_records) {
+  dmlc::TemporaryDirectory tempdir;
+  const int nrow = 20000;
+  std::vector<std::string> lines;
+  {
+    std::ofstream of(tempdir.path + "/train.libsvm");
+    std::unique_ptr<dmlc::Stream> fo(
+        dmlc::Stream::Create((tempdir.path + "/train.rec").c_str(), "w"));
+    dmlc::RecordIOWriter writer(fo.get());
+    for (int i = 0; i < nrow; ++i) {
+      lines.push_back(std::to_string(i) + " 1:" + std::to_string(i % 7));
+      of << lines.back() << "\n";
+      writer.WriteRecord(lines.back());
+    }
+  }
+  std::vector<std::string> sorted = lines;
+  std::sort(sorted.begin(), sorted.end());
+  auto read_pass = [](dmlc::InputSplit *split) {
+    std::vector<std::string> out;
+    dmlc::InputSplit::Blob rec;
+    while (split->NextRecord(&rec)) {
+      out.push_back(std::string(static_cast<char *>(rec.dptr)));
+    }
+    return out;
+  };
+  // the reservoir of 1 MB holds about half of the records
+  const std::string uri = tempdir.path + "/train.libsvm?shuffle_mb=1&shuffle_seed=7";
+  std::unique_ptr<dmlc::InputSplit> split(dmlc::InputSplit::Create(uri.c_str(), 0, 1, "text"));
+  std::unique_ptr<dmlc::InputSplit> same(dmlc::InputSplit::Create(uri.c_str(), 0, 1, "text"));
+  std::vector<std::string> first = read_pass(split.get());
+  ASSERT_EQ(read_pass(same.get()), first);
+  ASSERT_NE(first, lines);
+  std::vector<std::string> out = first;
+  std::sort(out.begin(), out.end());
+  ASSERT_EQ(out, sorted);
+  // the next epoch has another order
+  split->BeforeFirst();
+  out = read_pass(split.get());
+  ASSERT_NE(out, first);
+  std::sort(out.begin(), out.end());
+  ASSERT_EQ(out, sorted);
+  // the chunks of recordio inputs are made of the shuffled records
+  std::unique_ptr<dmlc::InputSplit> records(dmlc::InputSplit::Create(
+      (tempdir.path + "/train.rec?shuffle_mb=1").c_str(), 0, 1, "recordio"));
+  out.clear();
+  dmlc::InputSplit::Blob chunk, rec;
+  while (records->NextChunk(&chunk)) {
+    dmlc::RecordIOChunkReader reader(chunk);
+    while (reader.NextRecord(&rec)) {
+      out.push_back(std::string(static_cast<char *>(rec.dptr), rec.size));
+    }
+  }
+  ASSERT_NE(out, lines);
+  std::sort(out.begin(), out.end());
+  ASSERT_EQ(out, sorted);
+  // the parsers read the shuffled lines
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser(dmlc::Parser<uint32_t>::Create(
+      (tempdir.path + "/train.libsvm?shuffle_mb=1&format=libsvm").c_str(), 0, 1, "auto"));
+  std::vector<int> labels;
+  while (parser->Next()) {
+    const dmlc::RowBlock<uint32_t> &batch = parser->Value();
+    for (size_t i = 0; i < batch.size; ++i) {
+      labels.push_back(static_cast<int>(batch[i].get_label()));
+      ASSERT_EQ(batch[i].get_value(0), labels.back() % 7);
+    }
+  }
+  ASSERT_EQ(labels.size(), static_cast<size_t>(nrow));
+  ASSERT_FALSE(std::is_sorted(labels.begin(), labels.end()));
+  std::sort(labels.begin(), labels.end());
+  for (int i = 0; i < nrow; ++i) {
+    ASSERT_EQ(labels[i], i);
+  }
+}
+
+TEST(InputSplit, test_indexed_recordio_shuffle) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data = tempdir.path + "/data.rec", index = tempdir.path + "/data.idx";
+  std::vector<std::string> records;
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(data.c_str(), "w"));
+    std::ofstream fidx(index);
+    dmlc::RecordIOWriter writer(fo.get());
+    for (int i = 0; i < 3000; ++i) {
+      fidx << i << "\t" << writer.Tell() << "\n";
+      records.push_back(std::to_string(i) + std::string(i % 37 * 13, 'r'));
+      writer.WriteRecord(records.back());
+    }
+  }
+  std::vector<std::string> sorted = records;
+  std::sort(sorted.begin(), sorted.end());
+  std::vector<std::string> first;
+  for (const char *mode : {"", "?readers=3"}) {
+    std::unique_ptr<dmlc::InputSplit> split(dmlc::InputSplit::Create(
+        (data + mode).c_str(), index.c_str(), 0, 1, "indexed_recordio", true, 5, 64));
+    std::vector<std::string> out;
+    dmlc::InputSplit::Blob rec;
+    while (split->NextRecord(&rec)) {
+      out.push_back(std::string(static_cast<char *>(rec.dptr), rec.size));
+    }
+    // the records of a batch are returned in the order of the permutation
+    if (first.size() == 0) {
+      first = out;
+      ASSERT_NE(out, records);
+    } else {
+      ASSERT_EQ(out, first) << mode;
+    }
+    std::sort(out.begin(), out.end());
+    ASSERT_EQ(out, sorted) << mode;
+    // the next epoch has another permutation
+    split->BeforeFirst();
+    out.clear();
+    dmlc::InputSplit::Blob chunk;
+    while (split->NextChunk(&chunk)) {
+      dmlc::RecordIOChunkReader reader(chunk);
+      while (reader.NextRecord(&rec)) {
+        out.push_back(std::string(static_cast<char *>(rec.dptr), rec.size));
+      }
+    }
+    ASSERT_NE(out, first) << mode;
+    std::sort(out.begin(), out.end());
+    ASSERT_EQ(out, sorted) << mode;
+  }
+}
+
+TEST(InputSplit, test_chunk_buffer) {
+  dmlc::io::ChunkBuffer buf(1000);
+  ASSERT_GE(buf.capacity(), 1000U);
+  ASSERT_EQ(reinterpret_cast<size_t>(buf.data()) % dmlc::io::ChunkBufferPool::kAlign, 0U);
+  std::memset(buf.data(), 'a', 1000);
+  buf.Reserve(500, 0);
+  buf.Reserve(100000, 1000);
+  ASSERT_GE(buf.capacity(), 100000U);
+  ASSERT_EQ(reinterpret_cast<size_t>(buf.data()) % dmlc::io::ChunkBufferPool::kAlign, 0U);
+  ASSERT_EQ(std::string(buf.data(), 1000), std::string(1000, 'a'));
+  buf.Clear();
+  ASSERT_EQ(buf.capacity(), 0U);
+}
+
+TEST(InputSplit, test_read_chunk_tail) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/data.txt";
+  std::vector<std::string> expected;
+  {
+    std::ofstream of(path, std::ios::binary);
+    for (int i = 0; i < 200; ++i) {
+      // some records are longer than the chunks
+      expected.push_back(std::to_string(i) + std::string(i * 7 % 150, 'x'));
+      of << expected.back() << "\n";
+    }
+  }
+  // one chunk reused, then chunks used in turn as by the prefetch thread
+  for (size_t nchunk = 1; nchunk <= 3; nchunk += 2) {
+    dmlc::io::LineSplitter split(dmlc::io::LocalFileSystem::GetInstance(), path.c_str(), 0, 1);
+    std::vector<std::unique_ptr<dmlc::io::InputSplitBase::Chunk>> chunks;
+    for (size_t i = 0; i < nchunk; ++i) {
+      chunks.emplace_back(new dmlc::io::InputSplitBase::Chunk(16));
+    }
+    std::vector<std::string> records;
+    dmlc::InputSplit::Blob rec;
+    for (size_t i = 0; chunks[i % nchunk]->Load(&split, 16); ++i) {
+      while (split.ExtractNextRecord(&rec, chunks[i % nchunk].get())) {
+        records.push_back(std::string(static_cast<char *>(rec.dptr)));
+      }
+    }
+    ASSERT_EQ(records, expected);
+  }
+  // each chunk is freed once the next one is read, as by a prefetch thread over its budget
+  {
+    dmlc::io::LineSplitter split(dmlc::io::LocalFileSystem::GetInstance(), path.c_str(), 0, 1);
+    std::vector<std::string> records;
+    dmlc::InputSplit::Blob rec;
+    std::unique_ptr<dmlc::io::InputSplitBase::Chunk> prev;
+    while (true) {
+      std::unique_ptr<dmlc::io::InputSplitBase::Chunk> chunk(
+          new dmlc::io::InputSplitBase::Chunk(16));
+      const bool loaded = chunk->Load(&split, 16);
+      if (prev != nullptr) {
+        // overwrite the freed bytes
+        std::memset(prev->data.data(), 'z', prev->data.capacity());
+      }
+      if (!loaded) {
+        break;
+      }
+      while (split.ExtractNextRecord(&rec, chunk.get())) {
+        records.push_back(std::string(static_cast<char *>(rec.dptr)));
+      }
+      prev.swap(chunk);
+    }
+    ASSERT_EQ(records, expected);
+  }
+}
+
+TEST(InputSplit, test_prefetch_budget) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/data.txt";
+  size_t expected_bytes = 0, expected_rows = 0;
+  {
+    // 40 MB with records across the boundaries of the 8 MB chunks
+    std::ofstream of(path, std::ios::binary);
+    for (size_t i = 0; expected_bytes < (40UL << 20UL); ++i) {
+      const std::string line = std::to_string(i) + std::string(i * 7919 % 100000, 'x');
+      of << line << "\n";
+      expected_bytes += line.length();
+      ++expected_rows;
+    }
+  }
+  // the budget of 1 MB is less than a chunk, the chunks are freed once read
+  std::unique_ptr<dmlc::InputSplit> split(
+      dmlc::InputSplit::Create((path + "?prefetch_mb=1").c_str(), 0, 1, "text"));
+  size_t nbytes = 0, nrows = 0;
+  dmlc::InputSplit::Blob rec;
+  while (split->NextRecord(&rec)) {
+    const std::string line(static_cast<char *>(rec.dptr));
+    ASSERT_EQ(line, std::to_string(nrows) + std::string(nrows * 7919 % 100000, 'x'));
+    nbytes += line.length();
+    ++nrows;
+  }
+  ASSERT_EQ(nrows, expected_rows);
+  ASSERT_EQ(nbytes, expected_bytes);
+  // the prefetch thread copies each partial record once, as the unthreaded split
+  size_t copied[2];
+  for (int threaded = 0; threaded < 2; ++threaded) {
+    dmlc::io::LineSplitter *base
+        = new dmlc::io::LineSplitter(dmlc::io::LocalFileSystem::GetInstance(), path.c_str(), 0, 1);
+    split.reset(threaded ? static_cast<dmlc::InputSplit *>(
+        new dmlc::io::ThreadedInputSplit(base, 0, 1UL << 20UL)) : base);
+    nrows = 0;
+    while (split->NextRecord(&rec)) {
+      ++nrows;
+    }
+    ASSERT_EQ(nrows, expected_rows);
+    copied[threaded] = base->TailBytesCopied();
+  }
+  ASSERT_NE(copied[0], 0U);
+  ASSERT_EQ(copied[1], copied[0]);
+}
+
+TEST(InputSplit, test_cache_invalidation) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  const std::string cache_uri = data_path + "#" + tempdir.path + "/train.cache";
+  const std::string split_uri = data_path + "#" + tempdir.path + "/split.cache";
+  for (int nrow = 2; nrow <= 4; nrow += 2) {
+    {
+      std::ofstream of(data_path, std::ios::binary);
+      for (int i = 0; i < nrow; ++i) {
+        of << "1 3:1 10:1\n";
+      }
+    }
+    // the cache built in the first round must not be reused after the source changed
+    std::unique_ptr<dmlc::RowBlockIter<uint32_t>> iter(
+        dmlc::RowBlockIter<uint32_t>::Create(cache_uri.c_str(), 0, 1, "libsvm"));
+    size_t num_row = 0;
+    while (iter->Next()) {
+      num_row += iter->Value().size;
+    }
+    ASSERT_EQ(num_row, static_cast<size_t>(nrow));
+
+    std::unique_ptr<dmlc::InputSplit> split(
+        dmlc::InputSplit::Create(split_uri.c_str(), 0, 1, "text"));
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      dmlc::InputSplit::Blob rec;
+      size_t num_rec = 0;
+      split->BeforeFirst();
+      while (split->NextRecord(&rec)) {
+        ++num_rec;
+      }
+      ASSERT_EQ(num_rec, static_cast<size_t>(nrow));
+    }
+  }
+}
+
 #ifdef DMLC_UNIT_TESTS_USE_CMAKE
 /* Don't run the following when CMake is not used */
 
@@ -190,6 +782,23 @@ TEST(InputSplit, test_recordio) {
   }
 }
 
+TEST(InputSplit, test_recordio_mmap) {
+  std::unique_ptr<dmlc::InputSplit> source(
+      dmlc::InputSplit::Create(CMAKE_CURRENT_SOURCE_DIR "/test/sample.rec", 0, 1, "recordio"));
+  std::vector<std::string> expected, records;
+  dmlc::InputSplit::Blob rec;
+  while (source->NextRecord(&rec)) {
+    expected.push_back(std::string(static_cast<char *>(rec.dptr), rec.size));
+  }
+  ASSERT_NE(expected.size(), 0U);
+  source.reset(dmlc::InputSplit::Create(
+      CMAKE_CURRENT_SOURCE_DIR "/test/sample.rec?mmap=1", 0, 1, "recordio"));
+  while (source->NextRecord(&rec)) {
+    records.push_back(std::string(static_cast<char *>(rec.dptr), rec.size));
+  }
+  ASSERT_EQ(records, expected);
+}
+
   #endif  // DMLC_CMAKE_LITTLE_ENDIAN
 
 #endif  // DMLC_UNIT_TESTS_USE_CMAKE
@@ -1,13 +1,18 @@
 #include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <memory>
 
+#include <dmlc/filesystem.h>
 #include <dmlc/io.h>
 
 #include <gtest/gtest.h>
 
+#include "../src/data/basic_row_iter.h"
 #include "../src/data/csv_parser.h"
 #include "../src/data/libfm_parser.h"
 #include "../src/data/libsvm_parser.h"
+#include "../src/data/parser.h"
 
 using namespace dmlc;
 using namespace dmlc::data;
@@ -505,3 +510,141 @@ TEST(LibFMParser, test_indexing_mode_auto_detect_2) {
   CHECK(rctr->index == expected_index);
   CHECK(rctr->value == expected_value);  // perform element-wise comparsion
 }
+
+#if DMLC_ENABLE_STD_THREAD
+TEST(ThreadedParser, test_epoch_cache) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  const std::string spill_path = tempdir.path + "/train.spill";
+  auto write_data = [&data_path](int nrow) {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < nrow; ++i) {
+      of << i << " 1:" << i << " 4:1\n";
+    }
+  };
+  auto count_rows = [](Parser<uint32_t> *parser) {
+    size_t num_row = 0;
+    real_t label_sum = 0;
+    parser->BeforeFirst();
+    while (parser->Next()) {
+      const RowBlock<uint32_t> &batch = parser->Value();
+      for (size_t i = 0; i < batch.size; ++i) {
+        CHECK_EQ(batch[i].length, 2U);
+        label_sum += batch[i].get_label();
+      }
+      num_row += batch.size;
+    }
+    CHECK_EQ(label_sum, static_cast<real_t>(num_row * (num_row - 1) / 2));
+    return num_row;
+  };
+  // in memory, through the uri arguments
+  write_data(100);
+  std::unique_ptr<Parser<uint32_t>> parser(
+      Parser<uint32_t>::Create((data_path + "?epoch_cache_mb=1").c_str(), 0, 1, "libsvm"));
+  CHECK_EQ(count_rows(parser.get()), 100U);
+  // the second epoch is served from the cache, not from the file
+  write_data(10);
+  CHECK_EQ(count_rows(parser.get()), 100U);
+  CHECK_EQ(count_rows(parser.get()), 100U);
+  // interrupted first pass, the cache is rebuilt from scratch
+  parser.reset(Parser<uint32_t>::Create((data_path + "?epoch_cache_mb=1").c_str(), 0, 1, "libsvm"));
+  CHECK(parser->Next());
+  CHECK_EQ(count_rows(parser.get()), 10U);
+  CHECK_EQ(count_rows(parser.get()), 10U);
+  // budget exceeded, spill to disk
+  parser.reset(new ThreadedParser<uint32_t>(
+      new LibSVMParser<uint32_t>(InputSplit::Create(data_path.c_str(), 0, 1, "text"),
+          std::map<std::string, std::string>(), 1),
+      1, spill_path));
+  CHECK_EQ(count_rows(parser.get()), 10U);
+  write_data(20);
+  CHECK_EQ(count_rows(parser.get()), 10U);
+  CHECK_EQ(count_rows(parser.get()), 10U);
+  // budget exceeded without spill file, falls back to parsing
+  parser.reset(new ThreadedParser<uint32_t>(
+      new LibSVMParser<uint32_t>(InputSplit::Create(data_path.c_str(), 0, 1, "text"),
+          std::map<std::string, std::string>(), 1),
+      1));
+  CHECK_EQ(count_rows(parser.get()), 20U);
+  CHECK_EQ(count_rows(parser.get()), 20U);
+}
+#endif  // DMLC_ENABLE_STD_THREAD
+
+#if DMLC_ENABLE_STD_THREAD
+TEST(ThreadedParser, test_feature_stats) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < 1000; ++i) {
+      of << i % 2 << " 1:" << i << " 3:" << -i % 7 << "\n";
+    }
+  }
+  std::unique_ptr<Parser<uint32_t>> parser(Parser<uint32_t>::Create(
+      (data_path + "?feature_stats=1&stats_sketch_size=32").c_str(), 0, 1, "libsvm"));
+  CHECK(parser->Stats() == NULL);
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    parser->BeforeFirst();
+    while (parser->Next()) {
+    }
+    const dmlc::FeatureStats *stats = parser->Stats();
+    CHECK(stats != NULL);
+    CHECK_EQ(stats->NumRow(), 1000U);
+    CHECK_EQ(stats->Size(), 4U);
+    CHECK_EQ((*stats)[1].count, 1000U);
+    CHECK_EQ((*stats)[1].min_value, 0.0f);
+    CHECK_EQ((*stats)[1].max_value, 999.0f);
+    CHECK_EQ((*stats)[3].min_value, -6.0f);
+    CHECK_EQ((*stats)[3].max_value, 0.0f);
+    CHECK_EQ(stats->Cuts(3, 256).size(), 6U);
+    CHECK_EQ(stats->Summary(1).TotalWeight(), 1000.0);
+  }
+  // the iterator takes the statistics of the parser
+  std::unique_ptr<RowBlockIter<uint32_t>> iter(new BasicRowIter<uint32_t>(
+      Parser<uint32_t>::Create((data_path + "?feature_stats=1").c_str(), 0, 1, "libsvm")));
+  CHECK(iter->Stats() != NULL);
+  CHECK_EQ(iter->Stats()->NumRow(), 1000U);
+  // not collected by default
+  parser.reset(Parser<uint32_t>::Create(data_path.c_str(), 0, 1, "libsvm"));
+  while (parser->Next()) {
+  }
+  CHECK(parser->Stats() == NULL);
+}
+#endif  // DMLC_ENABLE_STD_THREAD
+
+TEST(RowBlockIter, test_basic_row_iter) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  const int nrow = 10000;
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < nrow; ++i) {
+      of << i << " " << i % 7 << ":1 " << 7 + i % 13 << ":0.5\n";
+    }
+  }
+  for (int compact = 0; compact < 2; ++compact) {
+    const std::string uri = data_path + (compact ? "?compact=1" : "");
+    std::unique_ptr<dmlc::RowBlockIter<uint32_t>> iter(
+        dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      size_t num_row = 0, num_block = 0;
+      double label_sum = 0;
+      iter->BeforeFirst();
+      while (iter->Next()) {
+        const dmlc::RowBlock<uint32_t> &batch = iter->Value();
+        for (size_t i = 0; i < batch.size; ++i) {
+          ASSERT_EQ(batch[i].length, 2U);
+          label_sum += batch[i].get_label();
+        }
+        num_row += batch.size;
+        ++num_block;
+      }
+      ASSERT_EQ(num_row, static_cast<size_t>(nrow));
+      ASSERT_EQ(label_sum, static_cast<double>(nrow) * (nrow - 1) / 2);
+      if (compact) {
+        ASSERT_EQ(num_block, 1U);
+      }
+    }
+    ASSERT_EQ(iter->NumCol(), 20U);
+  }
+}
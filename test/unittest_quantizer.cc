@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <dmlc/filesystem.h>
+#include <dmlc/memory_io.h>
+#include <dmlc/quantizer.h>
+
+#include <gtest/gtest.h>
+
+TEST(BinQuantizer, test_bin) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+  dmlc::BinQuantizer quantizer;
+  std::vector<std::vector<float>> cuts;
+  for (size_t ncut : {0, 1, 2, 7, 64, 255}) {
+    std::vector<float> c(ncut);
+    for (float &v : c) {
+      v = dist(rng);
+    }
+    std::sort(c.begin(), c.end());
+    quantizer.AddFeature(c);
+    cuts.push_back(c);
+  }
+  EXPECT_EQ(quantizer.NumFeature(), cuts.size());
+  EXPECT_EQ(quantizer.MaxBin(), 256U);
+  for (size_t fid = 0; fid < cuts.size(); ++fid) {
+    std::vector<float> probe(cuts[fid]);
+    for (int i = 0; i < 100; ++i) {
+      probe.push_back(dist(rng));
+    }
+    for (float v : probe) {
+      size_t expected = std::upper_bound(cuts[fid].begin(), cuts[fid].end(), v) - cuts[fid].begin();
+      ASSERT_EQ(quantizer.Bin(fid, v), expected);
+    }
+  }
+  EXPECT_EQ(quantizer.Bin(cuts.size() + 10, 1.0f), 0U);
+  // the searches in lockstep match the single searches, for any number of entries
+  std::vector<uint32_t> index(1003);
+  std::vector<float> value(index.size());
+  for (size_t j = 0; j < index.size(); ++j) {
+    index[j] = static_cast<uint32_t>(rng() % (cuts.size() + 2));
+    value[j] = dist(rng);
+  }
+  for (size_t n : {size_t(0), size_t(5), index.size()}) {
+    std::vector<uint8_t> out(n), out_one(n);
+    quantizer.BinEntries(index.data(), value.data(), n, out.data());
+    quantizer.BinEntries(index.data(), static_cast<const float *>(NULL), n, out_one.data());
+    for (size_t j = 0; j < n; ++j) {
+      ASSERT_EQ(out[j], quantizer.Bin(index[j], value[j]));
+      ASSERT_EQ(out_one[j], quantizer.Bin(index[j], 1.0f));
+    }
+  }
+  // save and load
+  std::string buffer;
+  dmlc::MemoryStringStream fs(&buffer);
+  quantizer.Save(&fs);
+  fs.Seek(0);
+  dmlc::BinQuantizer loaded;
+  ASSERT_TRUE(loaded.Load(&fs));
+  EXPECT_EQ(loaded.NumFeature(), quantizer.NumFeature());
+  for (size_t fid = 0; fid < cuts.size(); ++fid) {
+    for (float v : cuts[fid]) {
+      EXPECT_EQ(loaded.Bin(fid, v), quantizer.Bin(fid, v));
+    }
+  }
+  EXPECT_FALSE(loaded.Load(&fs));
+}
+
+TEST(BinQuantizer, test_bin_row_iter) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < 1000; ++i) {
+      of << i % 2 << ":" << (i < 500 ? 1 : 2) << " 0:" << i;
+      if (i % 3 == 0) {
+        of << " 2:" << i % 4;
+      }
+      of << "\n";
+    }
+  }
+  std::unique_ptr<dmlc::Parser<uint32_t>> parser(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?feature_stats=1&indexing_mode=0").c_str(), 0, 1, "libsvm"));
+  while (parser->Next()) {
+  }
+  ASSERT_TRUE(parser->Stats() != NULL);
+  const dmlc::BinQuantizer quantizer = dmlc::BinQuantizer::FromStats(*parser->Stats(), 16);
+  EXPECT_EQ(quantizer.NumFeature(), 3U);
+  EXPECT_EQ(quantizer.MaxBin(), 16U);
+  EXPECT_EQ(quantizer.Bin(1, 0.0f), 0U);
+  EXPECT_EQ(quantizer.Bin(2, 3.0f), 3U);
+  dmlc::BinRowIter<uint32_t, uint8_t> iter(parser.release(), quantizer, 2);
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    size_t num_row = 0;
+    std::vector<double> bin_weight(16, 0.0);
+    iter.BeforeFirst();
+    while (iter.Next()) {
+      const dmlc::BinRowBlock<uint32_t, uint8_t> &batch = iter.Value();
+      EXPECT_TRUE(batch.rows.value == NULL);
+      for (size_t i = 0; i < batch.rows.size; ++i) {
+        const size_t row = num_row + i;
+        EXPECT_EQ(batch.rows.label[i], static_cast<float>(row % 2));
+        EXPECT_EQ(batch.rows.weight[i], row < 500 ? 1.0f : 2.0f);
+        dmlc::Row<uint32_t> r = batch.rows[i];
+        ASSERT_EQ(r.length, row % 3 == 0 ? 2U : 1U);
+        const uint8_t *bin = batch.bin + batch.rows.offset[i];
+        ASSERT_EQ(r.index[0], 0U);
+        bin_weight[bin[0]] += batch.rows.weight[i];
+        if (r.length == 2) {
+          EXPECT_EQ(bin[1], row % 4);
+        }
+      }
+      num_row += batch.rows.size;
+    }
+    EXPECT_EQ(num_row, 1000U);
+    // the weighted quantiles put about the same weight in each bin
+    for (size_t b = 0; b < 16; ++b) {
+      EXPECT_NEAR(bin_weight[b], 1500.0 / 16, 20.0) << "bin " << b;
+    }
+  }
+  // quantized in the parsing thread, with the cut points saved to a file
+  const std::string cuts_path = tempdir.path + "/cuts.bin";
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(cuts_path.c_str(), "w"));
+    quantizer.Save(fo.get());
+  }
+  dmlc::BinRowIter<uint32_t, uint8_t> fused(dmlc::Parser<uint32_t>::Create(
+      (data_path + "?indexing_mode=0&bin_cuts=" + cuts_path).c_str(), 0, 1, "libsvm"));
+  iter.BeforeFirst();
+  std::vector<uint8_t> bins, fused_bins;
+  while (iter.Next()) {
+    const dmlc::BinRowBlock<uint32_t, uint8_t> &batch = iter.Value();
+    bins.insert(bins.end(), batch.bin, batch.bin + batch.rows.offset[batch.rows.size]);
+  }
+  while (fused.Next()) {
+    const dmlc::BinRowBlock<uint32_t, uint8_t> &batch = fused.Value();
+    fused_bins.insert(
+        fused_bins.end(), batch.bin, batch.bin + batch.rows.offset[batch.rows.size]);
+  }
+  EXPECT_EQ(fused_bins, bins);
+  // too many bins for the bin type
+  dmlc::BinQuantizer large;
+  large.AddFeature(std::vector<float>(300, 0.0f));
+  parser.reset(dmlc::Parser<uint32_t>::Create(data_path.c_str(), 0, 1, "libsvm"));
+  EXPECT_THROW(dmlc::BinRowIter<uint32_t>(parser.get(), large), dmlc::Error);
+}
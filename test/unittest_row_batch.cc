@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <vector>
+
+#include <dmlc/row_batch.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/data/row_block.h"
+
+namespace {
+// iterator over a list of blocks, like a parser with uneven chunks
+class BlockListIter : public dmlc::DataIter<dmlc::RowBlock<uint32_t>> {
+ public:
+  explicit BlockListIter(const std::vector<size_t> &sizes) : ptr_(0) {
+    size_t row = 0;
+    for (size_t size : sizes) {
+      dmlc::data::RowBlockContainer<uint32_t> blk;
+      for (size_t i = 0; i < size; ++i, ++row) {
+        blk.label.push_back(static_cast<float>(row));
+        // weight only in some blocks
+        if (blocks_.size() % 2 == 0) {
+          blk.weight.push_back(2.0f);
+        }
+        for (size_t j = 0; j < row % 4; ++j) {
+          blk.index.push_back(static_cast<uint32_t>(row + j));
+          blk.value.push_back(static_cast<float>(row));
+        }
+        blk.offset.push_back(blk.index.size());
+      }
+      blocks_.push_back(blk);
+    }
+  }
+  virtual void BeforeFirst(void) {
+    ptr_ = 0;
+  }
+  virtual bool Next(void) {
+    if (ptr_ == blocks_.size()) {
+      return false;
+    }
+    block_ = blocks_[ptr_++].GetBlock();
+    return true;
+  }
+  virtual const dmlc::RowBlock<uint32_t> &Value(void) const {
+    return block_;
+  }
+
+ private:
+  std::vector<dmlc::data::RowBlockContainer<uint32_t>> blocks_;
+  size_t ptr_;
+  dmlc::RowBlock<uint32_t> block_;
+};
+
+// check the rows of a minibatch against the generated data
+void CheckRows(const dmlc::RowBlock<uint32_t> &batch, size_t first_row) {
+  for (size_t i = 0; i < batch.size; ++i) {
+    const size_t row = first_row + i;
+    dmlc::Row<uint32_t> r = batch[i];
+    ASSERT_EQ(r.get_label(), static_cast<float>(row));
+    ASSERT_EQ(r.length, row % 4);
+    for (size_t j = 0; j < r.length; ++j) {
+      ASSERT_EQ(r.get_index(j), row + j);
+      ASSERT_EQ(r.get_value(j), static_cast<float>(row));
+    }
+  }
+}
+}  // namespace
+
+TEST(RowBatchIter, test_exact_size) {
+  BlockListIter base({5, 17, 0, 3, 40, 1});
+  for (bool drop_last : {false, true}) {
+    dmlc::RowBatchIter<uint32_t> iter(&base, 8, drop_last);
+    for (int epoch = 0; epoch < 2; ++epoch) {
+      iter.BeforeFirst();
+      size_t num_row = 0;
+      while (iter.Next()) {
+        const dmlc::RowBlock<uint32_t> &batch = iter.Value();
+        CheckRows(batch, num_row);
+        if (num_row == 8) {
+          // rows 8 to 15 lie in the second block, returned without copy
+          EXPECT_NE(batch.offset[0], 0U);
+          EXPECT_TRUE(batch.weight == NULL);
+        }
+        if (num_row == 0) {
+          // stitched from the first two blocks, weight of the second block is 1
+          EXPECT_EQ(batch.weight[0], 2.0f);
+          EXPECT_EQ(batch.weight[7], 1.0f);
+        }
+        num_row += batch.size;
+        EXPECT_TRUE(batch.size == 8 || (!drop_last && num_row == 66));
+      }
+      EXPECT_EQ(num_row, drop_last ? 64U : 66U);
+    }
+    // the last row of both 64 and 66 rows has index 65
+    EXPECT_EQ(iter.NumCol(), 66U);
+  }
+}
+
+TEST(RowBatchIter, test_caller_buffer) {
+  BlockListIter base({5, 17, 0, 3, 40, 1});
+  dmlc::RowBatchIter<uint32_t> iter(&base, 10);
+  std::vector<size_t> offset(11);
+  std::vector<float> label(10), weight(10), value(12);
+  std::vector<uint32_t> index(12);
+  dmlc::CSRBatchBuffer<uint32_t> buf;
+  buf.max_rows = 10;
+  buf.max_nnz = 12;
+  buf.offset = offset.data();
+  buf.label = label.data();
+  buf.weight = weight.data();
+  buf.qid = NULL;
+  buf.field = NULL;
+  buf.index = index.data();
+  buf.value = value.data();
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    iter.BeforeFirst();
+    size_t num_row = 0, nrow;
+    while ((nrow = iter.NextBatch(buf)) != 0) {
+      // 10 rows have 15 entries, the batches are cut by max_nnz
+      EXPECT_LE(offset[nrow], 12U);
+      EXPECT_LT(nrow, 10U);
+      dmlc::RowBlock<uint32_t> batch;
+      batch.size = nrow;
+      batch.offset = offset.data();
+      batch.label = label.data();
+      batch.weight = weight.data();
+      batch.qid = NULL;
+      batch.field = NULL;
+      batch.index = index.data();
+      batch.value = value.data();
+      CheckRows(batch, num_row);
+      EXPECT_EQ(weight[0], num_row < 5 || (num_row >= 25 && num_row < 65) ? 2.0f : 1.0f);
+      num_row += nrow;
+    }
+    EXPECT_EQ(num_row, 66U);
+  }
+  // a row larger than the buffer
+  buf.max_nnz = 2;
+  iter.BeforeFirst();
+  EXPECT_EQ(iter.NextBatch(buf), 2U);
+  EXPECT_EQ(iter.NextBatch(buf), 1U);
+  EXPECT_THROW(iter.NextBatch(buf), dmlc::Error);
+}
+
+TEST(RowBatchIter, test_row_buffer) {
+  // rows 1 to 3 have no weight, rows 4 and 5 have
+  BlockListIter base({1, 3, 2});
+  dmlc::detail::RowBuffer<uint32_t, float> buffer;
+  ASSERT_TRUE(base.Next());
+  ASSERT_TRUE(base.Next());
+  const dmlc::RowBlock<uint32_t> unweighted = base.Value();
+  ASSERT_TRUE(base.Next());
+  const dmlc::RowBlock<uint32_t> weighted = base.Value();
+  buffer.Append(unweighted, 0, 2);
+  // the optional arrays the source has not are not grown
+  EXPECT_EQ(buffer.weight.size(), 0U);
+  EXPECT_EQ(buffer.qid.size(), 0U);
+  EXPECT_EQ(buffer.field.size(), 0U);
+  EXPECT_EQ(buffer.value.size(), buffer.index.size());
+  EXPECT_TRUE(buffer.GetBlock().weight == NULL);
+  // the weights of the earlier rows default to 1
+  buffer.Append(weighted, 0, 2);
+  buffer.Append(unweighted, 2, 3);
+  const dmlc::RowBlock<uint32_t> out = buffer.GetBlock();
+  ASSERT_EQ(out.size, 5U);
+  const float weight[] = {1.0f, 1.0f, 2.0f, 2.0f, 1.0f};
+  for (size_t i = 0; i < out.size; ++i) {
+    EXPECT_EQ(out.weight[i], weight[i]);
+  }
+  EXPECT_EQ(buffer.qid.size(), 0U);
+  CheckRows(out.Slice(0, 2), 1);
+  CheckRows(out.Slice(2, 4), 4);
+  CheckRows(out.Slice(4, 5), 3);
+  // gather a list of rows at once
+  dmlc::detail::RowBuffer<uint32_t, float> gathered;
+  const size_t rows[] = {4, 0, 3};
+  gathered.Gather(out, rows, 3);
+  const dmlc::RowBlock<uint32_t> batch = gathered.GetBlock();
+  ASSERT_EQ(batch.size, 3U);
+  CheckRows(batch.Slice(0, 1), 3);
+  CheckRows(batch.Slice(1, 2), 1);
+  CheckRows(batch.Slice(2, 3), 5);
+  EXPECT_EQ(batch.weight[0], 1.0f);
+  EXPECT_EQ(batch.weight[2], 2.0f);
+}
+
+TEST(BucketBatchIter, test_bucket) {
+  // row r has r % 4 entries
+  BlockListIter base({5, 17, 0, 3, 40, 1, 300});
+  const size_t nrow = 366;
+  dmlc::BucketBatchIter<uint32_t> iter(&base, 8, {0, 1, 2}, 64, 7);
+  EXPECT_EQ(iter.Bucket(0), 0U);
+  EXPECT_EQ(iter.Bucket(2), 2U);
+  EXPECT_EQ(iter.Bucket(3), 3U);
+  std::vector<float> first_epoch;
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    iter.BeforeFirst();
+    std::vector<int> seen(nrow, 0);
+    std::vector<float> labels;
+    size_t num_incomplete = 0;
+    while (iter.Next()) {
+      const dmlc::RowBlock<uint32_t> &batch = iter.Value();
+      ASSERT_LE(batch.size, 8U);
+      num_incomplete += batch.size != 8;
+      const size_t length = batch[0].length;
+      for (size_t i = 0; i < batch.size; ++i) {
+        const size_t row = static_cast<size_t>(batch[i].get_label());
+        ASSERT_LT(row, nrow);
+        ++seen[row];
+        labels.push_back(batch[i].get_label());
+        // every row of a minibatch has the same length, and its original data
+        ASSERT_EQ(batch[i].length, length);
+        CheckRows(batch.Slice(i, i + 1), row);
+      }
+    }
+    EXPECT_LE(num_incomplete, 4U);
+    EXPECT_EQ(std::count(seen.begin(), seen.end(), 1), static_cast<long>(nrow));
+    EXPECT_FALSE(std::is_sorted(labels.begin(), labels.end()));
+    // the shuffle continues across epochs
+    if (epoch == 0) {
+      first_epoch = labels;
+    } else {
+      EXPECT_NE(labels, first_epoch);
+    }
+  }
+  EXPECT_EQ(iter.NumCol(), 366U);
+  EXPECT_THROW(dmlc::BucketBatchIter<uint32_t>(&base, 8, {0, 1, 2}, 16), dmlc::Error);
+}
@@ -0,0 +1,157 @@
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/memory_io.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/data/compact_row_block.h"
+#include "../src/data/row_block.h"
+
+using namespace dmlc;
+using namespace dmlc::data;
+
+namespace {
+
+template <typename IndexType>
+inline RowBlockContainer<IndexType> MakeRowBlock(size_t nrow, bool with_field) {
+  RowBlockContainer<IndexType> data;
+  for (size_t i = 0; i < nrow; ++i) {
+    for (size_t j = 0; j < i % 5; ++j) {
+      // unsorted indices with both small and large gaps
+      IndexType findex = static_cast<IndexType>((j % 2 == 0 ? 1000 : 3) * (i + j) + 7 * j);
+      data.index.push_back(findex);
+      data.value.push_back(static_cast<real_t>(i) + 0.5f * j);
+      if (with_field) {
+        data.field.push_back(static_cast<IndexType>(j));
+      }
+      data.max_index = std::max(data.max_index, findex);
+    }
+    data.label.push_back(static_cast<real_t>(i % 2));
+    data.weight.push_back(1.0f + i);
+    data.offset.push_back(data.index.size());
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(CompactRowBlock, test_view_and_decode) {
+  RowBlockContainer<uint64_t> data = MakeRowBlock<uint64_t>(1000, true);
+  // indices beyond 32 bits
+  data.index[3] = (1ULL << 40) + 3;
+  data.max_index = data.index[3];
+  CompactRowBlockContainer<uint64_t> compact;
+  // pushed in two parts, offsets must be shifted
+  RowBlock<uint64_t> batch = data.GetBlock();
+  compact.Push(batch.Slice(0, 400));
+  compact.Push(batch.Slice(400, 1000));
+  ASSERT_EQ(compact.Size(), 1000U);
+  ASSERT_FALSE(compact.offset.IsWide());
+  ASSERT_EQ(compact.max_index, data.index[3]);
+  for (size_t i = 0; i < batch.size; ++i) {
+    CompactRow<uint64_t> row = compact[i];
+    ASSERT_EQ(row.length, batch[i].length);
+    ASSERT_EQ(row.label, batch[i].get_label());
+    ASSERT_EQ(row.weight, batch[i].get_weight());
+    uint64_t findex, field;
+    real_t fvalue;
+    for (size_t j = 0; j < batch[i].length; ++j) {
+      ASSERT_TRUE(row.Next(&findex, &fvalue, &field));
+      ASSERT_EQ(findex, batch[i].index[j]);
+      ASSERT_EQ(fvalue, batch[i].value[j]);
+      ASSERT_EQ(field, batch[i].field[j]);
+    }
+    ASSERT_FALSE(row.Next(&findex, &fvalue));
+  }
+  RowBlockContainer<uint64_t> decoded;
+  compact.Decode(&decoded);
+  ASSERT_EQ(decoded.offset, data.offset);
+  ASSERT_EQ(decoded.index, data.index);
+  ASSERT_EQ(decoded.value, data.value);
+  ASSERT_EQ(decoded.field, data.field);
+  ASSERT_EQ(decoded.label, data.label);
+  ASSERT_EQ(decoded.weight, data.weight);
+}
+
+TEST(CompactRowBlock, test_save_load) {
+  RowBlockContainer<uint32_t> data = MakeRowBlock<uint32_t>(5000, false);
+  CompactRowBlockContainer<uint32_t> compact;
+  compact.Push(data.GetBlock());
+  std::string raw, encoded;
+  {
+    MemoryStringStream fo(&raw);
+    data.Save(&fo);
+  }
+  {
+    MemoryStringStream fo(&encoded);
+    compact.Save(&fo);
+    compact.Save(&fo);
+  }
+  ASSERT_LT(encoded.length() / 2, raw.length());
+  ASSERT_LT(compact.MemCostBytes(), data.MemCostBytes());
+  MemoryStringStream fi(&encoded);
+  CompactRowBlockContainer<uint32_t> loaded;
+  for (int k = 0; k < 2; ++k) {
+    ASSERT_TRUE(loaded.Load(&fi));
+    RowBlockContainer<uint32_t> decoded;
+    loaded.Decode(&decoded);
+    ASSERT_EQ(decoded.offset, data.offset);
+    ASSERT_EQ(decoded.index, data.index);
+    ASSERT_EQ(decoded.value, data.value);
+    ASSERT_EQ(decoded.max_index, data.max_index);
+  }
+  ASSERT_FALSE(loaded.Load(&fi));
+}
+
+TEST(CompactRowBlock, test_truncated_index) {
+  RowBlockContainer<uint32_t> data = MakeRowBlock<uint32_t>(10, false);
+  data.index.back() = 1U << 30;
+  CompactRowBlockContainer<uint32_t> compact;
+  compact.Push(data.GetBlock());
+  // the last varint runs past the end of the encoded indices
+  compact.index.pop_back();
+  RowBlockContainer<uint32_t> decoded;
+  EXPECT_THROW(compact.Decode(&decoded), dmlc::Error);
+  // the same for the view of a row
+  const uint8_t bytes[] = {0x81, 0x80};
+  CompactRow<uint32_t> row(1, bytes, bytes + 2, NULL, NULL);
+  uint32_t findex;
+  real_t fvalue;
+  EXPECT_THROW(row.Next(&findex, &fvalue), dmlc::Error);
+}
+
+TEST(CompactRowBlock, test_disk_row_iter) {
+  TemporaryDirectory tempdir;
+  const std::string data_path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(data_path, std::ios::binary);
+    for (int i = 0; i < 1000; ++i) {
+      of << i % 2 << " " << i % 11 << ":1 " << 100 + i << ":" << i << "\n";
+    }
+  }
+  std::vector<std::string> formats{"raw", "compact"};
+  for (const std::string &format : formats) {
+    const std::string uri = data_path + "?page_format=" + format + "#" + tempdir.path + "/cache";
+    // build, then reuse the cache
+    for (int round = 0; round < 2; ++round) {
+      std::unique_ptr<RowBlockIter<uint32_t>> iter(
+          RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+      size_t num_row = 0;
+      while (iter->Next()) {
+        const RowBlock<uint32_t> &batch = iter->Value();
+        for (size_t i = 0; i < batch.size; ++i) {
+          ASSERT_EQ(batch[i].length, 2U);
+          ASSERT_EQ(batch[i].index[1], 100U + num_row);
+          ASSERT_EQ(batch[i].value[1], static_cast<real_t>(num_row));
+          ++num_row;
+        }
+      }
+      ASSERT_EQ(num_row, 1000U);
+    }
+  }
+}
@@ -0,0 +1,191 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <dmlc/data.h>
+#include <dmlc/sparse_ops.h>
+
+#include <gtest/gtest.h>
+
+#include "../src/data/row_block.h"
+
+namespace {
+
+dmlc::data::RowBlockContainer<uint32_t> MakeRowBlock(size_t nrow, uint32_t ncol, bool with_value) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  dmlc::data::RowBlockContainer<uint32_t> data;
+  for (size_t i = 0; i < nrow; ++i) {
+    size_t length = rng() % 40;
+    for (size_t j = 0; j < length; ++j) {
+      data.index.push_back(static_cast<uint32_t>(rng() % ncol));
+      if (with_value) {
+        data.value.push_back(dist(rng));
+      }
+    }
+    data.label.push_back(0.0f);
+    data.offset.push_back(data.index.size());
+  }
+  return data;
+}
+
+std::vector<float> MakeWeight(size_t size) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> weight(size);
+  for (float &w : weight) {
+    w = dist(rng);
+  }
+  return weight;
+}
+
+}  // namespace
+
+TEST(SparseOps, test_sdot) {
+  const uint32_t ncol = 1000;
+  std::vector<float> weight = MakeWeight(ncol);
+  for (bool with_value : {false, true}) {
+    dmlc::data::RowBlockContainer<uint32_t> data = MakeRowBlock(200, ncol, with_value);
+    dmlc::RowBlock<uint32_t> batch = data.GetBlock();
+    for (size_t i = 0; i < batch.size; ++i) {
+      dmlc::Row<uint32_t> row = batch[i];
+      double expected = 0;
+      for (size_t j = 0; j < row.length; ++j) {
+        expected += static_cast<double>(weight[row.index[j]]) * row.get_value(j);
+      }
+      ASSERT_NEAR(row.SDot(weight.data(), ncol), expected, 1e-4);
+      double sum = row.SDot<float, double>(weight.data(), ncol);
+      ASSERT_NEAR(sum, expected, 1e-10);
+    }
+    // the bound is still checked
+    ASSERT_THROW(batch[1].SDot(weight.data(), 1), dmlc::Error);
+  }
+}
+
+TEST(SparseOps, test_spmv) {
+  const uint32_t ncol = 500;
+  std::vector<float> weight = MakeWeight(ncol);
+  dmlc::data::RowBlockContainer<uint32_t> data = MakeRowBlock(1000, ncol, true);
+  dmlc::RowBlock<uint32_t> batch = data.GetBlock().Slice(10, 1000);
+  for (int nthread : {1, 3}) {
+    std::vector<float> out(batch.size);
+    std::vector<double> out_double(batch.size);
+    dmlc::SpMV(batch, weight.data(), ncol, out.data(), nthread);
+    dmlc::SpMV(batch, weight.data(), ncol, out_double.data(), nthread);
+    for (size_t i = 0; i < batch.size; ++i) {
+      ASSERT_EQ(out[i], batch[i].SDot(weight.data(), ncol));
+      ASSERT_EQ(out_double[i], (batch[i].SDot<float, double>(weight.data(), ncol)));
+    }
+  }
+  std::vector<float> out(batch.size);
+  ASSERT_THROW(dmlc::SpMV(batch, weight.data(), ncol - 100, out.data()), dmlc::Error);
+}
+
+TEST(SparseOps, test_scatter_add) {
+  const uint32_t ncol = 300;
+  std::vector<float> coef = MakeWeight(2000);
+  for (bool with_value : {false, true}) {
+    dmlc::data::RowBlockContainer<uint32_t> data = MakeRowBlock(2000, ncol, with_value);
+    dmlc::RowBlock<uint32_t> batch = data.GetBlock();
+    std::vector<double> expected(ncol, 1.0);
+    for (size_t i = 0; i < batch.size; ++i) {
+      dmlc::Row<uint32_t> row = batch[i];
+      for (size_t j = 0; j < row.length; ++j) {
+        expected[row.index[j]] += static_cast<double>(coef[i]) * row.get_value(j);
+      }
+    }
+    for (int nthread : {0, 1, 4}) {
+      std::vector<float> out(ncol, 1.0f);
+      std::vector<double> out_double(ncol, 1.0);
+      dmlc::ScatterAdd(batch, coef.data(), ncol, out.data(), nthread);
+      dmlc::ScatterAdd(batch, coef.data(), ncol, out_double.data(), nthread);
+      for (size_t k = 0; k < ncol; ++k) {
+        ASSERT_NEAR(out[k], expected[k], 1e-3);
+        ASSERT_NEAR(out_double[k], expected[k], 1e-9);
+      }
+    }
+  }
+}
+
+TEST(SparseOps, test_to_dense) {
+  const uint32_t ncol = 50;
+  dmlc::data::RowBlockContainer<uint32_t> data = MakeRowBlock(300, ncol, true);
+  dmlc::RowBlock<uint32_t> batch = data.GetBlock().Slice(7, 300);
+  const size_t nrow = batch.size;
+  // reference, the last entry of a duplicated feature wins
+  std::vector<float> expected(nrow * ncol, -1.0f);
+  for (size_t i = 0; i < nrow; ++i) {
+    dmlc::Row<uint32_t> row = batch[i];
+    for (size_t j = 0; j < row.length; ++j) {
+      expected[i * ncol + row.index[j]] = row.value[j];
+    }
+  }
+  for (int nthread : {1, 4}) {
+    std::vector<float> row_major(nrow * ncol, 7.0f);
+    std::vector<double> col_major(nrow * ncol, 7.0);
+    dmlc::ToDense(batch, ncol, row_major.data(), dmlc::kRowMajor, -1.0f, NULL, nthread);
+    dmlc::ToDense(batch, ncol, col_major.data(), dmlc::kColMajor, -1.0, NULL, nthread);
+    for (size_t i = 0; i < nrow; ++i) {
+      for (size_t j = 0; j < ncol; ++j) {
+        ASSERT_EQ(row_major[i * ncol + j], expected[i * ncol + j]);
+        ASSERT_EQ(col_major[j * nrow + i], static_cast<double>(expected[i * ncol + j]));
+      }
+    }
+    // column subset, in a different order
+    // a large feature index does not cost memory
+    const std::vector<uint32_t> columns{40, 3, 17, 1000, 0xfffffff0U};
+    std::vector<float> subset(nrow * columns.size());
+    dmlc::ToDense(batch, columns.size(), subset.data(), dmlc::kRowMajor, 0.0f, columns.data(),
+        nthread);
+    for (size_t i = 0; i < nrow; ++i) {
+      for (size_t j = 0; j < columns.size(); ++j) {
+        float v = columns[j] < ncol ? expected[i * ncol + columns[j]] : -1.0f;
+        ASSERT_EQ(subset[i * columns.size() + j], v == -1.0f ? 0.0f : v);
+      }
+    }
+  }
+  std::vector<float> small(nrow * 10);
+  ASSERT_THROW(dmlc::ToDense(batch, 10, small.data()), dmlc::Error);
+}
+
+TEST(SparseOps, test_to_dense_runs) {
+  // rows made of runs of consecutive features, with a repeated feature
+  const uint32_t ncol = 40;
+  dmlc::data::RowBlockContainer<uint32_t> data;
+  for (uint32_t i = 0; i < 30; ++i) {
+    for (uint32_t j = i % 7; j < i % 7 + i % 11; ++j) {
+      data.index.push_back(j);
+      data.value.push_back(static_cast<float>(i * ncol + j));
+    }
+    for (uint32_t j : {20U, 21U, 22U, 23U, 21U, 39U}) {
+      data.index.push_back(j);
+      data.value.push_back(-static_cast<float>(data.index.size()));
+    }
+    data.label.push_back(0.0f);
+    data.offset.push_back(data.index.size());
+  }
+  dmlc::RowBlock<uint32_t> batch = data.GetBlock();
+  std::vector<float> expected(batch.size * ncol, 0.0f);
+  for (size_t i = 0; i < batch.size; ++i) {
+    dmlc::Row<uint32_t> row = batch[i];
+    for (size_t j = 0; j < row.length; ++j) {
+      expected[i * ncol + row.index[j]] = row.value[j];
+    }
+  }
+  std::vector<float> row_major(batch.size * ncol), col_major(batch.size * ncol);
+  dmlc::ToDense(batch, ncol, row_major.data());
+  dmlc::ToDense(batch, ncol, col_major.data(), dmlc::kColMajor);
+  for (size_t i = 0; i < batch.size; ++i) {
+    for (size_t j = 0; j < ncol; ++j) {
+      ASSERT_EQ(row_major[i * ncol + j], expected[i * ncol + j]);
+      ASSERT_EQ(col_major[j * batch.size + i], expected[i * ncol + j]);
+    }
+  }
+  batch.value = NULL;
+  dmlc::ToDense(batch, ncol, row_major.data());
+  for (size_t i = 0; i < batch.size; ++i) {
+    for (size_t j = 0; j < ncol; ++j) {
+      ASSERT_EQ(row_major[i * ncol + j], expected[i * ncol + j] == 0.0f ? 0.0f : 1.0f);
+    }
+  }
+}
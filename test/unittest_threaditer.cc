@@ -1,6 +1,8 @@
 #include "unittest_threaditer.h"
 
+#include <algorithm>
 #include <chrono>
+#include <vector>
 
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
@@ -77,3 +79,44 @@ TEST(ThreadedIter, basics) {
   }
   LOG(INFO) << "finish";
 }
+
+TEST(ThreadedIter, adaptive_capacity) {
+  using namespace producer_test;
+  const size_t kCellBytes = 1 << 10;
+  for (size_t max_bytes : {size_t(1) << 20, 2 * kCellBytes}) {
+    ThreadedIter<std::vector<char>> iter;
+    iter.set_max_capacity(1);
+    iter.set_max_bytes(max_bytes, [](const std::vector<char> &cell) { return cell.capacity(); });
+    int counter = 0;
+    iter.Init(
+        [&counter](std::vector<char> **dptr) {
+          if (counter == 20) {
+            return false;
+          }
+          if (*dptr == NULL) {
+            *dptr = new std::vector<char>(kCellBytes);
+          }
+          delay(5);
+          (**dptr)[0] = static_cast<char>(counter++);
+          return true;
+        },
+        [&counter]() { counter = 0; });
+    int expect = 0;
+    std::vector<char> *value;
+    while (iter.Next(&value)) {
+      EXPECT_EQ((*value)[0], static_cast<char>(expect++));
+      iter.Recycle(&value);
+    }
+    EXPECT_EQ(expect, 20);
+    PrefetchStats stats = iter.GetStats();
+    EXPECT_EQ(stats.num_produced, 20U);
+    EXPECT_GT(stats.num_consumer_wait, 0U);
+    EXPECT_LE(stats.bytes, std::max(max_bytes, kCellBytes));
+    if (max_bytes == 2 * kCellBytes) {
+      EXPECT_LE(stats.depth, 2U);
+    } else {
+      EXPECT_GT(stats.depth, 1U);
+    }
+    iter.Destroy();
+  }
+}